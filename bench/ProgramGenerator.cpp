@@ -0,0 +1,221 @@
+#include "ProgramGenerator.hpp"
+
+namespace
+{
+    // Mini-Lang identifiers are letters only, so indices are spelled in
+    // base 26; in capitals, since no keyword has any
+    std::string identifier(const char *prefix, std::size_t index)
+    {
+        std::string name = prefix;
+        do
+        {
+            name += static_cast<char>('A' + index % 26);
+            index /= 26;
+        } while (index > 0);
+        return name;
+    }
+
+    // No division, so generated programs cannot divide by zero when run
+    constexpr const char *OPERATORS[] = {" + ", " - ", " * "};
+    constexpr const char *WORDS[] = {"lexer", "parser", "token", "node", "value", "scope", "proc", "result"};
+    constexpr std::size_t MAX_CALLS = 1000;
+}
+
+ProgramGenerator::ProgramGenerator(const Options &options)
+    : options(options), random(options.seed)
+{
+}
+
+bool ProgramGenerator::parseShape(const std::string &name, Shape &shape)
+{
+    for (Shape candidate : {Shape::MIXED, Shape::PROCS, Shape::NESTING, Shape::EXPRESSIONS, Shape::COMMENTS})
+    {
+        if (name == shapeName(candidate))
+        {
+            shape = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *ProgramGenerator::shapeName(Shape shape)
+{
+    switch (shape)
+    {
+    case Shape::MIXED:
+        return "mixed";
+    case Shape::PROCS:
+        return "procs";
+    case Shape::NESTING:
+        return "nesting";
+    case Shape::EXPRESSIONS:
+        return "expressions";
+    case Shape::COMMENTS:
+        return "comments";
+    }
+    return "mixed";
+}
+
+std::string ProgramGenerator::generate()
+{
+    std::string out;
+    out.reserve(options.targetBytes + 4096);
+
+    while (out.size() < options.targetBytes)
+    {
+        Shape unit = options.shape;
+        if (unit == Shape::MIXED)
+        {
+            unit = static_cast<Shape>(1 + unitCount % 4);
+        }
+        unitCount++;
+
+        switch (unit)
+        {
+        case Shape::NESTING:
+            appendNesting(out, options.nestingDepth);
+            break;
+        case Shape::EXPRESSIONS:
+            appendExpression(out);
+            break;
+        case Shape::COMMENTS:
+            appendComments(out);
+            break;
+        default:
+            appendProc(out);
+            break;
+        }
+    }
+
+    out += "begin:\n    int total = 0;\n";
+    for (std::size_t i = 0; i < procCount && i < MAX_CALLS; i++)
+    {
+        out += "    total = total + " + identifier("p", i) + "(" + std::to_string(i % 100) + ", 3);\n";
+    }
+    out += "    out_to_console(total);\nend\n";
+    return out;
+}
+
+void ProgramGenerator::indent(std::string &out, int level)
+{
+    out.append(static_cast<std::size_t>(level) * 4, ' ');
+}
+
+void ProgramGenerator::appendOperand(std::string &out)
+{
+    switch (random() % 4)
+    {
+    case 0:
+        out += "a";
+        break;
+    case 1:
+        out += "b";
+        break;
+    case 2:
+        out += std::to_string(1 + random() % 1000);
+        break;
+    default:
+        out += "(a + " + std::to_string(1 + random() % 9) + ")";
+        break;
+    }
+}
+
+/**
+ * @brief A small proc: a declaration, an if/else and a result
+ */
+void ProgramGenerator::appendProc(std::string &out)
+{
+    out += "proc " + identifier("p", procCount++) + "(int a, int b) => {\n";
+    out += "    int r = a + b * " + std::to_string(1 + random() % 10) + ";\n";
+    out += "    if(a < b){\n        r = r - 1;\n    } else {\n        r = r + 1;\n    }\n";
+    out += "    result => {r};\n}\n\n";
+}
+
+/**
+ * @brief A proc whose body nests if/else and for statements depth levels deep
+ *
+ * Only the if branch nests, so the unit grows linearly with the depth.
+ */
+void ProgramGenerator::appendNesting(std::string &out, int depth)
+{
+    out += "proc " + identifier("p", procCount++) + "(int a, int b) => {\n";
+    out += "    int r = 0;\n";
+    for (int level = 1; level <= depth; level++)
+    {
+        indent(out, level);
+        if (level % 2)
+        {
+            out += "if(a < " + std::to_string(level * 10) + "){\n";
+        }
+        else
+        {
+            std::string counter = identifier("i", static_cast<std::size_t>(level));
+            out += "for(int " + counter + " = 0; " + counter + " < b; ++" + counter + "){\n";
+        }
+    }
+    indent(out, depth + 1);
+    out += "r = r + a;\n";
+    for (int level = depth; level >= 1; level--)
+    {
+        indent(out, level);
+        out += (level % 2) ? "} else {\n" : "}\n";
+        if (level % 2)
+        {
+            indent(out, level + 1);
+            out += "r = r - 1;\n";
+            indent(out, level);
+            out += "}\n";
+        }
+    }
+    out += "    result => {r};\n}\n\n";
+}
+
+/**
+ * @brief A proc made of a few long arithmetic expressions
+ */
+void ProgramGenerator::appendExpression(std::string &out)
+{
+    out += "proc " + identifier("p", procCount++) + "(int a, int b) => {\n";
+    for (int statement = 0; statement < 4; statement++)
+    {
+        out += "    int " + identifier("e", static_cast<std::size_t>(statement)) + " = ";
+        appendOperand(out);
+        for (int term = 1; term < options.expressionTerms; term++)
+        {
+            out += OPERATORS[random() % (sizeof(OPERATORS) / sizeof(OPERATORS[0]))];
+            appendOperand(out);
+        }
+        out += ";\n";
+    }
+    out += "    result => {eA + eB};\n}\n\n";
+}
+
+/**
+ * @brief Comment blocks around a small proc, as in heavily documented code
+ */
+void ProgramGenerator::appendComments(std::string &out)
+{
+    auto sentence = [this]()
+    {
+        std::string text;
+        for (int word = 0; word < 10; word++)
+        {
+            text += WORDS[random() % (sizeof(WORDS) / sizeof(WORDS[0]))];
+            text += ' ';
+        }
+        return text;
+    };
+
+    for (int line = 0; line < 6; line++)
+    {
+        out += ">>$ " + sentence() + "\n";
+    }
+    out += "<<$ " + sentence() + "\n";
+    for (int line = 0; line < 6; line++)
+    {
+        out += "    " + sentence() + "\n";
+    }
+    out += "$>>\n";
+    appendProc(out);
+}
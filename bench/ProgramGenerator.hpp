@@ -0,0 +1,67 @@
+#ifndef PROGRAM_GENERATOR_HPP
+#define PROGRAM_GENERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+/**
+ * @brief Emits syntactically valid Mini-Lang programs of a chosen size and shape
+ *
+ * Used by the front-end benchmarks and the generate tool to produce large
+ * inputs for the lexer and parser. The output is built from units (a proc,
+ * a nested statement, a long expression, a comment block) appended until
+ * the program reaches the requested size, followed by a begin block that
+ * calls some of the procs. Programs are deterministic for a given seed.
+ *
+ * The programs are meant to be lexed and parsed; they are valid to run,
+ * but they are not designed to compute anything meaningful.
+ */
+class ProgramGenerator
+{
+public:
+    enum class Shape
+    {
+        MIXED,       // All of the units below, interleaved
+        PROCS,       // Many small procs
+        NESTING,     // Deeply nested if/else and for statements
+        EXPRESSIONS, // Long arithmetic expressions
+        COMMENTS     // Mostly single- and multi-line comments
+    };
+
+    struct Options
+    {
+        std::size_t targetBytes = 1 << 20;
+        Shape shape = Shape::MIXED;
+        int nestingDepth = 24;      // Levels per nested unit
+        int expressionTerms = 64;   // Operands per long expression
+        std::uint32_t seed = 12345;
+    };
+
+    explicit ProgramGenerator(const Options &options);
+
+    std::string generate();
+
+    /**
+     * @brief Parses a shape name (mixed, procs, nesting, expressions, comments)
+     * @return false for an unknown name
+     */
+    static bool parseShape(const std::string &name, Shape &shape);
+    static const char *shapeName(Shape shape);
+
+private:
+    void appendProc(std::string &out);
+    void appendNesting(std::string &out, int depth);
+    void appendExpression(std::string &out);
+    void appendComments(std::string &out);
+    void appendOperand(std::string &out);
+    void indent(std::string &out, int level);
+
+    Options options;
+    std::mt19937 random;
+    std::size_t procCount = 0;
+    std::size_t unitCount = 0;
+};
+
+#endif // PROGRAM_GENERATOR_HPP
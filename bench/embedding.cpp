@@ -0,0 +1,138 @@
+/**
+ * @file embedding.cpp
+ * @brief Executions per second through the Program/ExecutionContext API
+ *
+ * Runs one script many times with a different input each time, first
+ * compiling it anew for every run (what embedding cost before Program
+ * existed), then compiling once and reusing one ExecutionContext. The
+ * script receives its input as the variable 'x'.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "Program.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    const char *DEFAULT_SCRIPT =
+        "proc score(int n, int k) => {\n"
+        "    int r = n * k;\n"
+        "    if(r < 100){\n"
+        "        r = r + 7;\n"
+        "    } else {\n"
+        "        r = r - 7;\n"
+        "    }\n"
+        "    result => {r};\n"
+        "}\n"
+        "\n"
+        "begin:\n"
+        "    int total = 0;\n"
+        "    for(int i = 0; i < 10; ++i){\n"
+        "        total = total + score(x, i);\n"
+        "    }\n"
+        "    out_to_console(total);\n"
+        "end\n";
+
+    void printUsage(const char *argv0)
+    {
+        std::printf("Usage: %s [options] [SCRIPT]\n"
+                    "  --runs=N    Executions per measurement (default 10000)\n"
+                    "SCRIPT is compiled from a file; it may read its input from the variable x.\n"
+                    "Without one, a small built-in script is used.\n",
+                    argv0);
+    }
+
+    std::shared_ptr<const Program> compileScript(const std::string &path)
+    {
+        std::string error;
+        std::shared_ptr<const Program> program = path.empty() ? Program::compile(DEFAULT_SCRIPT, "embedding", error)
+                                                              : Program::compileFile(path, error);
+        if (!program)
+        {
+            std::fprintf(stderr, "%s\n", error.c_str());
+        }
+        return program;
+    }
+
+    void printRow(const char *mode, int runs, double seconds)
+    {
+        std::printf("%-20s %10d %12.3f %14.0f %10.2f\n", mode, runs, seconds, runs / seconds, seconds / runs * 1e6);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int runs = 10000;
+    std::string scriptPath;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option == "--help")
+        {
+            printUsage(argv[0]);
+            return 0;
+        }
+        else if (option.rfind("--runs=", 0) == 0)
+        {
+            runs = std::max(1, std::atoi(option.c_str() + 7));
+        }
+        else if (option.rfind("--", 0) == 0)
+        {
+            std::fprintf(stderr, "Unknown option: %s\n", option.c_str());
+            printUsage(argv[0]);
+            return 2;
+        }
+        else
+        {
+            scriptPath = option;
+        }
+    }
+
+    std::printf("%-20s %10s %12s %14s %10s\n", "mode", "runs", "seconds", "runs/s", "us/run");
+
+    // Recompiling is far slower; a tenth of the runs is enough to time it
+    int compileRuns = std::max(1, runs / 10);
+    Clock::time_point start = Clock::now();
+    for (int run = 0; run < compileRuns; run++)
+    {
+        std::shared_ptr<const Program> program = compileScript(scriptPath);
+        if (!program)
+        {
+            return 2;
+        }
+        ExecutionContext context(program);
+        context.setInput("x", Value(run));
+        if (!context.run())
+        {
+            std::fprintf(stderr, "%s\n", context.getErrorReport().c_str());
+            return 2;
+        }
+    }
+    printRow("compile + run", compileRuns, std::chrono::duration<double>(Clock::now() - start).count());
+
+    std::shared_ptr<const Program> program = compileScript(scriptPath);
+    if (!program)
+    {
+        return 2;
+    }
+    ExecutionContext context(program);
+
+    start = Clock::now();
+    for (int run = 0; run < runs; run++)
+    {
+        context.setInput("x", Value(run));
+        if (!context.run())
+        {
+            std::fprintf(stderr, "%s\n", context.getErrorReport().c_str());
+            return 2;
+        }
+    }
+    printRow("reused context", runs, std::chrono::duration<double>(Clock::now() - start).count());
+    return 0;
+}
@@ -0,0 +1,283 @@
+/**
+ * @file frontend.cpp
+ * @brief Throughput benchmarks for the lexer and parser
+ *
+ * Generates programs of increasing size for each ProgramGenerator shape and
+ * measures, for each:
+ *  - lex:        Lexer::tokenize() over the whole program
+ *  - lex+parse:  Parser::parse() pulling tokens from a Lexer, as the
+ *                interpreter does
+ * reporting MB/s, millions of tokens/s and heap allocations per token.
+ * Each figure is the best of several runs.
+ *
+ * Throughput should stay flat as the input grows. When the largest size
+ * runs more than --max-slowdown percent slower (in MB/s) than the
+ * smallest, the scaling is reported as super-linear and the benchmark
+ * exits with 1.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ProgramGenerator.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "ErrorHandler.hpp"
+
+namespace
+{
+    std::atomic<std::uint64_t> allocations{0};
+}
+
+// Every heap allocation in the process is counted, so allocations per
+// token can be read off around a lex or parse
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+// GCC cannot tell this free() pairs with the malloc() above
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    operator delete(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        std::vector<double> sizesMb = {1, 2, 4, 8};
+        std::vector<ProgramGenerator::Shape> shapes = {ProgramGenerator::Shape::MIXED,
+                                                       ProgramGenerator::Shape::PROCS,
+                                                       ProgramGenerator::Shape::NESTING,
+                                                       ProgramGenerator::Shape::EXPRESSIONS,
+                                                       ProgramGenerator::Shape::COMMENTS};
+        int runs = 3;
+        double maxSlowdown = 50.0; // Percent
+    };
+
+    /**
+     * @brief Best-of-runs figures for one stage over one program
+     */
+    struct Measurement
+    {
+        double seconds = 0;
+        std::uint64_t tokens = 0;
+        std::uint64_t allocations = 0;
+    };
+
+    bool measureLex(const std::string &program, int runs, Measurement &best)
+    {
+        for (int run = 0; run < runs; run++)
+        {
+            Lexer lexer(program);
+            std::uint64_t before = allocations.load(std::memory_order_relaxed);
+            Clock::time_point start = Clock::now();
+
+            std::vector<Token *> tokens = lexer.tokenize();
+
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            std::uint64_t allocated = allocations.load(std::memory_order_relaxed) - before;
+            if (run == 0 || seconds < best.seconds)
+            {
+                best = Measurement{seconds, tokens.size(), allocated};
+            }
+            for (Token *token : tokens)
+            {
+                delete token;
+            }
+        }
+        return !ErrorHandler::getInstance().hasError();
+    }
+
+    bool measureParse(const std::string &program, int runs, std::uint64_t tokens, Measurement &best)
+    {
+        for (int run = 0; run < runs; run++)
+        {
+            Lexer lexer(program);
+            std::uint64_t before = allocations.load(std::memory_order_relaxed);
+            Clock::time_point start = Clock::now();
+
+            AST_NODE *root = nullptr;
+            {
+                Parser parser(lexer);
+                root = parser.parse();
+            }
+
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            std::uint64_t allocated = allocations.load(std::memory_order_relaxed) - before;
+            if (run == 0 || seconds < best.seconds)
+            {
+                best = Measurement{seconds, tokens, allocated};
+            }
+            deleteTree(root);
+        }
+        return !ErrorHandler::getInstance().hasError();
+    }
+
+    void printRow(const char *shape, double megabytes, const char *stage, const Measurement &measurement)
+    {
+        std::printf("%-12s %8.1f  %-10s %10.1f %10.2f %12.2f\n", shape, megabytes, stage,
+                    megabytes / measurement.seconds,
+                    measurement.tokens / measurement.seconds / 1e6,
+                    measurement.tokens ? static_cast<double>(measurement.allocations) / measurement.tokens : 0.0);
+    }
+
+    bool parseSizes(const std::string &list, std::vector<double> &sizes)
+    {
+        sizes.clear();
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            double size = std::atof(item.c_str());
+            if (size <= 0)
+            {
+                return false;
+            }
+            sizes.push_back(size);
+        }
+        std::sort(sizes.begin(), sizes.end());
+        return !sizes.empty();
+    }
+
+    void printUsage(const char *argv0)
+    {
+        std::printf("Usage: %s [options]\n"
+                    "  --sizes=MB,MB,...     Program sizes in MB (default 1,2,4,8)\n"
+                    "  --shape=NAME          mixed, procs, nesting, expressions or comments (default: all)\n"
+                    "  --runs=N              Runs per measurement, best kept (default 3)\n"
+                    "  --max-slowdown=PCT    Allowed MB/s drop from smallest to largest size (default 50)\n",
+                    argv0);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option == "--help")
+        {
+            printUsage(argv[0]);
+            return 0;
+        }
+        else if (option.rfind("--sizes=", 0) == 0)
+        {
+            if (!parseSizes(option.substr(8), options.sizesMb))
+            {
+                std::fprintf(stderr, "Invalid size list: %s\n", option.c_str());
+                return 2;
+            }
+        }
+        else if (option.rfind("--shape=", 0) == 0)
+        {
+            ProgramGenerator::Shape shape;
+            if (!ProgramGenerator::parseShape(option.substr(8), shape))
+            {
+                std::fprintf(stderr, "Unknown shape: %s\n", option.c_str());
+                return 2;
+            }
+            options.shapes = {shape};
+        }
+        else if (option.rfind("--runs=", 0) == 0)
+        {
+            options.runs = std::max(1, std::atoi(option.c_str() + 7));
+        }
+        else if (option.rfind("--max-slowdown=", 0) == 0)
+        {
+            options.maxSlowdown = std::atof(option.c_str() + 15);
+        }
+        else
+        {
+            std::fprintf(stderr, "Unknown option: %s\n", option.c_str());
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::printf("%-12s %8s  %-10s %10s %10s %12s\n", "shape", "MB", "stage", "MB/s", "Mtok/s", "allocs/tok");
+
+    bool superLinear = false;
+    for (ProgramGenerator::Shape shape : options.shapes)
+    {
+        const char *name = ProgramGenerator::shapeName(shape);
+        double firstLex = 0, firstParse = 0, lastLex = 0, lastParse = 0;
+
+        for (std::size_t i = 0; i < options.sizesMb.size(); i++)
+        {
+            ProgramGenerator::Options generatorOptions;
+            generatorOptions.shape = shape;
+            generatorOptions.targetBytes = static_cast<std::size_t>(options.sizesMb[i] * 1024 * 1024);
+            std::string program = ProgramGenerator(generatorOptions).generate();
+            double megabytes = program.size() / (1024.0 * 1024.0);
+
+            Measurement lex, parse;
+            if (!measureLex(program, options.runs, lex) || !measureParse(program, options.runs, lex.tokens, parse))
+            {
+                std::fprintf(stderr, "The generated %s program did not lex and parse cleanly\n", name);
+                return 2;
+            }
+            printRow(name, megabytes, "lex", lex);
+            printRow(name, megabytes, "lex+parse", parse);
+            std::fflush(stdout);
+
+            lastLex = megabytes / lex.seconds;
+            lastParse = megabytes / parse.seconds;
+            if (i == 0)
+            {
+                firstLex = lastLex;
+                firstParse = lastParse;
+            }
+        }
+
+        const double floor = 1.0 - options.maxSlowdown / 100.0;
+        if (options.sizesMb.size() > 1 && (lastLex < firstLex * floor || lastParse < firstParse * floor))
+        {
+            std::printf("%-12s SUPER-LINEAR: MB/s fell from %.1f to %.1f (lex), %.1f to %.1f (lex+parse)\n",
+                        name, firstLex, lastLex, firstParse, lastParse);
+            superLinear = true;
+        }
+    }
+
+    return superLinear ? 1 : 0;
+}
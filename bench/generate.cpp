@@ -0,0 +1,78 @@
+/**
+ * @file generate.cpp
+ * @brief Writes a synthetic Mini-Lang program (see ProgramGenerator)
+ *
+ * Usage: generate [--size=MB] [--shape=NAME] [--depth=N] [--terms=N] [--seed=N] [OUTPUT]
+ * The program goes to OUTPUT, or to stdout without one.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "ProgramGenerator.hpp"
+
+int main(int argc, char *argv[])
+{
+    ProgramGenerator::Options options;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option.rfind("--size=", 0) == 0)
+        {
+            options.targetBytes = static_cast<std::size_t>(std::atof(option.c_str() + 7) * 1024 * 1024);
+        }
+        else if (option.rfind("--shape=", 0) == 0)
+        {
+            if (!ProgramGenerator::parseShape(option.substr(8), options.shape))
+            {
+                std::cerr << "Unknown shape: " << option.substr(8)
+                          << " (mixed, procs, nesting, expressions, comments)" << std::endl;
+                return 2;
+            }
+        }
+        else if (option.rfind("--depth=", 0) == 0)
+        {
+            options.nestingDepth = std::max(1, std::atoi(option.c_str() + 8));
+        }
+        else if (option.rfind("--terms=", 0) == 0)
+        {
+            options.expressionTerms = std::max(1, std::atoi(option.c_str() + 8));
+        }
+        else if (option.rfind("--seed=", 0) == 0)
+        {
+            options.seed = static_cast<std::uint32_t>(std::strtoul(option.c_str() + 7, nullptr, 10));
+        }
+        else if (option.rfind("--", 0) == 0)
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--size=MB] [--shape=NAME] [--depth=N] [--terms=N] [--seed=N] [OUTPUT]" << std::endl;
+            return option == "--help" ? 0 : 2;
+        }
+        else
+        {
+            outputPath = option;
+        }
+    }
+
+    std::string program = ProgramGenerator(options).generate();
+
+    if (outputPath.empty())
+    {
+        std::fwrite(program.data(), 1, program.size(), stdout);
+        return 0;
+    }
+
+    std::ofstream out(outputPath, std::ios::binary);
+    if (!out.write(program.data(), static_cast<std::streamsize>(program.size())))
+    {
+        std::cerr << "Unable to write " << outputPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,555 @@
+/**
+ * @file harness.cpp
+ * @brief Benchmark harness for the interpreter
+ *
+ * Runs every program in the bench suite several times through the parser
+ * binary (interpret mode, output discarded) and reports, per program, the
+ * median and p95 wall time, operations per second and peak resident set
+ * size. Results can be written as a JSON baseline and later compared
+ * against one; a program whose median time or peak RSS grows by more than
+ * the threshold is reported as a regression and the harness exits with 1.
+ *
+ * Each program declares how many operations one run performs in a
+ * ">>$ bench-ops: N" comment (what counts as an operation is described
+ * next to it). Programs without one report runs per second instead.
+ *
+ * Peak RSS comes from wait4(), so it covers the child process only.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "RunCheck.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr int BASELINE_VERSION = 1;
+
+    struct Options
+    {
+        std::string parser = "build/production/parser";
+        std::string programDir = "bench/programs";
+        std::vector<std::string> programs; // Empty: every .mlng in programDir
+        int runs = 10;
+        int warmup = 1;
+        double threshold = 10.0; // Percent
+        std::string baselinePath;
+        std::string writeBaselinePath;
+    };
+
+    /**
+     * @brief Measurements for one program
+     */
+    struct Result
+    {
+        std::string name;
+        double medianMs = 0;
+        double p95Ms = 0;
+        double opsPerSecond = 0;
+        long peakRssKb = 0;
+        std::uint64_t ops = 0;
+    };
+
+    struct RunSample
+    {
+        double milliseconds = 0;
+        long maxRssKb = 0;
+        bool ok = false;
+    };
+
+    void printUsage(const char *argv0)
+    {
+        std::printf("Usage: %s [options] [PROGRAM.mlng...]\n"
+                    "  --parser=PATH          Interpreter binary (default build/production/parser)\n"
+                    "  --programs=DIR         Directory of bench programs (default bench/programs)\n"
+                    "  --runs=N               Timed runs per program (default 10)\n"
+                    "  --warmup=N             Untimed runs first (default 1)\n"
+                    "  --baseline=PATH        Compare against a JSON baseline\n"
+                    "  --write-baseline=PATH  Save the results as a JSON baseline\n"
+                    "  --threshold=PCT        Slowdown or RSS growth counted as a regression (default 10)\n",
+                    argv0);
+    }
+
+    /**
+     * @brief Reads the ">>$ bench-ops: N" declaration of a program, or 0
+     */
+    std::uint64_t readOpCount(const std::string &path)
+    {
+        std::ifstream in(path);
+        std::string line;
+        const std::string marker = "bench-ops:";
+        while (std::getline(in, line))
+        {
+            std::size_t at = line.find(marker);
+            if (at != std::string::npos)
+            {
+                return std::strtoull(line.c_str() + at + marker.size(), nullptr, 10);
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Runs the parser on one program with its output discarded
+     */
+    RunSample runOnce(const std::string &parser, const std::string &program)
+    {
+        RunSample sample;
+        auto start = std::chrono::steady_clock::now();
+
+        pid_t child = fork();
+        if (child < 0)
+        {
+            return sample;
+        }
+        if (child == 0)
+        {
+            int devNull = open("/dev/null", O_RDWR);
+            if (devNull >= 0)
+            {
+                dup2(devNull, STDIN_FILENO);
+                dup2(devNull, STDOUT_FILENO);
+                dup2(devNull, STDERR_FILENO);
+            }
+            execl(parser.c_str(), parser.c_str(), program.c_str(), "interpret", "--output=null", static_cast<char *>(nullptr));
+            _exit(127);
+        }
+
+        int status = 0;
+        struct rusage usage;
+        std::memset(&usage, 0, sizeof(usage));
+        if (wait4(child, &status, 0, &usage) < 0)
+        {
+            return sample;
+        }
+
+        sample.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        sample.maxRssKb = usage.ru_maxrss; // Kilobytes on Linux
+        sample.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        return sample;
+    }
+
+    double median(const std::vector<double> &sorted)
+    {
+        std::size_t middle = sorted.size() / 2;
+        return sorted.size() % 2 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2;
+    }
+
+    //---------------------------------------------------------------------
+    // Baseline files
+    //
+    // {"version": 1, "runs": N, "programs": {"fib": {"median_ms": ...,
+    //  "p95_ms": ..., "ops_per_sec": ..., "peak_rss_kb": ...}, ...}}
+    //
+    // The reader accepts any JSON but only looks at the fields above.
+    //---------------------------------------------------------------------
+
+    struct JsonValue
+    {
+        enum class Kind
+        {
+            NUMBER,
+            STRING,
+            OBJECT,
+            OTHER
+        };
+        Kind kind = Kind::OTHER;
+        double number = 0;
+        std::string text;
+        std::map<std::string, JsonValue> members;
+    };
+
+    class JsonReader
+    {
+    public:
+        explicit JsonReader(const std::string &text) : text(text) {}
+
+        bool parse(JsonValue &value)
+        {
+            return parseValue(value) && (skipSpace(), position == text.size());
+        }
+
+    private:
+        const std::string &text;
+        std::size_t position = 0;
+
+        void skipSpace()
+        {
+            while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position])))
+            {
+                position++;
+            }
+        }
+
+        bool consume(char expected)
+        {
+            skipSpace();
+            if (position < text.size() && text[position] == expected)
+            {
+                position++;
+                return true;
+            }
+            return false;
+        }
+
+        bool parseString(std::string &out)
+        {
+            if (!consume('"'))
+            {
+                return false;
+            }
+            while (position < text.size() && text[position] != '"')
+            {
+                if (text[position] == '\\' && position + 1 < text.size())
+                {
+                    position++;
+                }
+                out += text[position++];
+            }
+            return consume('"');
+        }
+
+        bool parseValue(JsonValue &value)
+        {
+            skipSpace();
+            if (position >= text.size())
+            {
+                return false;
+            }
+
+            char next = text[position];
+            if (next == '{')
+            {
+                position++;
+                value.kind = JsonValue::Kind::OBJECT;
+                if (consume('}'))
+                {
+                    return true;
+                }
+                do
+                {
+                    std::string key;
+                    if (!parseString(key) || !consume(':') || !parseValue(value.members[key]))
+                    {
+                        return false;
+                    }
+                } while (consume(','));
+                return consume('}');
+            }
+            if (next == '[')
+            {
+                // Arrays are not part of the format; skip their elements
+                position++;
+                if (consume(']'))
+                {
+                    return true;
+                }
+                do
+                {
+                    JsonValue element;
+                    if (!parseValue(element))
+                    {
+                        return false;
+                    }
+                } while (consume(','));
+                return consume(']');
+            }
+            if (next == '"')
+            {
+                value.kind = JsonValue::Kind::STRING;
+                return parseString(value.text);
+            }
+            if (next == '-' || std::isdigit(static_cast<unsigned char>(next)))
+            {
+                char *end = nullptr;
+                value.kind = JsonValue::Kind::NUMBER;
+                value.number = std::strtod(text.c_str() + position, &end);
+                position = static_cast<std::size_t>(end - text.c_str());
+                return true;
+            }
+            for (const char *word : {"true", "false", "null"})
+            {
+                if (text.compare(position, std::strlen(word), word) == 0)
+                {
+                    position += std::strlen(word);
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    double numberField(const JsonValue &object, const std::string &key)
+    {
+        auto it = object.members.find(key);
+        return (it != object.members.end() && it->second.kind == JsonValue::Kind::NUMBER) ? it->second.number : 0;
+    }
+
+    bool readBaseline(const std::string &path, std::map<std::string, Result> &baseline, std::string &error)
+    {
+        std::string text;
+        if (!runcheck::readFile(path, text))
+        {
+            error = "Unable to open baseline " + path;
+            return false;
+        }
+
+        JsonValue root;
+        if (!JsonReader(text).parse(root) || root.kind != JsonValue::Kind::OBJECT)
+        {
+            error = "Malformed baseline " + path;
+            return false;
+        }
+        if (numberField(root, "version") != BASELINE_VERSION)
+        {
+            error = "Unsupported baseline version in " + path;
+            return false;
+        }
+
+        auto programs = root.members.find("programs");
+        if (programs == root.members.end() || programs->second.kind != JsonValue::Kind::OBJECT)
+        {
+            error = "Baseline " + path + " has no programs";
+            return false;
+        }
+        for (const auto &entry : programs->second.members)
+        {
+            Result result;
+            result.name = entry.first;
+            result.medianMs = numberField(entry.second, "median_ms");
+            result.p95Ms = numberField(entry.second, "p95_ms");
+            result.opsPerSecond = numberField(entry.second, "ops_per_sec");
+            result.peakRssKb = static_cast<long>(numberField(entry.second, "peak_rss_kb"));
+            baseline[entry.first] = result;
+        }
+        return true;
+    }
+
+    bool writeBaseline(const std::string &path, const std::vector<Result> &results, int runs)
+    {
+        std::ofstream out(path);
+        if (!out)
+        {
+            return false;
+        }
+
+        char buffer[256];
+        out << "{\n  \"version\": " << BASELINE_VERSION << ",\n  \"runs\": " << runs << ",\n  \"programs\": {\n";
+        for (std::size_t i = 0; i < results.size(); i++)
+        {
+            const Result &result = results[i];
+            std::snprintf(buffer, sizeof(buffer),
+                          "    \"%s\": {\"median_ms\": %.3f, \"p95_ms\": %.3f, \"ops_per_sec\": %.0f, \"peak_rss_kb\": %ld}%s\n",
+                          result.name.c_str(), result.medianMs, result.p95Ms, result.opsPerSecond, result.peakRssKb,
+                          i + 1 < results.size() ? "," : "");
+            out << buffer;
+        }
+        out << "  }\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    /**
+     * @brief Percent change from a baseline value, or 0 without one
+     */
+    double change(double current, double base)
+    {
+        return base > 0 ? (current - base) / base * 100.0 : 0;
+    }
+
+    bool parseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string option = argv[i];
+            auto valueOf = [&option](const char *prefix) -> const char *
+            {
+                std::size_t length = std::strlen(prefix);
+                return option.compare(0, length, prefix) == 0 ? option.c_str() + length : nullptr;
+            };
+
+            if (option == "--help")
+            {
+                printUsage(argv[0]);
+                std::exit(0);
+            }
+            else if (const char *value = valueOf("--parser="))
+            {
+                options.parser = value;
+            }
+            else if (const char *value = valueOf("--programs="))
+            {
+                options.programDir = value;
+            }
+            else if (const char *value = valueOf("--runs="))
+            {
+                options.runs = std::max(1, std::atoi(value));
+            }
+            else if (const char *value = valueOf("--warmup="))
+            {
+                options.warmup = std::max(0, std::atoi(value));
+            }
+            else if (const char *value = valueOf("--threshold="))
+            {
+                options.threshold = std::atof(value);
+            }
+            else if (const char *value = valueOf("--baseline="))
+            {
+                options.baselinePath = value;
+            }
+            else if (const char *value = valueOf("--write-baseline="))
+            {
+                options.writeBaselinePath = value;
+            }
+            else if (option.rfind("--", 0) == 0)
+            {
+                std::fprintf(stderr, "Unknown option: %s\n", option.c_str());
+                return false;
+            }
+            else
+            {
+                options.programs.push_back(option);
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    if (access(options.parser.c_str(), X_OK) != 0)
+    {
+        std::fprintf(stderr, "Interpreter not found at %s (build it first)\n", options.parser.c_str());
+        return 2;
+    }
+
+    if (options.programs.empty())
+    {
+        std::error_code ec;
+        for (const auto &entry : fs::directory_iterator(options.programDir, ec))
+        {
+            if (entry.path().extension() == ".mlng")
+            {
+                options.programs.push_back(entry.path().string());
+            }
+        }
+        std::sort(options.programs.begin(), options.programs.end());
+    }
+    if (options.programs.empty())
+    {
+        std::fprintf(stderr, "No bench programs found in %s\n", options.programDir.c_str());
+        return 2;
+    }
+
+    std::map<std::string, Result> baseline;
+    if (!options.baselinePath.empty())
+    {
+        std::string error;
+        if (!readBaseline(options.baselinePath, baseline, error))
+        {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 2;
+        }
+    }
+
+    std::printf("%-18s %10s %10s %14s %12s", "program", "median ms", "p95 ms", "ops/sec", "peak RSS KB");
+    if (!baseline.empty())
+    {
+        std::printf(" %9s %9s", "time", "RSS");
+    }
+    std::printf("\n");
+
+    std::vector<Result> results;
+    bool failed = false;
+    bool regressed = false;
+    for (const std::string &program : options.programs)
+    {
+        Result result;
+        result.name = fs::path(program).stem().string();
+        result.ops = readOpCount(program);
+
+        std::vector<double> times;
+        bool ok = true;
+        for (int run = 0; run < options.warmup + options.runs && ok; run++)
+        {
+            RunSample sample = runOnce(options.parser, program);
+            ok = sample.ok;
+            if (run >= options.warmup)
+            {
+                times.push_back(sample.milliseconds);
+                result.peakRssKb = std::max(result.peakRssKb, sample.maxRssKb);
+            }
+        }
+        if (!ok)
+        {
+            std::printf("%-18s FAILED (non-zero exit)\n", result.name.c_str());
+            failed = true;
+            continue;
+        }
+
+        std::sort(times.begin(), times.end());
+        result.medianMs = median(times);
+        result.p95Ms = runcheck::percentile(times, 0.95);
+        result.opsPerSecond = (result.ops ? result.ops : 1) / (result.medianMs / 1000.0);
+
+        std::printf("%-18s %10.2f %10.2f %14.0f %12ld", result.name.c_str(), result.medianMs, result.p95Ms,
+                    result.opsPerSecond, result.peakRssKb);
+
+        auto base = baseline.find(result.name);
+        if (base != baseline.end())
+        {
+            double timeChange = change(result.medianMs, base->second.medianMs);
+            double rssChange = change(static_cast<double>(result.peakRssKb), static_cast<double>(base->second.peakRssKb));
+            bool slower = timeChange > options.threshold || rssChange > options.threshold;
+            std::printf(" %+8.1f%% %+8.1f%%%s", timeChange, rssChange, slower ? "  REGRESSION" : "");
+            regressed = regressed || slower;
+        }
+        else if (!baseline.empty())
+        {
+            std::printf(" %9s %9s", "new", "new");
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+        results.push_back(result);
+    }
+
+    if (!options.writeBaselinePath.empty())
+    {
+        if (!writeBaseline(options.writeBaselinePath, results, options.runs))
+        {
+            std::fprintf(stderr, "Unable to write baseline %s\n", options.writeBaselinePath.c_str());
+            return 2;
+        }
+        std::printf("Wrote baseline to %s\n", options.writeBaselinePath.c_str());
+    }
+
+    if (regressed)
+    {
+        std::printf("Regressions above %.1f%% against %s\n", options.threshold, options.baselinePath.c_str());
+    }
+    return (failed || regressed) ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+#!/bin/bash
+
+# Benchmark script: builds the production interpreter and the bench harness,
+# then runs the bench suite against the stored baseline. With --frontend it
+# runs the lexer/parser throughput benchmarks instead, and with --embedding
+# the compile-once/run-many benchmark.
+# ---------------------------------------------------------------------------
+
+set -e
+
+RED='\033[0;31m'
+YELLOW='\033[0;33m'
+BLUE='\033[0;34m'
+NC='\033[0m' # No Color
+
+PROJECT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+SRC_DIR="${PROJECT_DIR}/src"
+BUILD_DIR="${PROJECT_DIR}/build/production"
+PARSER="${BUILD_DIR}/parser"
+HARNESS="${PROJECT_DIR}/build/bench_harness"
+HARNESS_SRC="${PROJECT_DIR}/bench/harness.cpp"
+FRONTEND="${PROJECT_DIR}/build/bench_frontend"
+GENERATOR="${PROJECT_DIR}/build/generate"
+EMBEDDING="${PROJECT_DIR}/build/bench_embedding"
+BASELINE="${PROJECT_DIR}/bench/baseline.json"
+CXXFLAGS="-std=c++17 -Wall -Wextra -pthread -O2 -DNDEBUG -DMINILANG_PRODUCTION"
+
+if [[ "$1" == "--help" ]]; then
+    echo -e "Usage: ./bench.sh [--update-baseline] [harness options]"
+    echo -e "       ./bench.sh --frontend [frontend options]"
+    echo -e "       ./bench.sh --embedding [embedding options]"
+    echo -e "  --update-baseline  Rewrite bench/baseline.json from this run instead of comparing"
+    echo -e "  --frontend         Lexer/parser throughput over generated programs"
+    echo -e "  --embedding        Executions per second through Program/ExecutionContext"
+    echo -e "Other options are passed through; see build/bench_harness --help, build/bench_frontend --help"
+    echo -e "and build/bench_embedding --help"
+    exit 0
+fi
+
+# The front-end benchmarks link the lexer and parser directly
+if [[ "$1" == "--frontend" ]]; then
+    shift
+    mkdir -p "${PROJECT_DIR}/build"
+    echo -e "${YELLOW}Building front-end benchmarks...${NC}"
+    g++ $CXXFLAGS -I"$SRC_DIR" -I"${PROJECT_DIR}/bench" "${PROJECT_DIR}/bench/frontend.cpp" "${PROJECT_DIR}/bench/ProgramGenerator.cpp" \
+        $(find "$SRC_DIR" -name "*.cpp" ! -name "pilotParser.cpp" | sort -u) -o "$FRONTEND"
+    g++ -std=c++17 -Wall -Wextra -O2 "${PROJECT_DIR}/bench/generate.cpp" "${PROJECT_DIR}/bench/ProgramGenerator.cpp" -o "$GENERATOR"
+    echo -e "${BLUE}Running front-end benchmarks...${NC}"
+    "$FRONTEND" "$@"
+    exit $?
+fi
+
+# The embedding benchmark links the interpreter as a library would
+if [[ "$1" == "--embedding" ]]; then
+    shift
+    mkdir -p "${PROJECT_DIR}/build"
+    echo -e "${YELLOW}Building embedding benchmark...${NC}"
+    g++ $CXXFLAGS -I"$SRC_DIR" "${PROJECT_DIR}/bench/embedding.cpp" \
+        $(find "$SRC_DIR" -name "*.cpp" ! -name "pilotParser.cpp" | sort -u) -o "$EMBEDDING"
+    cd "$PROJECT_DIR"
+    echo -e "${BLUE}Running embedding benchmark...${NC}"
+    "$EMBEDDING" "$@"
+    exit $?
+fi
+
+HARNESS_ARGS=()
+UPDATE_BASELINE=false
+for arg in "$@"; do
+    if [[ "$arg" == "--update-baseline" ]]; then
+        UPDATE_BASELINE=true
+    else
+        HARNESS_ARGS+=("$arg")
+    fi
+done
+
+mkdir -p "$BUILD_DIR"
+
+# Same flags as run.sh --production, so the numbers match what ships
+if [[ ! -f "$PARSER" || $(find "$SRC_DIR" -name "*.cpp" -newer "$PARSER" 2>/dev/null | wc -l) -gt 0 || $(find "$SRC_DIR" -name "*.hpp" -newer "$PARSER" 2>/dev/null | wc -l) -gt 0 ]]; then
+    echo -e "${YELLOW}Building production interpreter...${NC}"
+    g++ $CXXFLAGS -I"$SRC_DIR" $(find "$SRC_DIR" -name "*.cpp" | sort -u) -o "$PARSER"
+fi
+
+if [[ ! -f "$HARNESS" || "$HARNESS_SRC" -nt "$HARNESS" || "${SRC_DIR}/RunCheck.hpp" -nt "$HARNESS" ]]; then
+    echo -e "${YELLOW}Building bench harness...${NC}"
+    g++ -std=c++17 -Wall -Wextra -O2 -I"$SRC_DIR" "$HARNESS_SRC" -o "$HARNESS"
+fi
+
+# Library and source paths in the programs are relative to the project root
+cd "$PROJECT_DIR"
+
+if [[ "$UPDATE_BASELINE" == true ]]; then
+    HARNESS_ARGS+=("--write-baseline=${BASELINE}")
+elif [[ -f "$BASELINE" ]]; then
+    HARNESS_ARGS+=("--baseline=${BASELINE}")
+else
+    echo -e "${RED}No baseline at ${BASELINE}; run with --update-baseline to create one${NC}"
+fi
+
+echo -e "${BLUE}Running bench suite...${NC}"
+"$HARNESS" --parser="$PARSER" "${HARNESS_ARGS[@]}"
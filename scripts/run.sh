@@ -15,7 +15,9 @@ EXECUTABLE="${BUILD_DIR}/${PROJECT_NAME}"
 TEST_DATA_DIR="../tests"
 FINAL_DATA_DIR="../Final"
 INPUT_FILE="${FINAL_DATA_DIR}/randomNumber.mlng"
-MODE="all"  # Default mode
+MODE=""  # Default: all, or interpret for production builds
+PRODUCTION=false
+CXXFLAGS="-std=c++17 -Wall -Wextra -pthread"
 
 # Create color codes for output formatting
 RED='\033[0;31m'
@@ -40,11 +42,16 @@ while [[ $# -gt 0 ]]; do
             INPUT_FILE="${1#*=}"
             shift
             ;;
+        --production)
+            PRODUCTION=true
+            shift
+            ;;
         --help)
             echo -e "Usage: ./run.sh [options]"
             echo -e "Options:"
-            echo -e "  --mode=MODE      Set execution mode (lex, parse, interpret, all)"
+            echo -e "  --mode=MODE      Set execution mode (lex, parse, interpret, profile, all)"
             echo -e "  --input=FILE     Specify input file path"
+            echo -e "  --production     Optimized build with debug tracing compiled out"
             echo -e "  --help           Show this help message"
             exit 0
             ;;
@@ -56,10 +63,21 @@ while [[ $# -gt 0 ]]; do
     esac
 done
 
+# Production builds live in their own directory so the two configurations
+# never share object files
+if [[ "$PRODUCTION" == true ]]; then
+    BUILD_DIR="${BUILD_DIR}/production"
+    EXECUTABLE="${BUILD_DIR}/${PROJECT_NAME}"
+    CXXFLAGS="${CXXFLAGS} -O2 -DNDEBUG -DMINILANG_PRODUCTION"
+    MODE="${MODE:-interpret}"
+else
+    MODE="${MODE:-all}"
+fi
+
 # Validate selected mode
-if [[ "$MODE" != "lex" && "$MODE" != "parse" && "$MODE" != "interpret" && "$MODE" != "all" ]]; then
+if [[ "$MODE" != "lex" && "$MODE" != "parse" && "$MODE" != "interpret" && "$MODE" != "profile" && "$MODE" != "all" ]]; then
     echo -e "${RED}Invalid mode: ${MODE}${NC}"
-    echo -e "${YELLOW}Valid modes: lex, parse, interpret, all${NC}"
+    echo -e "${YELLOW}Valid modes: lex, parse, interpret, profile, all${NC}"
     exit 1
 fi
 
@@ -75,6 +93,8 @@ if [[ ! -f "$EXECUTABLE" || $(find "$SRC_DIR" -name "*.cpp" -newer "$EXECUTABLE"
     
     # Create build directory if it doesn't exist
     mkdir -p "$BUILD_DIR"
+    SRC_DIR=$(cd "$SRC_DIR" && pwd)
+    LIBRARY_DIR=$(cd "$LIBRARY_DIR" && pwd)
     cd "$BUILD_DIR"
     
     # Clean up any old object files to prevent linking issues
@@ -91,13 +111,13 @@ if [[ ! -f "$EXECUTABLE" || $(find "$SRC_DIR" -name "*.cpp" -newer "$EXECUTABLE"
     for src in $SRC_FILES $LIB_FILES; do
         obj=$(basename "$src" .cpp).o
         echo -e "${YELLOW}Compiling: $src${NC}"
-        g++ -std=c++17 -Wall -Wextra -I"$SRC_DIR" -c "$src" -o "$obj"
+        g++ $CXXFLAGS -I"$SRC_DIR" -c "$src" -o "$obj"
         OBJECTS="$OBJECTS $obj"
     done
     
     # Link all object files
     echo -e "${BLUE}Linking: g++ $OBJECTS -o ${PROJECT_NAME}${NC}"
-    g++ $OBJECTS -o "${PROJECT_NAME}"
+    g++ -pthread $OBJECTS -o "${PROJECT_NAME}"
     
     if [[ $? -eq 0 ]]; then
         echo -e "${GREEN}Compilation successful!${NC}"
@@ -0,0 +1,35 @@
+#!/bin/bash
+
+# Concurrency stress test: builds tests/stress.cpp against the interpreter
+# sources and runs every golden fixture on many threads at once, each in
+# its own ExecutionContext, checking the outputs against tests/expected
+# and that the failing scripts in tests/errors fail without harming the rest.
+# Before and after, it checks SourceMap registration and NO_LOCATION handling
+# and the embedding memory budget (MemoryStats::setBudget).
+# ---------------------------------------------------------------------------
+
+set -e
+
+YELLOW='\033[0;33m'
+BLUE='\033[0;34m'
+NC='\033[0m' # No Color
+
+PROJECT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+SRC_DIR="${PROJECT_DIR}/src"
+STRESS="${PROJECT_DIR}/build/stress"
+CXXFLAGS="-std=c++17 -Wall -Wextra -pthread -O2"
+
+if [[ "$1" == "--help" ]]; then
+    echo -e "Usage: ./stress.sh [--threads=N] [--rounds=N] [--shared]"
+    exit 0
+fi
+
+mkdir -p "${PROJECT_DIR}/build"
+echo -e "${YELLOW}Building stress test...${NC}"
+g++ $CXXFLAGS -I"$SRC_DIR" "${PROJECT_DIR}/tests/stress.cpp" \
+    $(find "$SRC_DIR" -name "*.cpp" ! -name "pilotParser.cpp" | sort -u) -o "$STRESS"
+
+# Fixture and header paths are relative to the project root
+cd "$PROJECT_DIR"
+echo -e "${BLUE}Running fixtures concurrently...${NC}"
+"$STRESS" "$@"
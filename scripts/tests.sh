@@ -15,13 +15,17 @@ PARSER="${BUILD_DIR}/parser"
 FIXTURES_DIR="${TEST_DIR}/fixtures"
 INTEGRATION_DIR="${TEST_DIR}/integration"
 EXPECTED_DIR="${TEST_DIR}/expected"
+INPUT_DIR="${TEST_DIR}/input"
 RESULTS_DIR="${TEST_DIR}/results"
-OUTPUT_DIR="${PROJECT_DIR}/output"
 
 # Create directories if they don't exist
 mkdir -p "${RESULTS_DIR}"
 mkdir -p "${EXPECTED_DIR}"
 
+# Cache files of the --cache runs, kept out of the source tree
+CACHE_DIR="$(mktemp -d)"
+trap 'rm -rf "${CACHE_DIR}"' EXIT
+
 # Check if parser exists
 if [ ! -f "${PARSER}" ]; then
     echo -e "${RED}Error: Parser executable not found at: ${PARSER}${NC}"
@@ -45,11 +49,18 @@ run_test() {
     echo -n "Testing ${filename}... "
     TOTAL=$((TOTAL + 1))
     
-    # Clear any previous output files or set a specific output file for this test
-    rm -f ${OUTPUT_DIR}/output_* 2>/dev/null
+    # The program's output goes straight to this test's results file
+    local output_file="${RESULTS_DIR}/${filename}.out"
+    rm -f "${output_file}"
     
-    # Run the test - debug output goes to terminal
-    "${PARSER}" "${test_file}" interpret
+    # Run the test - diagnostics go to the terminal. Tests that read input
+    # get it from tests/input/<name>.in when there is one.
+    local input_file="${INPUT_DIR}/${filename}.in"
+    if [ -f "${input_file}" ]; then
+        "${PARSER}" "${test_file}" interpret "--output=file:${output_file}" < "${input_file}"
+    else
+        "${PARSER}" "${test_file}" interpret "--output=file:${output_file}"
+    fi
     local run_status=$?
     
     if [ $run_status -ne 0 ]; then
@@ -59,23 +70,47 @@ run_test() {
         return 1
     fi
     
-    # Find the most recent output file
-    local output_file=$(ls -t ${OUTPUT_DIR}/output_* 2>/dev/null | head -1)
-    
-    if [ -z "$output_file" ]; then
-        echo -e "${RED}No output file found in ${OUTPUT_DIR}${NC}"
+    if [ ! -f "$output_file" ]; then
+        echo -e "${RED}No output file written to ${output_file}${NC}"
         FAILED=$((FAILED + 1))
         FAILED_TESTS+=("$filename")
         return 1
     fi
     
-    # Copy the most recent output to results directory
-    cp "$output_file" "${RESULTS_DIR}/${filename}.out"
-    
     # Compare with expected output
     local expected_file="${EXPECTED_DIR}/${filename}.expected"
     if [ -f "${expected_file}" ]; then
         if diff -w "${expected_file}" "${RESULTS_DIR}/${filename}.out" > /dev/null; then
+            # A parse listing, where present, also pins down the tree's shape
+            # (such as how many times a header is attached)
+            local parse_expected="${EXPECTED_DIR}/${filename}.parse.expected"
+            if [ -f "${parse_expected}" ] && \
+                ! "${PARSER}" "${test_file}" parse | diff -w "${parse_expected}" - > /dev/null; then
+                echo -e "${RED}FAILED (parse listing mismatch)${NC}"
+                "${PARSER}" "${test_file}" parse | diff -w "${parse_expected}" -
+                FAILED=$((FAILED + 1))
+                FAILED_TESTS+=("$filename")
+                return 1
+            fi
+            # Twice more with --cache: the first run stores the parsed
+            # program, the second is rebuilt from it
+            local pass
+            for pass in store hit; do
+                local cached_output="${CACHE_DIR}/${filename}.${pass}.out"
+                if [ -f "${input_file}" ]; then
+                    MINILANG_CACHE_DIR="${CACHE_DIR}" "${PARSER}" "${test_file}" interpret --cache \
+                        "--output=file:${cached_output}" < "${input_file}"
+                else
+                    MINILANG_CACHE_DIR="${CACHE_DIR}" "${PARSER}" "${test_file}" interpret --cache \
+                        "--output=file:${cached_output}"
+                fi
+                if ! diff -w "${expected_file}" "${cached_output}" > /dev/null; then
+                    echo -e "${RED}FAILED (output mismatch with --cache, ${pass} run)${NC}"
+                    FAILED=$((FAILED + 1))
+                    FAILED_TESTS+=("$filename")
+                    return 1
+                fi
+            done
             echo -e "${GREEN}PASSED${NC}"
             PASSED=$((PASSED + 1))
             return 0
@@ -97,6 +132,68 @@ run_test() {
     fi
 }
 
+# One step of the cache tests: runs main.txt in the scratch directory with
+# --cache and checks its output and whether each cache file was rewritten.
+# Usage: cache_step <description> <expected output> <mlc: kept|rewritten> <mllc: kept|rewritten>
+cache_step() {
+    local description="$1" expected="$2" program_cache="$3" library_cache="$4"
+    local work="${CACHE_DIR}/scratch"
+
+    echo -n "Cache: ${description}... "
+    TOTAL=$((TOTAL + 1))
+
+    # A rewrite renames a new file into place, so it shows as a new inode
+    local mlc_before=$(stat -c %i "${work}"/cache/*.mlc 2>/dev/null)
+    local mllc_before=$(stat -c %i "${work}"/cache/*.mllc 2>/dev/null)
+
+    local output
+    output=$(cd "${work}" && MINILANG_CACHE_DIR="${work}/cache" "${PARSER}" main.txt interpret --cache \
+        "--output=file:${work}/out.txt" > /dev/null && cat "${work}/out.txt")
+    local got_mlc=kept got_mllc=kept
+    [ "$(stat -c %i "${work}"/cache/*.mlc 2>/dev/null)" != "${mlc_before}" ] && got_mlc=rewritten
+    [ "$(stat -c %i "${work}"/cache/*.mllc 2>/dev/null)" != "${mllc_before}" ] && got_mllc=rewritten
+
+    if [ "$(echo ${output})" != "$(echo ${expected})" ]; then
+        echo -e "${RED}FAILED (expected '${expected}', got '${output}')${NC}"
+    elif [ "${got_mlc}" != "${program_cache}" ] || [ "${got_mllc}" != "${library_cache}" ]; then
+        echo -e "${RED}FAILED (.mlc ${got_mlc}, .mllc ${got_mllc}; expected ${program_cache}, ${library_cache})${NC}"
+    else
+        echo -e "${GREEN}PASSED${NC}"
+        PASSED=$((PASSED + 1))
+        return 0
+    fi
+    FAILED=$((FAILED + 1))
+    FAILED_TESTS+=("cache: ${description}")
+    return 1
+}
+
+# Cache hits and invalidation (.mlc program and .mllc library caches) on a
+# scratch script with a header and a library
+run_cache_tests() {
+    local work="${CACHE_DIR}/scratch"
+    mkdir -p "${work}/libraries"
+    printf 'needs: {\n    source: "part.hmlng"\n    library: "area"\n}\n\nbegin:\n    out_to_console(addOne(41));\n    ...\n    out_to_console(area(3, 4));\nend\n' > "${work}/main.txt"
+    printf '@once\n\nproc addOne(int a) => {\n    result => {a + 1};\n}\n\n@last\n' > "${work}/part.hmlng"
+    printf 'proc area(int w, int h) => {\n    result => {w * h};\n}\n' > "${work}/libraries/area.mllib"
+
+    echo -e "${YELLOW}Running cache tests...${NC}"
+    cache_step "first run stores" "42 12" rewritten rewritten
+    cache_step "unchanged files hit" "42 12" kept kept
+    sed -i 's/addOne(41)/addOne(9)/' "${work}/main.txt"
+    cache_step "changed script" "10 12" rewritten kept
+    sed -i 's/a + 1/a + 2/' "${work}/part.hmlng"
+    cache_step "changed header" "11 12" rewritten kept
+    sed -i 's/w \* h/w + h + 0/' "${work}/libraries/area.mllib"
+    cache_step "changed library" "11 7" kept rewritten
+    local mlc=$(ls "${work}"/cache/*.mlc)
+    head -c 100 "${mlc}" > "${work}/truncated" && mv "${work}/truncated" "${mlc}"
+    cache_step "truncated .mlc" "11 7" rewritten kept
+    local mllc=$(ls "${work}"/cache/*.mllc)
+    printf 'not a cache file' > "${mllc}"
+    cache_step "corrupt .mllc" "11 7" kept rewritten
+    cache_step "hit after repair" "11 7" kept kept
+}
+
 # Main function to run tests
 run_tests() {
     echo -e "${BLUE}======================================${NC}"
@@ -131,6 +228,8 @@ run_tests() {
         else
             echo -e "${YELLOW}No integration tests found in ${INTEGRATION_DIR}${NC}"
         fi
+
+        run_cache_tests
     fi
     
     # Print summary
@@ -152,6 +251,23 @@ run_tests() {
     return 0
 }
 
+# Run every fixture in one parser process, on all cores (see BatchRunner)
+run_batch() {
+    local status=0
+    for dir in "${FIXTURES_DIR}" "${INTEGRATION_DIR}"; do
+        if [ -d "${dir}" ] && [ "$(ls -A ${dir})" ]; then
+            echo -e "${YELLOW}Running ${dir} in batch mode...${NC}"
+            "${PARSER}" "${dir}" batch "--expected=${EXPECTED_DIR}" "--inputs=${INPUT_DIR}" \
+                "--results=${RESULTS_DIR}" || status=1
+        fi
+    done
+    return $status
+}
+
 # Run the tests
-run_tests "$1"
+if [ "$1" == "--batch" ]; then
+    run_batch
+else
+    run_tests "$1"
+fi
 exit $?
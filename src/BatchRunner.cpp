@@ -0,0 +1,238 @@
+#include "BatchRunner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+#include "Program.hpp"
+#include "RunCheck.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+}
+
+bool BatchRunner::addScripts(const std::string &source, std::string &error)
+{
+    std::error_code ec;
+    if (fs::is_directory(source, ec))
+    {
+        std::vector<std::string> found;
+        for (const fs::directory_entry &entry : fs::directory_iterator(source, ec))
+        {
+            fs::path extension = entry.path().extension();
+            if (entry.is_regular_file(ec) && (extension == ".txt" || extension == ".mlng"))
+            {
+                found.push_back(entry.path().string());
+            }
+        }
+        if (ec)
+        {
+            error = "Unable to read directory " + source + ": " + ec.message();
+            return false;
+        }
+        std::sort(found.begin(), found.end());
+        scripts.insert(scripts.end(), found.begin(), found.end());
+        return true;
+    }
+
+    std::ifstream list(source);
+    if (!list)
+    {
+        error = "Unable to open script list " + source;
+        return false;
+    }
+
+    fs::path base = fs::path(source).parent_path();
+    std::string line;
+    while (std::getline(list, line))
+    {
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        fs::path path(line);
+        scripts.push_back(path.is_absolute() ? path.string() : (base / path).string());
+    }
+    return true;
+}
+
+BatchRunner::Result BatchRunner::runScript(const std::string &path) const
+{
+    Result result;
+    Clock::time_point start = Clock::now();
+    std::string name = fs::path(path).filename().string();
+
+    try
+    {
+        std::string error;
+        std::shared_ptr<const Program> program = Program::compileFile(path, error, options.useCache);
+        if (!program)
+        {
+            result.status = Status::COMPILE_FAILED;
+            result.detail = error;
+            result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            return result;
+        }
+
+        // Diagnostics are reported with the script's name once the batch is done
+        ExecutionContext context(program);
+        context.setErrorEcho(false);
+
+        std::string input;
+        if (!options.inputDir.empty())
+        {
+            runcheck::readFile((fs::path(options.inputDir) / (name + ".in")).string(), input);
+        }
+        context.setInputText(input);
+
+        bool succeeded = context.run();
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::string output = context.getOutput();
+
+        if (!options.resultsDir.empty())
+        {
+            std::string resultPath = (fs::path(options.resultsDir) / (name + ".out")).string();
+            std::ofstream file(resultPath, std::ios::binary);
+            file << output;
+            if (!file)
+            {
+                std::cerr << "Warning: Unable to write " << resultPath << std::endl;
+            }
+        }
+
+        if (!succeeded)
+        {
+            result.status = Status::RUN_FAILED;
+            result.detail = context.getErrorReport();
+            return result;
+        }
+
+        if (!options.expectedDir.empty())
+        {
+            std::string expected;
+            if (!runcheck::readFile((fs::path(options.expectedDir) / (name + ".expected")).string(), expected))
+            {
+                result.status = Status::NO_EXPECTED;
+            }
+            else if (!runcheck::matchesExpected(output, expected))
+            {
+                result.status = Status::MISMATCH;
+                result.detail = output;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        // Anything escaping here would end the whole batch
+        result.status = Status::RUN_FAILED;
+        result.detail = e.what();
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    return result;
+}
+
+int BatchRunner::run()
+{
+    if (!options.resultsDir.empty())
+    {
+        std::error_code ec;
+        fs::create_directories(options.resultsDir, ec);
+    }
+
+    std::vector<Result> results(scripts.size());
+    std::size_t threads = 0;
+    unsigned long long steals = 0;
+
+    Clock::time_point start = Clock::now();
+    {
+        WorkStealingPool pool(options.threads);
+        threads = pool.getThreadCount();
+        for (std::size_t i = 0; i < scripts.size(); i++)
+        {
+            // Each task writes only its own slot, so results needs no lock
+            pool.submit([this, &results, i]
+                        { results[i] = runScript(scripts[i]); });
+        }
+        pool.wait();
+        steals = pool.getStealCount();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Reported in list order, whichever thread ran the script
+    bool allPassed = true;
+    for (std::size_t i = 0; i < scripts.size(); i++)
+    {
+        const Result &result = results[i];
+        switch (result.status)
+        {
+        case Status::PASSED:
+            break;
+        case Status::NO_EXPECTED:
+            std::cerr << "WARNING " << scripts[i] << ": no expected output" << std::endl;
+            break;
+        case Status::COMPILE_FAILED:
+            std::cerr << "FAIL " << scripts[i] << ": did not compile\n" << result.detail << std::endl;
+            allPassed = false;
+            break;
+        case Status::RUN_FAILED:
+            std::cerr << "FAIL " << scripts[i] << ": execution failed\n" << result.detail << std::endl;
+            allPassed = false;
+            break;
+        case Status::MISMATCH:
+            std::cerr << "FAIL " << scripts[i] << ": output mismatch, got:\n" << result.detail << std::endl;
+            allPassed = false;
+            break;
+        }
+    }
+
+    printSummary(results, threads, steals, seconds);
+    return allPassed ? 0 : 1;
+}
+
+void BatchRunner::printSummary(const std::vector<Result> &results, std::size_t threads, unsigned long long steals,
+                               double seconds) const
+{
+    std::size_t counts[5] = {};
+    std::vector<double> latencies;
+    latencies.reserve(results.size());
+    for (const Result &result : results)
+    {
+        counts[static_cast<std::size_t>(result.status)]++;
+        latencies.push_back(result.seconds * 1e3);
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::size_t failed = counts[static_cast<std::size_t>(Status::COMPILE_FAILED)] +
+                         counts[static_cast<std::size_t>(Status::RUN_FAILED)];
+
+    char row[160];
+    std::cout << "\n===== BATCH =====\n\n";
+    std::snprintf(row, sizeof(row), "%-12s %zu (%zu passed, %zu failed, %zu mismatched, %zu without expected output)\n",
+                  "scripts", results.size(), counts[static_cast<std::size_t>(Status::PASSED)], failed,
+                  counts[static_cast<std::size_t>(Status::MISMATCH)],
+                  counts[static_cast<std::size_t>(Status::NO_EXPECTED)]);
+    std::cout << row;
+    std::snprintf(row, sizeof(row), "%-12s %zu (%llu scripts stolen)\n", "threads", threads, steals);
+    std::cout << row;
+    std::snprintf(row, sizeof(row), "%-12s %.3f s\n", "wall time", seconds);
+    std::cout << row;
+    std::snprintf(row, sizeof(row), "%-12s %.1f scripts/s\n", "throughput",
+                  seconds > 0 ? results.size() / seconds : 0.0);
+    std::cout << row;
+    std::snprintf(row, sizeof(row), "%-12s p50 %.3f ms, p99 %.3f ms, max %.3f ms\n", "latency",
+                  runcheck::percentile(latencies, 0.50), runcheck::percentile(latencies, 0.99), latencies.empty() ? 0.0 : latencies.back());
+    std::cout << row;
+    std::cout.flush();
+}
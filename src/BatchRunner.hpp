@@ -0,0 +1,82 @@
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Runs many scripts in one process on a WorkStealingPool
+ *
+ * This is the parser binary's 'batch' mode. Each script is compiled with
+ * Program::compileFile and run in an ExecutionContext of its own, and its
+ * output transcript is kept in memory. The transcript can be compared with
+ * a golden file (ignoring whitespace within lines, like diff -w) and
+ * written to a results directory. Headers and imported libraries are
+ * loaded once for the whole batch, through the HeaderCache and the
+ * LibraryUnitCache; with useCache, .mlc and .mllc cache files are reused
+ * as well.
+ *
+ * Files are looked up by the script's file name: <name>.expected,
+ * <name>.in and <name>.out, as in scripts/tests.sh. A script without an
+ * input file reads empty input rather than stdin, which the workers
+ * cannot share.
+ */
+class BatchRunner
+{
+public:
+    struct Options
+    {
+        std::size_t threads = 0;  // 0: one per hardware thread
+        std::string expectedDir;  // Golden <name>.expected files; empty to skip comparison
+        std::string inputDir;     // <name>.in files fed to input statements
+        std::string resultsDir;   // Where to write <name>.out transcripts; empty to keep none
+        bool useCache = false;    // Reuse .mlc and .mllc cache files
+    };
+
+    explicit BatchRunner(const Options &options) : options(options) {}
+
+    /**
+     * @brief Adds the scripts in a directory or named in a list file
+     * @param source A directory (its .txt and .mlng files, in name order) or a
+     *               file with one script path per line; blank lines and lines
+     *               starting with '#' are skipped, relative paths are taken
+     *               from the list file's directory
+     * @return false (with error set) if the source cannot be read
+     */
+    bool addScripts(const std::string &source, std::string &error);
+
+    std::size_t getScriptCount() const { return scripts.size(); }
+
+    /**
+     * @brief Runs every script, reports failures on stderr and a summary on stdout
+     * @return 0 if every script ran and matched its expected output, 1 otherwise
+     */
+    int run();
+
+private:
+    enum class Status
+    {
+        PASSED,       // Ran and matched, or ran with nothing to compare
+        NO_EXPECTED,  // Ran, but comparison was asked for and there is no golden file
+        COMPILE_FAILED,
+        RUN_FAILED,
+        MISMATCH
+    };
+
+    struct Result
+    {
+        Status status = Status::PASSED;
+        std::string detail; // Error report or where the output went
+        double seconds = 0; // Compile and run
+    };
+
+    Result runScript(const std::string &path) const;
+    void printSummary(const std::vector<Result> &results, std::size_t threads, unsigned long long steals,
+                      double seconds) const;
+
+    Options options;
+    std::vector<std::string> scripts;
+};
+
+#endif // BATCH_RUNNER_HPP
@@ -2,13 +2,24 @@
 #define ERROR_HANDLER_HPP
 
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <sstream>
 
+#include "OutputWriter.hpp"
+#include "SourceLocation.hpp"
+
 /**
  * @class ErrorHandler
- * @brief Singleton error handler for minilang interpreter
+ * @brief Error handler for minilang interpreter
+ *
+ * getInstance() returns the handler installed on the calling thread by an
+ * ErrorHandler::Scope, or the process-wide handler when there is none. The
+ * process-wide handler ends the process on a runtime error, as the parser
+ * binary always has; other handlers throw RuntimeError instead, so that an
+ * embedding host (see ExecutionContext) can run scripts on several threads
+ * and keep going when one of them fails.
  */
 class ErrorHandler
 {
@@ -33,12 +44,46 @@ public:
     };
 
     /**
-     * @brief Get the singleton instance
-     * @return Reference to the global ErrorHandler instance
+     * @brief Thrown by reportRuntimeError() on handlers that do not exit
+     */
+    class RuntimeError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    /**
+     * @brief Makes a handler the calling thread's getInstance() until destroyed
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(ErrorHandler &handler) : previous(current) { current = &handler; }
+        ~Scope() { current = previous; }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        ErrorHandler *previous;
+    };
+
+    /**
+     * @brief A handler for one run; runtime errors throw RuntimeError
+     */
+    ErrorHandler() : hasErrors(false), exitOnRuntimeError(false) {}
+
+    /**
+     * @brief Get the current instance
+     * @return The calling thread's scoped handler, else the process-wide one
      */
     static ErrorHandler &getInstance()
     {
-        static ErrorHandler instance; // Guaranteed to be initialized only once
+        if (current != nullptr)
+        {
+            return *current;
+        }
+        static ErrorHandler instance(true); // Guaranteed to be initialized only once
         return instance;
     }
 
@@ -53,7 +98,20 @@ public:
     void reportLexicalError(const std::string &msg)
     {
         addError(LEXICAL_ERROR, msg);
-        std::cerr << "[ Lexical Error ] " << msg << std::endl;
+        if (echo)
+        {
+            std::cerr << "[ Lexical Error ] " << msg << std::endl;
+        }
+    }
+
+    /**
+     * @brief Reports a lexical error at a source location
+     * @param message The error message
+     * @param location SourceMap handle of the offending text; NO_LOCATION adds no prefix
+     */
+    void reportLexicalError(const std::string &message, SourceMap::Handle location)
+    {
+        reportLexicalError(located(message, location));
     }
 
     /**
@@ -63,7 +121,20 @@ public:
     void reportSyntaxError(const std::string &message)
     {
         addError(SYNTAX_ERROR, message);
-        std::cerr << "< Syntax Error > " << message << std::endl;
+        if (echo)
+        {
+            std::cerr << "< Syntax Error > " << message << std::endl;
+        }
+    }
+
+    /**
+     * @brief Reports a syntax error at a source location
+     * @param message The error message
+     * @param location SourceMap handle of the offending token; NO_LOCATION adds no prefix
+     */
+    void reportSyntaxError(const std::string &message, SourceMap::Handle location)
+    {
+        reportSyntaxError(located(message, location));
     }
 
     /**
@@ -73,7 +144,20 @@ public:
     void reportSemanticError(const std::string &message)
     {
         addError(SEMANTIC_ERROR, message);
-        std::cerr << "{ Semantic Error } " << message << std::endl;
+        if (echo)
+        {
+            std::cerr << "{ Semantic Error } " << message << std::endl;
+        }
+    }
+
+    /**
+     * @brief Reports a semantic error at a source location
+     * @param message The error message
+     * @param location SourceMap handle of the offending node; NO_LOCATION adds no prefix
+     */
+    void reportSemanticError(const std::string &message, SourceMap::Handle location)
+    {
+        reportSemanticError(located(message, location));
     }
 
     /**
@@ -83,11 +167,37 @@ public:
     void reportRuntimeError(const std::string &message)
     {
         addError(RUNTIME_ERROR, message);
+        if (!exitOnRuntimeError)
+        {
+            throw RuntimeError(message);
+        }
+        OutputWriter::flushAll(); // Program output comes before the error
         std::cerr << "RUNTIME ERROR";
         std::cerr << ": " << message << std::endl;
         exit(1);
     }
 
+    /**
+     * @brief Reports a runtime error at a source location
+     * @param message The error message
+     * @param location SourceMap handle of the offending node; NO_LOCATION adds no prefix
+     */
+    void reportRuntimeError(const std::string &message, SourceMap::Handle location)
+    {
+        reportRuntimeError(located(message, location));
+    }
+
+    /**
+     * @brief Whether lexical, syntax and semantic errors are also printed on stderr (the default)
+     *
+     * A handler that only records them leaves it to the caller to present
+     * getErrorReport(), for instance under the name of the failing script.
+     */
+    void setEcho(bool enabled)
+    {
+        echo = enabled;
+    }
+
     /**
      * @brief Checks if any errors have been reported
      * @return true if there are errors, false otherwise
@@ -162,11 +272,25 @@ public:
     }
 
 private:
-    // Private constructor for singleton pattern
-    ErrorHandler() : hasErrors(false) {}
+    explicit ErrorHandler(bool exitOnRuntimeError) : hasErrors(false), exitOnRuntimeError(exitOnRuntimeError) {}
+
+    static inline thread_local ErrorHandler *current = nullptr;
 
     std::vector<Error> errors;
     bool hasErrors;
+    bool exitOnRuntimeError;
+    bool echo = true;
+
+    // "file:line:column: message", or just the message when the location is unknown
+    static std::string located(const std::string &message, SourceMap::Handle location)
+    {
+        if (location == SourceMap::NO_LOCATION)
+        {
+            return message;
+        }
+        std::string where = SourceMap::getInstance().describe(location);
+        return where.empty() ? message : where + ": " + message;
+    }
 
     /**
      * @brief Adds an error to the error list
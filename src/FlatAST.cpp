@@ -0,0 +1,374 @@
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include "FlatAST.hpp"
+#include "SourceLocation.hpp"
+
+static_assert(NODE_FLOOR < 256, "NODE_TYPE must fit in the one-byte kind array");
+
+/**
+ * @brief Scratch state used while flattening; interns VALUE strings
+ *
+ * Keys view the source tree's strings, which stay alive for the duration
+ * of fromTree().
+ */
+struct FlatAST::BuildState
+{
+    std::unordered_map<std::string_view, std::uint32_t> internedIds;
+};
+
+FlatAST FlatAST::fromTree(const AST_NODE *root)
+{
+    FlatAST flat;
+
+    // Id 0 is always the empty string, the VALUE of most nodes
+    BuildState state;
+    state.internedIds.emplace(std::string_view(), 0);
+    flat.stringOffsets = {0, 0};
+
+    if (root != nullptr)
+    {
+        flat.appendNode(root, state);
+    }
+    return flat;
+}
+
+/**
+ * @brief Returns the pool id for a VALUE string, adding it on first sight
+ */
+std::uint32_t FlatAST::internValue(const std::string &value, BuildState &state)
+{
+    auto it = state.internedIds.find(value);
+    if (it != state.internedIds.end())
+    {
+        return it->second;
+    }
+
+    std::uint32_t id = static_cast<std::uint32_t>(stringOffsets.size() - 1);
+    stringPool += value;
+    stringOffsets.push_back(static_cast<std::uint32_t>(stringPool.size()));
+    state.internedIds.emplace(std::string_view(value), id);
+    return id;
+}
+
+/**
+ * @brief Appends a node and its subtrees in preorder
+ * @return Index assigned to the node
+ *
+ * The node's SUB_STATEMENTS range is reserved in subList before recursing,
+ * so each node's children stay contiguous even though their own subtrees
+ * are appended after them.
+ */
+FlatAST::NodeIndex FlatAST::appendNode(const AST_NODE *node, BuildState &state)
+{
+    NodeIndex index = static_cast<NodeIndex>(kinds.size());
+
+    kinds.push_back(static_cast<std::uint8_t>(node->TYPE));
+    valueIds.push_back(internValue(node->VALUE, state));
+    children.push_back(NO_NODE);
+    subStarts.push_back(static_cast<std::uint32_t>(subList.size()));
+    subCounts.push_back(static_cast<std::uint32_t>(node->SUB_STATEMENTS.size()));
+    locations.push_back(node->LOCATION);
+    subList.resize(subList.size() + node->SUB_STATEMENTS.size(), NO_NODE);
+
+    if (node->CHILD != nullptr)
+    {
+        NodeIndex childIndex = appendNode(node->CHILD, state);
+        children[index] = childIndex;
+    }
+
+    for (std::size_t i = 0; i < node->SUB_STATEMENTS.size(); i++)
+    {
+        if (node->SUB_STATEMENTS[i] != nullptr)
+        {
+            NodeIndex subIndex = appendNode(node->SUB_STATEMENTS[i], state);
+            subList[subStarts[index] + i] = subIndex;
+        }
+    }
+
+    return index;
+}
+
+std::string_view FlatAST::value(NodeIndex node) const
+{
+    std::uint32_t id = valueIds[node];
+    return std::string_view(stringPool.data() + stringOffsets[id], stringOffsets[id + 1] - stringOffsets[id]);
+}
+
+AST_NODE *FlatAST::toTree() const
+{
+    if (kinds.empty())
+    {
+        return nullptr;
+    }
+    return buildNode(root());
+}
+
+/**
+ * @brief Allocates a node and then its subtrees, in the same preorder as the indices
+ */
+AST_NODE *FlatAST::buildNode(NodeIndex node) const
+{
+    AST_NODE *built = new AST_NODE();
+    built->TYPE = kind(node);
+    built->VALUE = std::string(value(node));
+    built->LOCATION = locations[node];
+
+    if (children[node] != NO_NODE)
+    {
+        built->CHILD = buildNode(children[node]);
+    }
+
+    std::uint32_t count = subCounts[node];
+    built->SUB_STATEMENTS.reserve(count);
+    for (std::uint32_t i = 0; i < count; i++)
+    {
+        NodeIndex subIndex = sub(node, i);
+        built->SUB_STATEMENTS.push_back(subIndex != NO_NODE ? buildNode(subIndex) : nullptr);
+    }
+
+    return built;
+}
+
+namespace
+{
+    template <typename T>
+    void appendArray(std::string &out, const std::vector<T> &values)
+    {
+        out.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+    }
+
+    void appendU32(std::string &out, std::uint32_t value)
+    {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    /**
+     * @brief Bounds-checked cursor over a serialized image
+     */
+    struct ImageReader
+    {
+        std::string_view bytes;
+        std::size_t offset = 0;
+
+        bool readU32(std::uint32_t &value)
+        {
+            if (bytes.size() - offset < sizeof(value))
+            {
+                return false;
+            }
+            std::memcpy(&value, bytes.data() + offset, sizeof(value));
+            offset += sizeof(value);
+            return true;
+        }
+
+        template <typename T>
+        bool readArray(std::vector<T> &values, std::size_t count)
+        {
+            if ((bytes.size() - offset) / sizeof(T) < count)
+            {
+                return false;
+            }
+            values.resize(count);
+            std::memcpy(values.data(), bytes.data() + offset, count * sizeof(T));
+            offset += count * sizeof(T);
+            return true;
+        }
+    };
+}
+
+void FlatAST::serialize(std::string &out) const
+{
+    // Resolve the handles; file ids are renumbered into a table local to the image
+    std::vector<SourceLocation> resolved;
+    SourceMap::getInstance().resolve(locations, resolved);
+
+    std::unordered_map<std::uint32_t, std::uint32_t> localFiles;
+    std::string fileNames; // Each name followed by '\0'
+    std::vector<std::uint32_t> locationFiles, locationLines, locationColumns;
+    locationFiles.reserve(resolved.size());
+    locationLines.reserve(resolved.size());
+    locationColumns.reserve(resolved.size());
+    for (const SourceLocation &location : resolved)
+    {
+        auto it = localFiles.find(location.file);
+        if (it == localFiles.end())
+        {
+            it = localFiles.emplace(location.file, static_cast<std::uint32_t>(localFiles.size())).first;
+            fileNames += SourceMap::getInstance().getFileName(location.file);
+            fileNames += '\0';
+        }
+        locationFiles.push_back(it->second);
+        locationLines.push_back(location.line);
+        locationColumns.push_back(location.column);
+    }
+
+    appendU32(out, static_cast<std::uint32_t>(kinds.size()));
+    appendU32(out, static_cast<std::uint32_t>(subList.size()));
+    appendU32(out, static_cast<std::uint32_t>(stringOffsets.size()));
+    appendU32(out, static_cast<std::uint32_t>(stringPool.size()));
+    appendU32(out, static_cast<std::uint32_t>(fileNames.size()));
+
+    appendArray(out, kinds);
+    out.append((4 - kinds.size() % 4) % 4, '\0'); // keep the 32-bit arrays aligned
+    appendArray(out, valueIds);
+    appendArray(out, children);
+    appendArray(out, subStarts);
+    appendArray(out, subCounts);
+    appendArray(out, subList);
+    appendArray(out, stringOffsets);
+    appendArray(out, locationFiles);
+    appendArray(out, locationLines);
+    appendArray(out, locationColumns);
+    out.append(stringPool);
+    out.append(fileNames);
+}
+
+bool FlatAST::deserialize(std::string_view bytes, FlatAST &flat)
+{
+    ImageReader reader{bytes};
+    std::uint32_t nodeCount, subListSize, offsetCount, poolSize, fileNamesSize;
+    if (!reader.readU32(nodeCount) || !reader.readU32(subListSize) ||
+        !reader.readU32(offsetCount) || !reader.readU32(poolSize) || !reader.readU32(fileNamesSize))
+    {
+        return false;
+    }
+
+    FlatAST loaded;
+    std::vector<char> padding;
+    std::vector<char> pool;
+    std::vector<std::uint32_t> locationFiles, locationLines, locationColumns;
+    std::vector<char> fileNames;
+    if (!reader.readArray(loaded.kinds, nodeCount) ||
+        !reader.readArray(padding, (4 - nodeCount % 4) % 4) ||
+        !reader.readArray(loaded.valueIds, nodeCount) ||
+        !reader.readArray(loaded.children, nodeCount) ||
+        !reader.readArray(loaded.subStarts, nodeCount) ||
+        !reader.readArray(loaded.subCounts, nodeCount) ||
+        !reader.readArray(loaded.subList, subListSize) ||
+        !reader.readArray(loaded.stringOffsets, offsetCount) ||
+        !reader.readArray(locationFiles, nodeCount) ||
+        !reader.readArray(locationLines, nodeCount) ||
+        !reader.readArray(locationColumns, nodeCount) ||
+        !reader.readArray(pool, poolSize) ||
+        !reader.readArray(fileNames, fileNamesSize))
+    {
+        return false;
+    }
+    loaded.stringPool.assign(pool.begin(), pool.end());
+
+    // The string table must be monotonic and end inside the pool
+    if (offsetCount < 2 || loaded.stringOffsets[0] != 0)
+    {
+        return false;
+    }
+    for (std::uint32_t i = 1; i < offsetCount; i++)
+    {
+        if (loaded.stringOffsets[i] < loaded.stringOffsets[i - 1] || loaded.stringOffsets[i] > poolSize)
+        {
+            return false;
+        }
+    }
+
+    // Every link must point forward (preorder), which also rules out cycles,
+    // and no node may be linked twice: toTree() would build it twice and the
+    // tree would not be a tree
+    std::vector<bool> linked(nodeCount, false);
+    auto linkOnce = [&linked](NodeIndex index)
+    {
+        if (linked[index])
+        {
+            return false;
+        }
+        linked[index] = true;
+        return true;
+    };
+    for (NodeIndex node = 0; node < nodeCount; node++)
+    {
+        if (loaded.kinds[node] > NODE_FLOOR || loaded.valueIds[node] >= offsetCount - 1)
+        {
+            return false;
+        }
+        NodeIndex childIndex = loaded.children[node];
+        if (childIndex != NO_NODE && (childIndex <= node || childIndex >= nodeCount || !linkOnce(childIndex)))
+        {
+            return false;
+        }
+        if (loaded.subStarts[node] > subListSize || loaded.subCounts[node] > subListSize - loaded.subStarts[node])
+        {
+            return false;
+        }
+        for (std::uint32_t i = 0; i < loaded.subCounts[node]; i++)
+        {
+            NodeIndex subIndex = loaded.sub(node, i);
+            if (subIndex != NO_NODE && (subIndex <= node || subIndex >= nodeCount || !linkOnce(subIndex)))
+            {
+                return false;
+            }
+        }
+    }
+
+    // Map the image's file table onto this process's file ids, then intern the locations
+    std::vector<std::uint32_t> fileIds;
+    for (std::size_t start = 0; start < fileNames.size();)
+    {
+        auto end = std::find(fileNames.begin() + start, fileNames.end(), '\0');
+        if (end == fileNames.end())
+        {
+            return false;
+        }
+        fileIds.push_back(SourceMap::getInstance().internFile(std::string(fileNames.begin() + start, end)));
+        start = static_cast<std::size_t>(end - fileNames.begin()) + 1;
+    }
+
+    std::vector<SourceLocation> resolved(nodeCount);
+    for (NodeIndex node = 0; node < nodeCount; node++)
+    {
+        if (locationFiles[node] >= fileIds.size())
+        {
+            return false;
+        }
+        resolved[node] = SourceLocation{fileIds[locationFiles[node]], locationLines[node], locationColumns[node]};
+    }
+    SourceMap::getInstance().intern(resolved, loaded.locations);
+
+    flat = std::move(loaded);
+    return true;
+}
+
+std::size_t FlatAST::memoryBytes() const
+{
+    return kinds.capacity() * sizeof(std::uint8_t) +
+           valueIds.capacity() * sizeof(std::uint32_t) +
+           children.capacity() * sizeof(NodeIndex) +
+           subStarts.capacity() * sizeof(std::uint32_t) +
+           subCounts.capacity() * sizeof(std::uint32_t) +
+           subList.capacity() * sizeof(NodeIndex) +
+           locations.capacity() * sizeof(std::uint32_t) +
+           stringPool.capacity() +
+           stringOffsets.capacity() * sizeof(std::uint32_t);
+}
+
+std::size_t FlatAST::treeMemoryBytes(const AST_NODE *root)
+{
+    if (root == nullptr)
+    {
+        return 0;
+    }
+
+    std::size_t bytes = sizeof(AST_NODE) + root->SUB_STATEMENTS.capacity() * sizeof(AST_NODE *);
+
+    // Strings longer than the small-string buffer live in their own allocation
+    if (root->VALUE.capacity() > std::string().capacity())
+    {
+        bytes += root->VALUE.capacity() + 1;
+    }
+
+    bytes += treeMemoryBytes(root->CHILD);
+    for (const AST_NODE *sub : root->SUB_STATEMENTS)
+    {
+        bytes += treeMemoryBytes(sub);
+    }
+    return bytes;
+}
@@ -0,0 +1,103 @@
+#ifndef FLAT_AST_HPP
+#define FLAT_AST_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parser.hpp"
+
+/**
+ * @brief Flattened, index-based form of an AST
+ *
+ * Stores the tree as parallel arrays (struct-of-arrays) addressed by 32-bit
+ * node indices instead of heap nodes linked by pointers. Nodes are numbered
+ * in preorder (node, then its CHILD subtree, then each SUB_STATEMENT
+ * subtree), so a walk over a subtree reads a contiguous index range.
+ *
+ * - kinds:      NODE_TYPE of each node, one byte per node
+ * - valueIds:   index of the node's VALUE in the interned string pool
+ * - children:   index of the CHILD node or NO_NODE
+ * - subStarts/subCounts: range of the node's SUB_STATEMENTS in subList
+ * - locations:  SourceMap handle of the node (AST_NODE::LOCATION)
+ *
+ * Identical VALUE strings (identifiers, operators, literals) are stored
+ * once. toTree() materializes an ordinary AST_NODE tree, allocated in
+ * preorder, for code that walks pointers.
+ */
+class FlatAST
+{
+public:
+    using NodeIndex = std::uint32_t;
+    static constexpr NodeIndex NO_NODE = 0xFFFFFFFFu;
+
+    /**
+     * @brief Flattens a pointer tree
+     * @param root Root of the tree to flatten (may be nullptr)
+     * @return The flattened tree; the source tree is left untouched
+     */
+    static FlatAST fromTree(const AST_NODE *root);
+
+    /**
+     * @brief Rebuilds a pointer tree from the flat form
+     * @return Newly allocated root (free with the usual recursive delete), or nullptr if empty
+     */
+    AST_NODE *toTree() const;
+
+    NodeIndex root() const { return kinds.empty() ? NO_NODE : 0; }
+    std::size_t nodeCount() const { return kinds.size(); }
+
+    NODE_TYPE kind(NodeIndex node) const { return static_cast<NODE_TYPE>(kinds[node]); }
+    std::string_view value(NodeIndex node) const;
+    NodeIndex child(NodeIndex node) const { return children[node]; }
+    std::uint32_t subCount(NodeIndex node) const { return subCounts[node]; }
+    NodeIndex sub(NodeIndex node, std::uint32_t i) const { return subList[subStarts[node] + i]; }
+    std::uint32_t location(NodeIndex node) const { return locations[node]; }
+
+    /**
+     * @brief Appends the binary image of the arrays to out
+     *
+     * The image is the arrays back to back in host byte order, preceded by
+     * their lengths; it is meant for caches read back on the same machine.
+     * Locations are written resolved (file name, line, column), since
+     * SourceMap handles only mean something inside one process.
+     */
+    void serialize(std::string &out) const;
+
+    /**
+     * @brief Rebuilds a FlatAST from an image produced by serialize()
+     * @param bytes The image (e.g. a view into a memory-mapped cache file)
+     * @param flat Receives the tree
+     * @return false if the image is truncated or inconsistent, including
+     *         links that point backwards or name a node a second time
+     */
+    static bool deserialize(std::string_view bytes, FlatAST &flat);
+
+    // Bytes held by the flat arrays and the string pool
+    std::size_t memoryBytes() const;
+
+    // Approximate heap footprint of a pointer tree, for comparison with memoryBytes()
+    static std::size_t treeMemoryBytes(const AST_NODE *root);
+
+private:
+    struct BuildState;
+
+    NodeIndex appendNode(const AST_NODE *node, BuildState &state);
+    std::uint32_t internValue(const std::string &value, BuildState &state);
+    AST_NODE *buildNode(NodeIndex node) const;
+
+    std::vector<std::uint8_t> kinds;
+    std::vector<std::uint32_t> valueIds;
+    std::vector<NodeIndex> children;
+    std::vector<std::uint32_t> subStarts;
+    std::vector<std::uint32_t> subCounts;
+    std::vector<NodeIndex> subList;
+    std::vector<std::uint32_t> locations;
+
+    std::string stringPool;                   // All distinct VALUE strings back to back
+    std::vector<std::uint32_t> stringOffsets; // stringOffsets[id]..stringOffsets[id + 1] in stringPool
+};
+
+#endif // FLAT_AST_HPP
@@ -0,0 +1,58 @@
+#include <utility>
+
+#include "HeaderCache.hpp"
+
+std::shared_ptr<const HeaderCache::Unit> HeaderCache::find(const std::string &canonicalPath)
+{
+    std::shared_ptr<const Unit> unit;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = units.find(canonicalPath);
+        if (it == units.end())
+        {
+            return nullptr;
+        }
+        unit = it->second;
+    }
+
+    // Stat outside the lock; a stale unit is simply parsed again
+    for (std::size_t i = 0; i < unit->files.size(); i++)
+    {
+        SourceStamp stamp;
+        if (!SourceStamp::read(unit->files[i], stamp) || !stamp.sameFile(unit->stamps[i]))
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = units.find(canonicalPath);
+            if (it != units.end() && it->second == unit)
+            {
+                units.erase(it);
+            }
+            return nullptr;
+        }
+    }
+    return unit;
+}
+
+std::shared_ptr<const HeaderCache::Unit> HeaderCache::insert(const std::string &canonicalPath, Unit unit)
+{
+    bool stamped = true;
+    unit.stamps.resize(unit.files.size());
+    for (std::size_t i = 0; i < unit.files.size(); i++)
+    {
+        stamped = stamped && SourceStamp::read(unit.files[i], unit.stamps[i]);
+    }
+
+    auto shared = std::make_shared<const Unit>(std::move(unit));
+    if (stamped)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        units[canonicalPath] = shared;
+    }
+    return shared;
+}
+
+void HeaderCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    units.clear();
+}
@@ -0,0 +1,69 @@
+#ifndef HEADER_CACHE_HPP
+#define HEADER_CACHE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FlatAST.hpp"
+#include "SourceStamp.hpp"
+
+/**
+ * @brief Process-wide cache of parsed 'source:' headers
+ *
+ * Headers are keyed by canonical path, so the same file reached through
+ * different relative spellings, nested includes or several scripts in one
+ * process is lexed and parsed once. Each unit keeps the modification time
+ * and size of every file it was built from and is dropped as soon as one of
+ * them changes. Units are immutable once inserted and handed out as shared
+ * pointers, so a Parser can keep using one while another replaces it.
+ */
+class HeaderCache
+{
+public:
+    /**
+     * @brief A header parsed on its own, independent of where it was included
+     */
+    struct Unit
+    {
+        FlatAST ast;                          // The header's parse tree
+        bool includeOnce = false;             // Header starts with '@once'
+        std::vector<std::string> files;       // Canonical path of the header, then its nested headers
+        std::vector<std::string> onceHeaders; // '@once' headers attached inside this unit (itself included)
+
+        std::vector<SourceStamp> stamps; // Parallel to files
+    };
+
+    static HeaderCache &getInstance()
+    {
+        static HeaderCache instance;
+        return instance;
+    }
+
+    /**
+     * @brief Looks up a header
+     * @param canonicalPath Canonical path of the header file
+     * @return The unit, or nullptr if absent or if any of its files changed on disk
+     */
+    std::shared_ptr<const Unit> find(const std::string &canonicalPath);
+
+    /**
+     * @brief Records a freshly parsed header, stamping its files
+     * @return The stored unit (unstamped files make it uncachable; it is returned but not kept)
+     */
+    std::shared_ptr<const Unit> insert(const std::string &canonicalPath, Unit unit);
+
+    // Drops every unit
+    void clear();
+
+private:
+    HeaderCache() = default;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<const Unit>> units;
+};
+
+#endif // HEADER_CACHE_HPP
@@ -0,0 +1,85 @@
+#ifndef LOG_HPP
+#define LOG_HPP
+
+#include <iostream>
+#include <string>
+
+/**
+ * @brief Severity of a diagnostic message, most severe first
+ */
+enum class LogLevel
+{
+    ERROR,
+    WARN,
+    INFO,
+    DEBUG,
+    TRACE
+};
+
+/**
+ * @class Log
+ * @brief Runtime log level for the interpreter's diagnostics
+ *
+ * Diagnostics are written to std::cerr through the MINILANG_LOG_* macros
+ * below, so they never mix with program output. A message is only
+ * formatted when its level is enabled; the operands of a disabled message
+ * are not evaluated.
+ *
+ * Building with -DMINILANG_PRODUCTION removes the DEBUG and TRACE macros
+ * entirely, including their level checks.
+ */
+class Log
+{
+public:
+    static LogLevel getLevel() { return level; }
+    static void setLevel(LogLevel newLevel) { level = newLevel; }
+
+    static bool isEnabled(LogLevel messageLevel) { return messageLevel <= level; }
+
+    /**
+     * @brief Parses a level name (error, warn, info, debug, trace)
+     * @return false if the name is not a level
+     */
+    static bool parseLevel(const std::string &name, LogLevel &result)
+    {
+        if (name == "error")
+            result = LogLevel::ERROR;
+        else if (name == "warn")
+            result = LogLevel::WARN;
+        else if (name == "info")
+            result = LogLevel::INFO;
+        else if (name == "debug")
+            result = LogLevel::DEBUG;
+        else if (name == "trace")
+            result = LogLevel::TRACE;
+        else
+            return false;
+        return true;
+    }
+
+private:
+    static inline LogLevel level = LogLevel::WARN;
+};
+
+#define MINILANG_LOG(messageLevel, prefix, message)        \
+    do                                                     \
+    {                                                      \
+        if (Log::isEnabled(messageLevel))                  \
+        {                                                  \
+            std::cerr << prefix << message << std::endl;   \
+        }                                                  \
+    } while (0)
+
+#define MINILANG_LOG_ERROR(message) MINILANG_LOG(LogLevel::ERROR, "ERROR: ", message)
+#define MINILANG_LOG_WARN(message) MINILANG_LOG(LogLevel::WARN, "WARNING: ", message)
+#define MINILANG_LOG_INFO(message) MINILANG_LOG(LogLevel::INFO, "", message)
+
+#ifdef MINILANG_PRODUCTION
+#define MINILANG_LOG_DEBUG(message) ((void)0)
+#define MINILANG_LOG_TRACE(message) ((void)0)
+#else
+#define MINILANG_LOG_DEBUG(message) MINILANG_LOG(LogLevel::DEBUG, "DEBUG: ", message)
+#define MINILANG_LOG_TRACE(message) MINILANG_LOG(LogLevel::TRACE, "TRACE: ", message)
+#endif
+
+#endif // LOG_HPP
@@ -0,0 +1,137 @@
+#include <cstdio>
+#include <ostream>
+
+#include "MemoryStats.hpp"
+
+namespace
+{
+    std::uint64_t clampToZero(std::int64_t value)
+    {
+        return value > 0 ? static_cast<std::uint64_t>(value) : 0;
+    }
+}
+
+MemoryStats::Counters MemoryStats::categories[MemoryStats::CATEGORY_COUNT];
+MemoryStats::Counters MemoryStats::total;
+
+void MemoryStats::raisePeak(std::atomic<std::int64_t> &peak, std::int64_t value)
+{
+    std::int64_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+void MemoryStats::record(MemoryCategory category, std::int64_t delta)
+{
+    Counters &counters = categories[static_cast<std::size_t>(category)];
+    std::int64_t live = counters.live.fetch_add(delta, std::memory_order_relaxed) + delta;
+    std::int64_t totalLive = total.live.fetch_add(delta, std::memory_order_relaxed) + delta;
+
+    if (delta > 0)
+    {
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        total.allocations.fetch_add(1, std::memory_order_relaxed);
+        raisePeak(counters.peak, live);
+        raisePeak(total.peak, totalLive);
+    }
+
+    std::uint64_t limit = budget.load(std::memory_order_relaxed);
+    if (limit == 0)
+    {
+        return;
+    }
+
+    // Edge-triggered: one call per crossing, from whichever thread crossed.
+    // A release never reports going over: it may run in a destructor, where
+    // a throwing handler would terminate the process. The next allocation does.
+    bool over = clampToZero(totalLive) > limit;
+    if (over && delta < 0)
+    {
+        return;
+    }
+    if (over != overBudget.load(std::memory_order_relaxed) && overBudget.exchange(over) != over && over)
+    {
+        if (BudgetHandler handler = budgetHandler.load())
+        {
+            handler(clampToZero(totalLive), limit);
+        }
+    }
+}
+
+MemoryStats::Usage MemoryStats::getUsage(MemoryCategory category)
+{
+    const Counters &counters = categories[static_cast<std::size_t>(category)];
+    Usage usage;
+    usage.liveBytes = clampToZero(counters.live.load(std::memory_order_relaxed));
+    usage.peakBytes = clampToZero(counters.peak.load(std::memory_order_relaxed));
+    usage.allocations = counters.allocations.load(std::memory_order_relaxed);
+    return usage;
+}
+
+MemoryStats::Usage MemoryStats::getTotal()
+{
+    Usage usage;
+    usage.liveBytes = clampToZero(total.live.load(std::memory_order_relaxed));
+    usage.peakBytes = clampToZero(total.peak.load(std::memory_order_relaxed));
+    usage.allocations = total.allocations.load(std::memory_order_relaxed);
+    return usage;
+}
+
+void MemoryStats::setBudget(std::uint64_t bytes, BudgetHandler handler)
+{
+    budgetHandler.store(handler);
+    overBudget.store(false);
+    budget.store(bytes);
+}
+
+bool MemoryStats::isOverBudget()
+{
+    std::uint64_t limit = budget.load(std::memory_order_relaxed);
+    return limit != 0 && getTotal().liveBytes > limit;
+}
+
+const char *MemoryStats::getCategoryName(MemoryCategory category)
+{
+    switch (category)
+    {
+    case MemoryCategory::STRINGS:
+        return "strings";
+    case MemoryCategory::ARRAYS:
+        return "arrays";
+    case MemoryCategory::AST_NODES:
+        return "AST nodes";
+    case MemoryCategory::TOKENS:
+        return "tokens";
+    default:
+        return "unknown";
+    }
+}
+
+void MemoryStats::report(std::ostream &out)
+{
+    char row[160];
+    out << "\n===== MEMORY =====\n\n";
+    std::snprintf(row, sizeof(row), "%-12s %14s %14s %14s\n", "category", "live bytes", "peak bytes", "allocations");
+    out << row;
+
+    for (std::size_t i = 0; i < CATEGORY_COUNT; i++)
+    {
+        MemoryCategory category = static_cast<MemoryCategory>(i);
+        Usage usage = getUsage(category);
+        std::snprintf(row, sizeof(row), "%-12s %14llu %14llu %14llu\n", getCategoryName(category),
+                      static_cast<unsigned long long>(usage.liveBytes),
+                      static_cast<unsigned long long>(usage.peakBytes),
+                      static_cast<unsigned long long>(usage.allocations));
+        out << row;
+    }
+
+    // The total's peak is the high-water mark of the sum, not the sum of the peaks
+    Usage usage = getTotal();
+    std::snprintf(row, sizeof(row), "%-12s %14llu %14llu %14llu\n", "total",
+                  static_cast<unsigned long long>(usage.liveBytes),
+                  static_cast<unsigned long long>(usage.peakBytes),
+                  static_cast<unsigned long long>(usage.allocations));
+    out << row;
+    out.flush();
+}
@@ -0,0 +1,120 @@
+#ifndef MEMORY_STATS_HPP
+#define MEMORY_STATS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+/**
+ * @brief What a tracked allocation holds
+ */
+enum class MemoryCategory
+{
+    STRINGS,   // Heap buffers of string Values (short strings live inside the Value)
+    ARRAYS,    // DynamicArray element storage
+    AST_NODES, // AST_NODE objects
+    TOKENS,    // Token objects
+    COUNT
+};
+
+/**
+ * @class MemoryStats
+ * @brief Process-wide live and peak byte counts per MemoryCategory
+ *
+ * Accounting is off until enable() is called, and then costs a few
+ * relaxed atomic operations per tracked allocation; while off, each hook
+ * is a single test of a flag. Enable it before any script is lexed, since
+ * memory allocated earlier would otherwise be released without having
+ * been counted.
+ *
+ * Sizes are what the containers ask for (capacity, not length), without
+ * the allocator's own overhead. Node and token counts cover the objects
+ * themselves; their text is mostly short enough to live inside them.
+ *
+ * An embedding host can set a budget on the total: the handler runs on
+ * the first allocation that finds the live total over it, and again on
+ * the next crossing once the total has dropped back under. It is only
+ * called from an allocation, never from a release, so it may throw to
+ * abandon the script.
+ */
+class MemoryStats
+{
+public:
+    struct Usage
+    {
+        std::uint64_t liveBytes = 0;
+        std::uint64_t peakBytes = 0;
+        std::uint64_t allocations = 0; // Tracked allocations so far
+    };
+
+    using BudgetHandler = void (*)(std::uint64_t liveBytes, std::uint64_t budgetBytes);
+
+    static void enable() { enabled.store(true, std::memory_order_relaxed); }
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    static void allocate(MemoryCategory category, std::size_t bytes)
+    {
+        if (isEnabled() && bytes > 0)
+        {
+            record(category, static_cast<std::int64_t>(bytes));
+        }
+    }
+
+    static void release(MemoryCategory category, std::size_t bytes)
+    {
+        if (isEnabled() && bytes > 0)
+        {
+            record(category, -static_cast<std::int64_t>(bytes));
+        }
+    }
+
+    /**
+     * @brief Heap bytes owned by a string (0 while it fits its inline buffer)
+     */
+    static std::size_t payloadBytes(const std::string &text)
+    {
+        return text.capacity() > SMALL_STRING_CAPACITY ? text.capacity() + 1 : 0;
+    }
+
+    static Usage getUsage(MemoryCategory category);
+    static Usage getTotal();
+
+    /**
+     * @brief Sets a limit on the live total; 0 removes it
+     */
+    static void setBudget(std::uint64_t bytes, BudgetHandler handler);
+    static bool isOverBudget();
+
+    /**
+     * @brief Writes a table of live and peak bytes per category
+     */
+    static void report(std::ostream &out);
+
+    static const char *getCategoryName(MemoryCategory category);
+
+private:
+    static constexpr std::size_t CATEGORY_COUNT = static_cast<std::size_t>(MemoryCategory::COUNT);
+    static inline const std::size_t SMALL_STRING_CAPACITY = std::string().capacity();
+
+    struct Counters
+    {
+        std::atomic<std::int64_t> live{0};
+        std::atomic<std::int64_t> peak{0};
+        std::atomic<std::uint64_t> allocations{0};
+    };
+
+    static void record(MemoryCategory category, std::int64_t delta);
+    static void raisePeak(std::atomic<std::int64_t> &peak, std::int64_t value);
+
+    static inline std::atomic<bool> enabled{false};
+    static Counters categories[CATEGORY_COUNT];
+    static Counters total;
+
+    static inline std::atomic<std::uint64_t> budget{0};
+    static inline std::atomic<BudgetHandler> budgetHandler{nullptr};
+    static inline std::atomic<bool> overBudget{false};
+};
+
+#endif // MEMORY_STATS_HPP
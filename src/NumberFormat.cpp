@@ -0,0 +1,62 @@
+#include <charconv>
+#include <limits>
+
+#include "NumberFormat.hpp"
+
+namespace
+{
+    // Longest outputs: "-2147483648"; "%g" is at most sign, six digits,
+    // point and a four-character exponent; fixed needs every integer digit
+    // of DBL_MAX plus the six decimals.
+    constexpr std::size_t MAX_INT_CHARS = std::numeric_limits<int>::digits10 + 2;
+    constexpr std::size_t MAX_GENERAL_CHARS = 16;
+    constexpr std::size_t MAX_FIXED_CHARS = std::numeric_limits<double>::max_exponent10 + 10;
+
+    /**
+     * @brief Grows out by maxChars, lets format write into the new space, and trims the rest
+     */
+    template <typename Format>
+    void appendWith(std::string &out, std::size_t maxChars, Format format)
+    {
+        const std::size_t start = out.size();
+        out.resize(start + maxChars);
+        char *first = &out[start];
+        std::to_chars_result result = format(first, first + maxChars);
+        out.resize(static_cast<std::size_t>(result.ptr - out.data()));
+    }
+}
+
+namespace numberformat
+{
+    void appendInt(std::string &out, int value)
+    {
+        appendWith(out, MAX_INT_CHARS, [value](char *first, char *last)
+                   { return std::to_chars(first, last, value); });
+    }
+
+    void appendDouble(std::string &out, double value)
+    {
+        appendWith(out, MAX_GENERAL_CHARS, [value](char *first, char *last)
+                   { return std::to_chars(first, last, value, std::chars_format::general, 6); });
+    }
+
+    void appendFixed(std::string &out, double value)
+    {
+        const std::size_t start = out.size();
+        appendWith(out, MAX_FIXED_CHARS, [value](char *first, char *last)
+                   { return std::to_chars(first, last, value, std::chars_format::fixed, 6); });
+
+        // "2.500000" -> "2.5", "3.000000" -> "3"; "nan" and "inf" have no point
+        std::size_t point = out.find('.', start);
+        if (point == std::string::npos)
+        {
+            return;
+        }
+        std::size_t end = out.find_last_not_of('0');
+        if (end == point)
+        {
+            end--;
+        }
+        out.erase(end + 1);
+    }
+}
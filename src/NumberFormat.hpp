@@ -0,0 +1,26 @@
+#ifndef NUMBER_FORMAT_HPP
+#define NUMBER_FORMAT_HPP
+
+#include <string>
+
+/**
+ * @brief Locale-independent number formatting on top of std::to_chars
+ *
+ * Each function appends to a string in place, formatting straight into
+ * its spare capacity, so printing a number costs no stream and no
+ * temporary string. The output is byte-for-byte what the iostream code it
+ * replaces produced:
+ *
+ *  - appendInt:     std::ostream << int
+ *  - appendDouble:  std::ostream << double (printf "%g", 6 significant digits)
+ *  - appendFixed:   Value::toString's double form: six decimals with the
+ *                   trailing zeros (and a bare point) removed
+ */
+namespace numberformat
+{
+    void appendInt(std::string &out, int value);
+    void appendDouble(std::string &out, double value);
+    void appendFixed(std::string &out, double value);
+}
+
+#endif // NUMBER_FORMAT_HPP
@@ -0,0 +1,148 @@
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <system_error>
+
+#include "OutputSink.hpp"
+
+namespace fs = std::filesystem;
+
+void StdoutSink::write(std::string_view text)
+{
+    std::fwrite(text.data(), 1, text.size(), stdout);
+}
+
+void StdoutSink::flush()
+{
+    std::fflush(stdout);
+}
+
+FileSink::~FileSink()
+{
+    std::fclose(file);
+}
+
+std::shared_ptr<FileSink> FileSink::create(const std::string &path)
+{
+    std::FILE *file = std::fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        return nullptr;
+    }
+    return std::shared_ptr<FileSink>(new FileSink(file, path));
+}
+
+void FileSink::write(std::string_view text)
+{
+    std::fwrite(text.data(), 1, text.size(), file);
+}
+
+void FileSink::flush()
+{
+    std::fflush(file);
+}
+
+void MemorySink::write(std::string_view text)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer.append(text);
+}
+
+std::string MemorySink::contents() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return buffer;
+}
+
+void MemorySink::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer.clear();
+}
+
+namespace
+{
+    /**
+     * @brief Path of a new timestamped log file, creating its directory
+     */
+    std::string timestampedLogPath()
+    {
+        const fs::path directory = "../output";
+        std::error_code error;
+        fs::create_directories(directory, error);
+
+        auto now = std::chrono::system_clock::now();
+        std::time_t timeNow = std::chrono::system_clock::to_time_t(now);
+
+        std::stringstream ss;
+        ss << "output_" << std::put_time(std::localtime(&timeNow), "%Y-%m-%d_%H-%M-%S") << ".txt";
+        return (directory / ss.str()).string();
+    }
+}
+
+bool OutputConfig::parse(const std::string &spec, OutputConfig &config, std::string &error)
+{
+    OutputConfig result;
+    bool discard = false;
+    std::string logItem; // The file item; its file is created once the whole spec is valid
+
+    std::stringstream items(spec);
+    std::string item;
+    while (std::getline(items, item, ','))
+    {
+        if (item == "stdout")
+        {
+            result.console = std::make_shared<StdoutSink>();
+        }
+        else if (item == "null")
+        {
+            discard = true;
+        }
+        else if (item == "file" || item.rfind("file:", 0) == 0)
+        {
+            if (!logItem.empty())
+            {
+                error = "Only one file output sink is allowed, got another: '" + item + "'";
+                return false;
+            }
+            if (item == "file:")
+            {
+                error = "Missing path in output sink '" + item + "'";
+                return false;
+            }
+            logItem = item;
+        }
+        else
+        {
+            error = "Unknown output sink '" + item + "'";
+            return false;
+        }
+    }
+
+    if (discard && (result.console || !logItem.empty()))
+    {
+        error = "Output sink 'null' cannot be combined with other sinks";
+        return false;
+    }
+    if (!discard && !result.console && logItem.empty())
+    {
+        error = "No output sink given";
+        return false;
+    }
+
+    if (!logItem.empty())
+    {
+        std::string path = (logItem == "file") ? timestampedLogPath() : logItem.substr(5);
+        result.log = FileSink::create(path);
+        if (!result.log)
+        {
+            error = "Failed to create output file: " + path;
+            return false;
+        }
+    }
+
+    config = std::move(result);
+    return true;
+}
@@ -0,0 +1,110 @@
+#ifndef OUTPUT_SINK_HPP
+#define OUTPUT_SINK_HPP
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/**
+ * @brief Destination for program output
+ *
+ * Sinks are written by a single OutputWriter thread, so implementations
+ * need no locking of their own unless, like MemorySink, they are read
+ * from elsewhere while the program runs.
+ */
+class OutputSink
+{
+public:
+    virtual ~OutputSink() = default;
+
+    virtual void write(std::string_view text) = 0;
+    virtual void flush() {}
+};
+
+/**
+ * @brief Writes to the process's standard output
+ */
+class StdoutSink : public OutputSink
+{
+public:
+    void write(std::string_view text) override;
+    void flush() override;
+};
+
+/**
+ * @brief Writes to a file, which it owns
+ */
+class FileSink : public OutputSink
+{
+public:
+    ~FileSink() override;
+
+    /**
+     * @brief Creates (or truncates) a file to write to
+     * @return nullptr if the file could not be created
+     */
+    static std::shared_ptr<FileSink> create(const std::string &path);
+
+    void write(std::string_view text) override;
+    void flush() override;
+
+    const std::string &getPath() const { return path; }
+
+private:
+    FileSink(std::FILE *file, std::string path) : file(file), path(std::move(path)) {}
+
+    std::FILE *file;
+    std::string path;
+};
+
+/**
+ * @brief Collects output in memory, for programs run from an embedding application
+ */
+class MemorySink : public OutputSink
+{
+public:
+    void write(std::string_view text) override;
+
+    // Output delivered so far; call OutputWriter::flush() first for all of it
+    std::string contents() const;
+    void clear();
+
+private:
+    mutable std::mutex mutex;
+    std::string buffer;
+};
+
+/**
+ * @brief Where an interpreter's output goes
+ *
+ * Output has two destinations. The console receives what out_to_console
+ * prints. The log receives the same text plus the log-only line breaks
+ * of the newline symbol; it is the transcript the tests compare. Either
+ * may be null, in which case that output is dropped without being
+ * buffered.
+ */
+struct OutputConfig
+{
+    std::shared_ptr<OutputSink> console;
+    std::shared_ptr<OutputSink> log;
+
+    /**
+     * @brief Builds a configuration from a comma-separated list of sinks
+     * @param spec Items from: stdout, file (a timestamped file in
+     *             ../output), file:PATH, null
+     * @param error Receives a message when false is returned
+     * @return false if the spec is invalid or a file could not be created
+     *
+     * stdout selects the console; file selects the log, and may appear
+     * only once. "null" alone discards all output.
+     */
+    static bool parse(const std::string &spec, OutputConfig &config, std::string &error);
+
+    // The long-standing behaviour: stdout plus a timestamped log file
+    static constexpr const char *DEFAULT_SPEC = "stdout,file";
+};
+
+#endif // OUTPUT_SINK_HPP
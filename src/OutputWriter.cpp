@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+#include "NumberFormat.hpp"
+#include "OutputWriter.hpp"
+
+namespace
+{
+    // Writers that are open, so they can be drained on exit
+    std::mutex registryMutex;
+    std::vector<OutputWriter *> openWriters;
+
+    std::once_flag exitHookRegistered;
+
+    void closeWritersAtExit()
+    {
+        std::vector<OutputWriter *> writers;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            writers = openWriters;
+        }
+        for (OutputWriter *writer : writers)
+        {
+            writer->close();
+        }
+    }
+}
+
+OutputWriter::~OutputWriter()
+{
+    close();
+}
+
+void OutputWriter::open(const OutputConfig &config)
+{
+    close();
+
+    console = config.console;
+    log = config.log;
+    if (!console && !log)
+    {
+        return;
+    }
+
+    stopping = false;
+    running = true;
+    worker = std::thread(&OutputWriter::run, this);
+
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        openWriters.push_back(this);
+    }
+    std::call_once(exitHookRegistered, []
+                   { std::atexit(closeWritersAtExit); });
+}
+
+void OutputWriter::write(std::string_view text)
+{
+    append(text, text);
+}
+
+void OutputWriter::write(int value)
+{
+    appendFormatted([value](std::string &out)
+                    { numberformat::appendInt(out, value); });
+}
+
+void OutputWriter::write(double value)
+{
+    appendFormatted([value](std::string &out)
+                    { numberformat::appendDouble(out, value); });
+}
+
+void OutputWriter::writeToLog(std::string_view text)
+{
+    append(std::string_view(), text);
+}
+
+/**
+ * @brief Queues text for the writer thread, waiting if too much is pending
+ */
+void OutputWriter::append(std::string_view consoleText, std::string_view logText)
+{
+    if (!running)
+    {
+        return;
+    }
+    if (!console)
+    {
+        consoleText = std::string_view();
+    }
+    if (!log)
+    {
+        logText = std::string_view();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    consolePending.append(consoleText);
+    logPending.append(logText);
+    queued(lock, consoleText.size() + logText.size());
+}
+
+/**
+ * @brief Formats a number straight into the pending buffers
+ *
+ * The text is formatted once, at the end of the console buffer, and
+ * copied from there to the log buffer.
+ */
+template <typename Format>
+void OutputWriter::appendFormatted(Format format)
+{
+    if (!running)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    std::size_t bytes;
+    if (console)
+    {
+        const std::size_t start = consolePending.size();
+        format(consolePending);
+        bytes = consolePending.size() - start;
+        if (log)
+        {
+            logPending.append(consolePending, start, bytes);
+            bytes *= 2;
+        }
+    }
+    else
+    {
+        const std::size_t start = logPending.size();
+        format(logPending);
+        bytes = logPending.size() - start;
+    }
+    queued(lock, bytes);
+}
+
+/**
+ * @brief Accounts for newly queued bytes, waking the writer or waiting for it as needed
+ */
+void OutputWriter::queued(std::unique_lock<std::mutex> &lock, std::size_t bytes)
+{
+    bytesQueued += bytes;
+
+    const std::size_t pending = consolePending.size() + logPending.size();
+    if (pending >= FLUSH_BYTES)
+    {
+        wake.notify_one();
+    }
+    if (pending >= MAX_PENDING_BYTES)
+    {
+        drained.wait(lock, [this]
+                     { return consolePending.size() + logPending.size() < MAX_PENDING_BYTES; });
+    }
+}
+
+void OutputWriter::flush()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    unsigned long long target = bytesQueued;
+    flushRequested = true;
+    wake.notify_one();
+    drained.wait(lock, [this, target]
+                 { return bytesWritten >= target; });
+}
+
+void OutputWriter::close()
+{
+    // Only one caller stops the thread, even if the exit hook and the owner close at once
+    if (!running.exchange(false))
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+
+    console.reset();
+    log.reset();
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    openWriters.erase(std::remove(openWriters.begin(), openWriters.end(), this), openWriters.end());
+}
+
+void OutputWriter::flushAll()
+{
+    // Flushed outside the lock, so a writer closing meanwhile is not held up
+    std::vector<OutputWriter *> writers;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        writers = openWriters;
+    }
+    for (OutputWriter *writer : writers)
+    {
+        writer->flush();
+    }
+}
+
+/**
+ * @brief Writer thread: delivers pending output in batches
+ *
+ * Sleeps until output is pending, then gives the producer up to
+ * FLUSH_INTERVAL_MS to fill a FLUSH_BYTES batch unless a flush or shutdown
+ * is requested. Batches are written outside the lock; the batch strings
+ * are swapped with the pending ones so their capacity is reused.
+ */
+void OutputWriter::run()
+{
+    std::string consoleBatch;
+    std::string logBatch;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this]
+                  { return stopping || flushRequested || !consolePending.empty() || !logPending.empty(); });
+        wake.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS), [this]
+                      { return stopping || flushRequested || consolePending.size() + logPending.size() >= FLUSH_BYTES; });
+
+        consoleBatch.clear();
+        logBatch.clear();
+        consoleBatch.swap(consolePending);
+        logBatch.swap(logPending);
+        flushRequested = false;
+        bool stop = stopping;
+
+        lock.unlock();
+        if (!consoleBatch.empty())
+        {
+            console->write(consoleBatch);
+            console->flush();
+        }
+        if (!logBatch.empty())
+        {
+            log->write(logBatch);
+            log->flush();
+        }
+        lock.lock();
+
+        bytesWritten += consoleBatch.size() + logBatch.size();
+        drained.notify_all();
+
+        if (stop && consolePending.empty() && logPending.empty())
+        {
+            break;
+        }
+    }
+}
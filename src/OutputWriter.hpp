@@ -0,0 +1,95 @@
+#ifndef OUTPUT_WRITER_HPP
+#define OUTPUT_WRITER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "OutputSink.hpp"
+
+/**
+ * @brief Buffered, asynchronous destination for program output
+ *
+ * Output is appended to userspace buffers, one for the console sink and
+ * one for the log sink, and written by a background thread. A batch is handed to
+ * the thread once the buffers reach FLUSH_BYTES; otherwise the thread picks
+ * up whatever is pending every FLUSH_INTERVAL. Each destination receives its
+ * bytes in the order they were written.
+ *
+ * flush() blocks until everything written so far has reached the sinks; it is used before prompting for input. Open writers are
+ * also flushed when the process exits, including through exit() on a
+ * runtime error.
+ */
+class OutputWriter
+{
+public:
+    static constexpr std::size_t FLUSH_BYTES = 64 * 1024;
+    static constexpr std::size_t MAX_PENDING_BYTES = 8 * 1024 * 1024; // Writers block beyond this
+    static constexpr int FLUSH_INTERVAL_MS = 50;
+
+    OutputWriter() = default;
+    ~OutputWriter();
+
+    OutputWriter(const OutputWriter &) = delete;
+    OutputWriter &operator=(const OutputWriter &) = delete;
+
+    /**
+     * @brief Starts delivering output to the configured sinks
+     *
+     * Without any sink no thread is started and output is discarded.
+     */
+    void open(const OutputConfig &config);
+
+    bool isOpen() const { return running; }
+
+    // Appends to both the console and the log
+    void write(std::string_view text);
+    void write(char c) { write(std::string_view(&c, 1)); }
+    void write(int value);
+    void write(double value); // Formatted like std::ostream (%g), see NumberFormat.hpp
+
+    // Appends to the log only
+    void writeToLog(std::string_view text);
+
+    /**
+     * @brief Waits until all output written so far has been delivered
+     */
+    void flush();
+
+    /**
+     * @brief Flushes, stops the writer thread and releases the sinks
+     */
+    void close();
+
+    // Flushes every open writer (used on exit and before fatal errors)
+    static void flushAll();
+
+private:
+    void append(std::string_view consoleText, std::string_view logText);
+    template <typename Format>
+    void appendFormatted(Format format);
+    void queued(std::unique_lock<std::mutex> &lock, std::size_t bytes);
+    void run();
+
+    std::shared_ptr<OutputSink> console;
+    std::shared_ptr<OutputSink> log;
+    std::atomic<bool> running{false}; // Read by flushAll() from other threads
+    std::thread worker;
+
+    std::mutex mutex;
+    std::condition_variable wake;    // Signals the writer thread
+    std::condition_variable drained; // Signals flush() and blocked writers
+
+    std::string consolePending; // Guarded by mutex
+    std::string logPending;     // Guarded by mutex
+    unsigned long long bytesQueued = 0;
+    unsigned long long bytesWritten = 0;
+    bool flushRequested = false;
+    bool stopping = false;
+};
+
+#endif // OUTPUT_WRITER_HPP
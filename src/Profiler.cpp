@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <map>
+#include <ostream>
+
+#include "Profiler.hpp"
+#include "SourceLocation.hpp"
+
+namespace
+{
+    double toMilliseconds(Profiler::Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    std::string formatRow(const char *format, ...)
+    {
+        char buffer[512];
+        va_list args;
+        va_start(args, format);
+        std::vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        return buffer;
+    }
+
+    /**
+     * @brief Short description of a statement: its node type, value and location
+     */
+    std::string describe(const AST_NODE *node)
+    {
+        std::string text = getNodeTypeName(node->TYPE);
+        if (!node->VALUE.empty())
+        {
+            text += " '" + node->VALUE + "'";
+        }
+        std::string location = SourceMap::getInstance().describe(node->LOCATION);
+        if (!location.empty())
+        {
+            text += " at " + location;
+        }
+        return text;
+    }
+}
+
+Profiler::Profiler() : started(Clock::now())
+{
+}
+
+void Profiler::enterFrame(std::vector<Frame> &stack, Timing &timing)
+{
+    timing.count++;
+    timing.activeDepth++;
+    stack.push_back(Frame{&timing, Clock::now()});
+}
+
+void Profiler::exitFrame(std::vector<Frame> &stack)
+{
+    Frame frame = stack.back();
+    stack.pop_back();
+
+    Clock::duration elapsed = Clock::now() - frame.start;
+    Timing &timing = *frame.timing;
+
+    timing.exclusive += elapsed - frame.children;
+    if (--timing.activeDepth == 0)
+    {
+        timing.inclusive += elapsed;
+    }
+    if (!stack.empty())
+    {
+        stack.back().children += elapsed;
+    }
+}
+
+void Profiler::enterProc(const std::string &name, bool builtin)
+{
+    ProcStats &stats = procs[name];
+    stats.builtin = builtin;
+    enterFrame(procStack, stats);
+}
+
+void Profiler::exitProc()
+{
+    exitFrame(procStack);
+}
+
+void Profiler::enterStatement(const AST_NODE *node)
+{
+    enterFrame(statementStack, statements[node]);
+}
+
+void Profiler::exitStatement()
+{
+    exitFrame(statementStack);
+}
+
+void Profiler::report(std::ostream &out, std::size_t maxStatements) const
+{
+    out << "\n===== PROFILE =====\n\n";
+    out << formatRow("Total time: %.3f ms\n", toMilliseconds(Clock::now() - started));
+
+    // Procs, by exclusive time
+    std::vector<std::pair<const std::string *, const ProcStats *>> procRows;
+    for (const auto &entry : procs)
+    {
+        procRows.emplace_back(&entry.first, &entry.second);
+    }
+    std::sort(procRows.begin(), procRows.end(), [](const auto &a, const auto &b)
+              { return a.second->exclusive > b.second->exclusive; });
+
+    out << "\nProcs (by exclusive time)\n";
+    out << formatRow("%12s %14s %14s  %s\n", "calls", "inclusive ms", "exclusive ms", "proc");
+    for (const auto &row : procRows)
+    {
+        out << formatRow("%12llu %14.3f %14.3f  %s%s\n",
+                         static_cast<unsigned long long>(row.second->count),
+                         toMilliseconds(row.second->inclusive),
+                         toMilliseconds(row.second->exclusive),
+                         row.first->c_str(), row.second->builtin ? " (builtin)" : "");
+    }
+
+    // Node types, by count
+    std::vector<std::pair<std::uint64_t, NODE_TYPE>> typeRows;
+    for (std::size_t type = 0; type < nodeCounts.size(); type++)
+    {
+        if (nodeCounts[type] > 0)
+        {
+            typeRows.emplace_back(nodeCounts[type], static_cast<NODE_TYPE>(type));
+        }
+    }
+    std::sort(typeRows.begin(), typeRows.end(), [](const auto &a, const auto &b)
+              { return a.first > b.first; });
+
+    out << "\nNode types (by executions)\n";
+    out << formatRow("%12s  %s\n", "count", "type");
+    for (const auto &row : typeRows)
+    {
+        out << formatRow("%12llu  %s\n", static_cast<unsigned long long>(row.first),
+                         getNodeTypeName(row.second).c_str());
+    }
+
+    // Statements, by exclusive time
+    std::vector<std::pair<const AST_NODE *, const Timing *>> statementRows;
+    for (const auto &entry : statements)
+    {
+        statementRows.emplace_back(entry.first, &entry.second);
+    }
+    std::size_t shown = std::min(maxStatements, statementRows.size());
+    std::partial_sort(statementRows.begin(), statementRows.begin() + shown, statementRows.end(),
+                      [](const auto &a, const auto &b)
+                      { return a.second->exclusive > b.second->exclusive; });
+
+    out << "\nHottest statements (by exclusive time)\n";
+    out << formatRow("%12s %14s %14s  %s\n", "executions", "inclusive ms", "exclusive ms", "statement");
+    for (std::size_t i = 0; i < shown; i++)
+    {
+        const Timing &timing = *statementRows[i].second;
+        out << formatRow("%12llu %14.3f %14.3f  %s\n",
+                         static_cast<unsigned long long>(timing.count),
+                         toMilliseconds(timing.inclusive),
+                         toMilliseconds(timing.exclusive),
+                         describe(statementRows[i].first).c_str());
+    }
+
+    // Source lines: the statements parsed on each line, summed
+    struct LineStats
+    {
+        std::uint64_t executions = 0;
+        Clock::duration exclusive{};
+    };
+    std::map<std::pair<std::uint32_t, std::uint32_t>, LineStats> lines;
+    const SourceMap &sourceMap = SourceMap::getInstance();
+    for (const auto &entry : statements)
+    {
+        SourceLocation location = sourceMap.get(entry.first->LOCATION);
+        if (location.line == 0)
+        {
+            continue;
+        }
+        LineStats &stats = lines[{location.file, location.line}];
+        stats.executions += entry.second.count;
+        stats.exclusive += entry.second.exclusive;
+    }
+
+    std::vector<std::pair<const std::pair<std::uint32_t, std::uint32_t> *, const LineStats *>> lineRows;
+    for (const auto &entry : lines)
+    {
+        lineRows.emplace_back(&entry.first, &entry.second);
+    }
+    shown = std::min(maxStatements, lineRows.size());
+    std::partial_sort(lineRows.begin(), lineRows.begin() + shown, lineRows.end(),
+                      [](const auto &a, const auto &b)
+                      { return a.second->exclusive > b.second->exclusive; });
+
+    out << "\nHottest lines (by exclusive time)\n";
+    out << formatRow("%12s %14s  %s\n", "executions", "exclusive ms", "line");
+    for (std::size_t i = 0; i < shown; i++)
+    {
+        out << formatRow("%12llu %14.3f  %s:%u\n",
+                         static_cast<unsigned long long>(lineRows[i].second->executions),
+                         toMilliseconds(lineRows[i].second->exclusive),
+                         sourceMap.getFileName(lineRows[i].first->first).c_str(),
+                         lineRows[i].first->second);
+    }
+    out.flush();
+}
@@ -0,0 +1,134 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "parser.hpp"
+
+/**
+ * @brief Collects execution statistics for the 'profile' mode
+ *
+ * The interpreter holds a Profiler pointer that is null unless profiling
+ * was requested; every hook below is a scope object that does nothing but
+ * test that pointer when it is null.
+ *
+ * Statistics gathered:
+ *  - per proc (and builtin): calls, inclusive and exclusive time. A
+ *    recursive proc's inclusive time counts its outermost call only;
+ *    exclusive time excludes nested calls to any proc.
+ *  - per NODE_TYPE: how many times a node of that type was executed or
+ *    evaluated.
+ *  - per statement (each node run through executeNode): executions,
+ *    inclusive time and exclusive time, which excludes nested statements.
+ *  - per source line: the statements parsed on that line, summed, using
+ *    the nodes' SourceMap locations.
+ */
+class Profiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Profiler();
+
+    void enterProc(const std::string &name, bool builtin = false);
+    void exitProc();
+
+    void enterStatement(const AST_NODE *node);
+    void exitStatement();
+
+    void countNode(NODE_TYPE type) { nodeCounts[type]++; }
+
+    /**
+     * @brief Writes the report, each table sorted with the most expensive entry first
+     * @param maxStatements How many of the hottest statements to list
+     */
+    void report(std::ostream &out, std::size_t maxStatements = 20) const;
+
+    /**
+     * @brief Records a proc call for the lifetime of the scope
+     */
+    class ProcScope
+    {
+    public:
+        ProcScope(Profiler *profiler, const std::string &name, bool builtin = false) : profiler(profiler)
+        {
+            if (profiler)
+                profiler->enterProc(name, builtin);
+        }
+        ~ProcScope()
+        {
+            if (profiler)
+                profiler->exitProc();
+        }
+
+        ProcScope(const ProcScope &) = delete;
+        ProcScope &operator=(const ProcScope &) = delete;
+
+    private:
+        Profiler *profiler;
+    };
+
+    /**
+     * @brief Records one execution of a statement for the lifetime of the scope
+     */
+    class StatementScope
+    {
+    public:
+        StatementScope(Profiler *profiler, const AST_NODE *node) : profiler(profiler)
+        {
+            if (profiler)
+                profiler->enterStatement(node);
+        }
+        ~StatementScope()
+        {
+            if (profiler)
+                profiler->exitStatement();
+        }
+
+        StatementScope(const StatementScope &) = delete;
+        StatementScope &operator=(const StatementScope &) = delete;
+
+    private:
+        Profiler *profiler;
+    };
+
+private:
+    struct Timing
+    {
+        std::uint64_t count = 0;
+        Clock::duration inclusive{};
+        Clock::duration exclusive{};
+        int activeDepth = 0; // Frames of this entry on the stack (recursion)
+    };
+
+    struct ProcStats : Timing
+    {
+        bool builtin = false;
+    };
+
+    struct Frame
+    {
+        Timing *timing;
+        Clock::time_point start;
+        Clock::duration children{};
+    };
+
+    void enterFrame(std::vector<Frame> &stack, Timing &timing);
+    void exitFrame(std::vector<Frame> &stack);
+
+    Clock::time_point started;
+    std::unordered_map<std::string, ProcStats> procs;
+    std::unordered_map<const AST_NODE *, Timing> statements;
+    std::array<std::uint64_t, NODE_FLOOR + 1> nodeCounts{};
+
+    std::vector<Frame> procStack;
+    std::vector<Frame> statementStack;
+};
+
+#endif // PROFILER_HPP
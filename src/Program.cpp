@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <exception>
+
+#include "Program.hpp"
+#include "ErrorHandler.hpp"
+#include "FlatAST.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "ProgramCache.hpp"
+#include "SourceBuffer.hpp"
+
+namespace
+{
+    // Comment nodes are kept by the parser for the 'parse' listing only
+    void filterComments(AST_NODE *node)
+    {
+        if (node == nullptr)
+        {
+            return;
+        }
+
+        for (AST_NODE *sub : node->SUB_STATEMENTS)
+        {
+            filterComments(sub);
+        }
+        filterComments(node->CHILD);
+
+        auto &subs = node->SUB_STATEMENTS;
+        subs.erase(std::remove_if(subs.begin(), subs.end(),
+                                  [](AST_NODE *sub)
+                                  {
+                                      if (sub != nullptr && sub->TYPE == NODE_COMMENT)
+                                      {
+                                          delete sub;
+                                          return true;
+                                      }
+                                      return false;
+                                  }),
+                   subs.end());
+
+        if (node->CHILD && node->CHILD->TYPE == NODE_COMMENT)
+        {
+            delete node->CHILD;
+            node->CHILD = nullptr;
+        }
+    }
+
+    /**
+     * @brief Parses from a lexer with an ErrorHandler of its own
+     * @return The tree, or nullptr with error set
+     */
+    AST_NODE *parseProgram(Lexer &lexer, std::vector<std::string> &includedFiles, std::string &error)
+    {
+        // The report is handed back through error rather than printed
+        ErrorHandler errors;
+        errors.setEcho(false);
+        ErrorHandler::Scope errorScope(errors);
+
+        AST_NODE *root = nullptr;
+        try
+        {
+            Parser parser(lexer);
+            root = parser.parse();
+            includedFiles = parser.getIncludedFiles();
+        }
+        catch (const ErrorHandler::RuntimeError &)
+        {
+            // Already recorded; the partial tree is abandoned
+            root = nullptr;
+        }
+
+        if (errors.hasError() || root == nullptr)
+        {
+            error = errors.hasError() ? errors.getErrorReport() : "Parsing failed to produce an AST";
+            deleteTree(root);
+            return nullptr;
+        }
+
+        filterComments(root);
+        return root;
+    }
+}
+
+Program::~Program()
+{
+    deleteTree(root);
+}
+
+std::shared_ptr<const Program> Program::compile(const std::string &source, const std::string &name,
+                                                std::string &error)
+{
+    std::shared_ptr<Program> program(new Program());
+    program->name = name;
+
+    Lexer lexer(source);
+    lexer.setSourceName(name);
+    AST_NODE *parsed = parseProgram(lexer, program->includedFiles, error);
+    if (parsed == nullptr || !program->prepare(parsed, false, error))
+    {
+        return nullptr;
+    }
+    return program;
+}
+
+std::shared_ptr<const Program> Program::compileFile(const std::string &path, std::string &error, bool useCache)
+{
+    SourceBuffer source;
+    if (!source.open(path))
+    {
+        error = "Unable to open file " + path;
+        return nullptr;
+    }
+
+    std::shared_ptr<Program> program(new Program());
+    program->name = path;
+
+    std::unique_ptr<ProgramCache> cache;
+    if (useCache)
+    {
+        cache.reset(new ProgramCache(path));
+        FlatAST cached;
+        if (cache->load(source.view(), cached, program->includedFiles))
+        {
+            if (!program->prepare(cached.toTree(), useCache, error))
+            {
+                return nullptr;
+            }
+            return program;
+        }
+    }
+
+    Lexer lexer(source);
+    AST_NODE *parsed = parseProgram(lexer, program->includedFiles, error);
+    if (parsed == nullptr)
+    {
+        return nullptr;
+    }
+
+    if (cache)
+    {
+        FlatAST flat = FlatAST::fromTree(parsed);
+        if (!cache->store(source.view(), flat, program->includedFiles))
+        {
+            std::cerr << "Warning: Unable to write program cache " << cache->getCacheFilePath() << std::endl;
+        }
+    }
+
+    if (!program->prepare(parsed, useCache, error))
+    {
+        return nullptr;
+    }
+    return program;
+}
+
+bool Program::prepare(AST_NODE *parsed, bool useCache, std::string &error)
+{
+    root = parsed;
+
+    bool hasBegin = std::any_of(root->SUB_STATEMENTS.begin(), root->SUB_STATEMENTS.end(),
+                                [](const AST_NODE *statement)
+                                { return statement->TYPE == NODE_BEGIN_BLOCK; });
+    if (!hasBegin)
+    {
+        error = "No 'begin' block found in program.";
+        return false;
+    }
+
+    if (!libraries.load(root, useCache, error))
+    {
+        return false;
+    }
+
+    Interpreter::resolveBuiltinCalls(root);
+    Interpreter::collectFunctions(root, functions);
+    for (AST_NODE *library : libraries.getRoots())
+    {
+        Interpreter::collectFunctions(library, functions);
+    }
+    return true;
+}
+
+ExecutionContext::ExecutionContext(std::shared_ptr<const Program> program)
+    : program(program),
+      transcript(std::make_shared<MemorySink>()),
+      interpreter(program->root, transcriptConfig(transcript), &program->functions)
+{
+}
+
+ExecutionContext::ExecutionContext(std::shared_ptr<const Program> program, const OutputConfig &outputConfig)
+    : program(program),
+      interpreter(program->root, outputConfig, &program->functions)
+{
+}
+
+OutputConfig ExecutionContext::transcriptConfig(const std::shared_ptr<MemorySink> &sink)
+{
+    // The log sink gets the full transcript, the text the golden tests compare
+    OutputConfig config;
+    config.log = sink;
+    return config;
+}
+
+void ExecutionContext::setInputText(const std::string &text)
+{
+    inputText = text;
+    hasInputText = true;
+}
+
+bool ExecutionContext::run()
+{
+    ErrorHandler::Scope errorScope(errors);
+    errors.clear();
+    errorReport.clear();
+    if (transcript)
+    {
+        transcript->clear();
+    }
+
+    interpreter.reset();
+    for (const auto &input : inputs)
+    {
+        interpreter.setVariable(input.first, input.second);
+    }
+
+    if (hasInputText)
+    {
+        inputStream.clear();
+        inputStream.str(inputText);
+        interpreter.setInputStream(&inputStream);
+    }
+    else
+    {
+        interpreter.setInputStream(&std::cin);
+    }
+
+    runCount++;
+    try
+    {
+        interpreter.execute();
+    }
+    catch (const ErrorHandler::RuntimeError &)
+    {
+        // Recorded by reportRuntimeError(); the run stops here
+        interpreter.flushOutput();
+    }
+    catch (const std::exception &e)
+    {
+        interpreter.flushOutput();
+        errors.reportSemanticError(e.what());
+    }
+
+    if (errors.hasError())
+    {
+        errorReport = errors.getErrorReport();
+        return false;
+    }
+    return true;
+}
+
+std::string ExecutionContext::getOutput() const
+{
+    return transcript ? transcript->contents() : std::string();
+}
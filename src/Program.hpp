@@ -0,0 +1,169 @@
+#ifndef PROGRAM_HPP
+#define PROGRAM_HPP
+
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ErrorHandler.hpp"
+#include "interperter.hpp"
+#include "library/LibraryTable.hpp"
+#include "OutputSink.hpp"
+#include "Value.hpp"
+
+/**
+ * @brief A script compiled once for any number of runs
+ *
+ * Compiling lexes and parses the script and its headers, drops comments,
+ * loads the libraries it imports, binds builtin calls and indexes the
+ * procs by name. The result, the immutable half of execution, is never
+ * modified afterwards. Everything a run changes (variables, call frames,
+ * return values, output buffers, errors) lives in an ExecutionContext, so
+ * any number of contexts, on any number of threads, can execute one
+ * Program at the same time, without locks and without copying the tree.
+ *
+ * Programs are created through compile() or compileFile() and shared by
+ * std::shared_ptr, so a program lives as long as its last context.
+ */
+class Program
+{
+public:
+    ~Program();
+
+    Program(const Program &) = delete;
+    Program &operator=(const Program &) = delete;
+
+    /**
+     * @brief Compiles a script held in memory
+     * @param source The script text
+     * @param name Names the script in source locations and error messages
+     * @param error Receives the error report when nullptr is returned
+     * @return The compiled program, or nullptr if the script has errors
+     *
+     * Safe to call from several threads at once; headers are parsed once
+     * and shared through the HeaderCache.
+     */
+    static std::shared_ptr<const Program> compile(const std::string &source, const std::string &name,
+                                                  std::string &error);
+
+    /**
+     * @brief Compiles a script file
+     * @param path The script; 'source:' headers resolve as for the parser binary
+     * @param error Receives the error report when nullptr is returned
+     * @param useCache Reuse (and refresh) the script's .mlc file, see ProgramCache
+     * @return The compiled program, or nullptr if the file cannot be read or has errors
+     */
+    static std::shared_ptr<const Program> compileFile(const std::string &path, std::string &error,
+                                                      bool useCache = false);
+
+    const std::string &getName() const { return name; }
+
+    // Header files the script read through 'source:', nested ones included
+    const std::vector<std::string> &getIncludedFiles() const { return includedFiles; }
+
+private:
+    friend class ExecutionContext;
+
+    Program() = default;
+
+    /**
+     * @brief Takes ownership of a parsed tree and prepares it for execution
+     * @param useCache Load imported libraries through their .mllc cache files
+     * @return false (with error set) if the tree has no 'begin' block or a library fails to load
+     */
+    bool prepare(AST_NODE *parsed, bool useCache, std::string &error);
+
+    std::string name;
+    std::vector<std::string> includedFiles;
+    AST_NODE *root = nullptr;
+    LibraryTable libraries;
+    Interpreter::FunctionTable functions; // Script procs first, then library procs
+};
+
+/**
+ * @brief Runs a Program, over and over, with fresh state each time
+ *
+ * A context owns an Interpreter and its output writer, which are set up
+ * once; run() only clears the variables left by the previous run, so
+ * repeated runs cost little beyond the script itself. Inputs set with
+ * setInput() are defined as variables before the 'begin' block starts
+ * and stay in place for later runs until changed or cleared.
+ *
+ * A context runs one script at a time, but separate contexts can run on
+ * separate threads, sharing one Program and the libraries it loaded. Each
+ * has its own ErrorHandler, installed on the running thread for the
+ * duration of run(), so a runtime error ends only that run.
+ */
+class ExecutionContext
+{
+public:
+    /**
+     * @brief A context whose output transcript is kept in memory (see getOutput)
+     */
+    explicit ExecutionContext(std::shared_ptr<const Program> program);
+
+    /**
+     * @brief A context writing to the given sinks
+     */
+    ExecutionContext(std::shared_ptr<const Program> program, const OutputConfig &outputConfig);
+
+    ExecutionContext(const ExecutionContext &) = delete;
+    ExecutionContext &operator=(const ExecutionContext &) = delete;
+
+    /**
+     * @brief Defines a variable for the script before each run
+     */
+    void setInput(const std::string &name, const Value &value) { inputs[name] = value; }
+    void clearInputs() { inputs.clear(); }
+
+    /**
+     * @brief Text read by the script's input statements, one line per input
+     *
+     * Without it, input statements read std::cin.
+     */
+    void setInputText(const std::string &text);
+
+    /**
+     * @brief Executes the program from its 'begin' block
+     * @return false if the run reported errors; see getErrorReport()
+     */
+    bool run();
+
+    /**
+     * @brief Variables of the last run, such as results the script left behind
+     * @return nullptr if the last run never defined the name
+     */
+    const Value *getVariable(const std::string &name) const { return interpreter.findVariable(name); }
+
+    // Output of the last run; empty unless the context keeps it in memory
+    std::string getOutput() const;
+
+    // Errors of the last failed run
+    const std::string &getErrorReport() const { return errorReport; }
+
+    // Print errors on stderr as they are reported (the default), or only record them
+    void setErrorEcho(bool enabled) { errors.setEcho(enabled); }
+
+    const Program &getProgram() const { return *program; }
+    unsigned long long getRunCount() const { return runCount; }
+
+private:
+    std::shared_ptr<const Program> program;
+    std::shared_ptr<MemorySink> transcript; // Null when writing to caller-supplied sinks
+    ErrorHandler errors;
+    Interpreter interpreter;
+
+    std::map<std::string, Value> inputs;
+    std::string inputText;
+    bool hasInputText = false;
+    std::istringstream inputStream;
+
+    std::string errorReport;
+    unsigned long long runCount = 0;
+
+    static OutputConfig transcriptConfig(const std::shared_ptr<MemorySink> &sink);
+};
+
+#endif // PROGRAM_HPP
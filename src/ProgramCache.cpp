@@ -0,0 +1,252 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+#include "ProgramCache.hpp"
+#include "SourceBuffer.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr char CACHE_MAGIC[4] = {'M', 'L', 'C', '\0'};
+
+    // Bump whenever the file layout or the FlatAST image format changes
+    constexpr std::uint32_t CACHE_FORMAT_VERSION = 2;
+
+    /**
+     * @brief Fixed-size start of a cache file
+     *
+     * Followed by the dependency list (path length, path bytes, content hash
+     * for each header) and then the FlatAST image.
+     */
+    struct CacheHeader
+    {
+        char magic[4];
+        std::uint32_t formatVersion;
+        std::uint32_t nodeTypeCount; // Invalidates caches when NODE_TYPE gains entries
+        std::uint32_t dependencyCount;
+        std::uint64_t sourceHash;
+        std::uint64_t sourceSize;
+    };
+
+    template <typename T>
+    void appendRaw(std::string &out, const T &value)
+    {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool readRaw(std::string_view bytes, std::size_t &offset, T &value)
+    {
+        if (bytes.size() - offset < sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    /**
+     * @brief Hashes a file's current contents
+     * @return false if the file can no longer be read
+     */
+    bool hashFile(const std::string &path, std::uint64_t &hash)
+    {
+        SourceBuffer buffer;
+        if (!buffer.open(path))
+        {
+            return false;
+        }
+        hash = ProgramCache::hashBytes(buffer.view());
+        return true;
+    }
+
+    std::string toHex(std::uint64_t value)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex(16, '0');
+        for (int i = 15; i >= 0; i--)
+        {
+            hex[i] = digits[value & 0xF];
+            value >>= 4;
+        }
+        return hex;
+    }
+}
+
+ProgramCache::ProgramCache(const std::string &scriptPath)
+{
+    std::error_code error;
+    fs::path script = fs::absolute(scriptPath, error);
+    if (error)
+    {
+        script = scriptPath;
+    }
+
+    fs::path directory;
+    const char *configured = std::getenv("MINILANG_CACHE_DIR");
+    if (configured != nullptr && configured[0] != '\0')
+    {
+        directory = configured;
+    }
+    else
+    {
+        directory = script.parent_path() / ".mlcache";
+    }
+
+    // One cache file per script: re-running an edited script replaces its entry
+    cacheFilePath = (directory / (script.stem().string() + "-" + toHex(hashBytes(script.string())) + ".mlc")).string();
+}
+
+std::uint64_t ProgramCache::hashBytes(std::string_view bytes)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char byte : bytes)
+    {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool ProgramCache::load(std::string_view source, FlatAST &program, std::vector<std::string> &dependencies) const
+{
+    SourceBuffer cacheFile;
+    if (!cacheFile.open(cacheFilePath))
+    {
+        return false;
+    }
+
+    std::string_view bytes = cacheFile.view();
+    std::size_t offset = 0;
+
+    CacheHeader header;
+    if (!readRaw(bytes, offset, header) ||
+        std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header.formatVersion != CACHE_FORMAT_VERSION ||
+        header.nodeTypeCount != NODE_FLOOR + 1 ||
+        header.sourceSize != source.size() ||
+        header.sourceHash != hashBytes(source))
+    {
+        return false;
+    }
+
+    // Every header the script pulled in must be unchanged too
+    std::vector<std::string> recorded;
+    for (std::uint32_t i = 0; i < header.dependencyCount; i++)
+    {
+        std::uint32_t pathLength;
+        std::uint64_t recordedHash, currentHash;
+        if (!readRaw(bytes, offset, pathLength) || bytes.size() - offset < pathLength)
+        {
+            return false;
+        }
+        std::string path(bytes.substr(offset, pathLength));
+        offset += pathLength;
+
+        if (!readRaw(bytes, offset, recordedHash) ||
+            !hashFile(path, currentHash) || currentHash != recordedHash)
+        {
+            return false;
+        }
+        recorded.push_back(path);
+    }
+
+    if (!FlatAST::deserialize(bytes.substr(offset), program))
+    {
+        return false;
+    }
+    dependencies = std::move(recorded);
+    return true;
+}
+
+bool ProgramCache::store(std::string_view source, const FlatAST &program,
+                         const std::vector<std::string> &dependencies) const
+{
+    CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.formatVersion = CACHE_FORMAT_VERSION;
+    header.nodeTypeCount = NODE_FLOOR + 1;
+    header.dependencyCount = static_cast<std::uint32_t>(dependencies.size());
+    header.sourceHash = hashBytes(source);
+    header.sourceSize = source.size();
+
+    std::string contents;
+    appendRaw(contents, header);
+
+    for (const std::string &dependency : dependencies)
+    {
+        // Headers are found relative to the working directory, so record where this run found them
+        std::error_code error;
+        std::string path = fs::absolute(dependency, error).string();
+        std::uint64_t hash;
+        if (error || !hashFile(path, hash))
+        {
+            return false;
+        }
+
+        appendRaw(contents, static_cast<std::uint32_t>(path.size()));
+        contents += path;
+        appendRaw(contents, hash);
+    }
+
+    program.serialize(contents);
+    return writeFileAtomically(cacheFilePath, contents);
+}
+
+bool ProgramCache::writeFileAtomically(const std::string &path, const std::string &contents)
+{
+    std::error_code error;
+    fs::path destination(path);
+    if (destination.has_parent_path())
+    {
+        fs::create_directories(destination.parent_path(), error);
+        if (error)
+        {
+            return false;
+        }
+    }
+
+    // Unique per process and per call, so concurrent writers never share a temporary
+    static std::atomic<unsigned> writeSequence{0};
+#if defined(__unix__) || defined(__APPLE__)
+    long processId = static_cast<long>(getpid());
+#else
+    long processId = 0;
+#endif
+    fs::path temporary = destination;
+    temporary += ".tmp." + std::to_string(processId) + "." + std::to_string(writeSequence++);
+
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            return false;
+        }
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        if (!out)
+        {
+            out.close();
+            fs::remove(temporary, error);
+            return false;
+        }
+    }
+
+    fs::rename(temporary, destination, error);
+    if (error)
+    {
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef PROGRAM_CACHE_HPP
+#define PROGRAM_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FlatAST.hpp"
+
+/**
+ * @brief On-disk cache of parsed programs (.mlc files)
+ *
+ * A cache file holds the FlatAST image of a script after parsing and
+ * comment filtering, together with a content hash of the script and of
+ * every header it pulled in through 'source:'. When all hashes still match,
+ * the program is rebuilt from the memory-mapped image and the Lexer and
+ * Parser are skipped entirely.
+ *
+ * Cache files live in $MINILANG_CACHE_DIR if set, otherwise in a .mlcache
+ * directory next to the script, one file per script path. Files are written
+ * to a temporary name and renamed into place, so concurrent runs never see
+ * a partially written cache.
+ */
+class ProgramCache
+{
+public:
+    /**
+     * @param scriptPath Path of the script whose parse result is cached
+     */
+    explicit ProgramCache(const std::string &scriptPath);
+
+    /**
+     * @brief Loads the cached program if it is still valid
+     * @param source Current contents of the script
+     * @param program Receives the cached tree on a hit
+     * @param dependencies Receives the header files recorded by store() on a hit
+     * @return true on a hit; false if there is no cache file or it is stale or unreadable
+     */
+    bool load(std::string_view source, FlatAST &program, std::vector<std::string> &dependencies) const;
+
+    /**
+     * @brief Writes the parse result of the script to the cache
+     * @param source Contents of the script that was parsed
+     * @param program The parsed program
+     * @param dependencies Header files read while parsing (see Parser::getIncludedFiles)
+     * @return false if the cache file could not be written (the run carries on uncached)
+     */
+    bool store(std::string_view source, const FlatAST &program,
+               const std::vector<std::string> &dependencies) const;
+
+    // Location of this script's cache file
+    const std::string &getCacheFilePath() const { return cacheFilePath; }
+
+    // 64-bit FNV-1a hash, used for cache keys and content checks
+    static std::uint64_t hashBytes(std::string_view bytes);
+
+    /**
+     * @brief Replaces a file's contents atomically
+     *
+     * Writes to a temporary file in the same directory (created if missing)
+     * and renames it over the destination, so readers see either the old
+     * file or the complete new one.
+     */
+    static bool writeFileAtomically(const std::string &path, const std::string &contents);
+
+private:
+    std::string cacheFilePath;
+};
+
+#endif // PROGRAM_CACHE_HPP
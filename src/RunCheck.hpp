@@ -0,0 +1,79 @@
+#ifndef RUN_CHECK_HPP
+#define RUN_CHECK_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Helpers shared by the tools that check and time script runs
+ *
+ * The batch runner, the stress test and the bench harness all compare
+ * output with golden files or summarize timings. They use these
+ * functions, so the comparison rule and the percentile definition are
+ * the same everywhere. Header-only, so standalone tools need no sources.
+ */
+namespace runcheck
+{
+    /**
+     * @brief Reads a whole file
+     * @return false if it cannot be opened
+     */
+    inline bool readFile(const std::string &path, std::string &contents)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        contents = buffer.str();
+        return true;
+    }
+
+    // Lines with all whitespace removed, as diff -w compares them
+    inline std::vector<std::string> normalizedLines(const std::string &text)
+    {
+        std::vector<std::string> lines;
+        std::stringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            line.erase(std::remove_if(line.begin(), line.end(),
+                                      [](unsigned char c)
+                                      { return std::isspace(c); }),
+                       line.end());
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    /**
+     * @brief Compares output with a golden file the way tests.sh does (diff -w)
+     */
+    inline bool matchesExpected(const std::string &output, const std::string &expected)
+    {
+        return normalizedLines(output) == normalizedLines(expected);
+    }
+
+    /**
+     * @brief Nearest-rank percentile of sorted values, or 0 if there are none
+     */
+    inline double percentile(const std::vector<double> &sorted, double fraction)
+    {
+        if (sorted.empty())
+        {
+            return 0;
+        }
+        std::size_t rank = static_cast<std::size_t>(std::ceil(fraction * sorted.size()));
+        return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+    }
+}
+
+#endif // RUN_CHECK_HPP
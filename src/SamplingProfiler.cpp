@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <map>
+#include <ostream>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#endif
+
+#include "SamplingProfiler.hpp"
+#include "SourceLocation.hpp"
+
+static_assert(alignof(AST_NODE) >= 2, "The frame kind is stored in the low bit of the node pointer");
+
+namespace
+{
+    // The profiler the signal handler records into
+    std::atomic<SamplingProfiler *> activeProfiler{nullptr};
+
+    constexpr std::chrono::milliseconds COLLECT_INTERVAL(20);
+    constexpr std::size_t MAX_VALUE_LENGTH = 32;
+
+    /**
+     * @brief Folded-format name of one frame, or empty for frames that are left out
+     */
+    std::string frameName(std::uintptr_t frame)
+    {
+        const AST_NODE *node = reinterpret_cast<const AST_NODE *>(frame & ~std::uintptr_t(1));
+        const auto kind = static_cast<ShadowStack::Kind>(frame & 1);
+
+        std::string name;
+        if (kind == ShadowStack::Kind::PROC)
+        {
+            name = (node->TYPE == NODE_BEGIN_BLOCK) ? "begin" : node->VALUE;
+        }
+        else
+        {
+            if (node->TYPE == NODE_BLOCK || node->TYPE == NODE_FUNCTION_BODY || node->TYPE == NODE_BEGIN_BLOCK)
+            {
+                return name;
+            }
+            name = getNodeTypeName(node->TYPE);
+            if (!node->VALUE.empty())
+            {
+                name += " '" + node->VALUE.substr(0, MAX_VALUE_LENGTH) + "'";
+            }
+
+            SourceLocation location = SourceMap::getInstance().get(node->LOCATION);
+            if (location.line != 0)
+            {
+                name += " (" + SourceMap::getInstance().getFileName(location.file) + ":" +
+                        std::to_string(location.line) + ")";
+            }
+        }
+
+        // ';' separates frames and a newline ends the record
+        std::replace(name.begin(), name.end(), ';', ':');
+        std::replace(name.begin(), name.end(), '\n', ' ');
+        return name;
+    }
+}
+
+SamplingProfiler::SamplingProfiler(int intervalMicroseconds)
+    : intervalMicroseconds(std::max(intervalMicroseconds, 1))
+{
+}
+
+SamplingProfiler::~SamplingProfiler()
+{
+    stop();
+}
+
+void SamplingProfiler::handleSignal(int)
+{
+    SamplingProfiler *profiler = activeProfiler.load(std::memory_order_relaxed);
+    if (profiler)
+    {
+        profiler->record();
+    }
+}
+
+/**
+ * @brief Copies the shadow stack into the ring (signal handler context)
+ */
+void SamplingProfiler::record()
+{
+    std::atomic_signal_fence(std::memory_order_acquire);
+    const int depth = std::min(shadowStack.depth.load(std::memory_order_relaxed), ShadowStack::CAPACITY);
+    if (depth <= 0)
+    {
+        return;
+    }
+
+    const std::uint64_t start = head.load(std::memory_order_relaxed);
+    const std::uint64_t needed = static_cast<std::uint64_t>(depth) + 1;
+    if (start + needed - tail.load(std::memory_order_acquire) > RING_CAPACITY)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const std::uint64_t mask = RING_CAPACITY - 1;
+    ring[start & mask] = static_cast<std::uintptr_t>(depth);
+    for (int i = 0; i < depth; i++)
+    {
+        ring[(start + 1 + i) & mask] = shadowStack.frames[i];
+    }
+    head.store(start + needed, std::memory_order_release);
+}
+
+/**
+ * @brief Moves the samples recorded so far from the ring into the stack counts
+ */
+void SamplingProfiler::drain()
+{
+    const std::uint64_t end = head.load(std::memory_order_acquire);
+    std::uint64_t position = tail.load(std::memory_order_relaxed);
+    const std::uint64_t mask = RING_CAPACITY - 1;
+
+    std::string key;
+    while (position < end)
+    {
+        const std::uint64_t depth = ring[position & mask];
+        key.resize(depth * sizeof(std::uintptr_t));
+        for (std::uint64_t i = 0; i < depth; i++)
+        {
+            std::uintptr_t frame = ring[(position + 1 + i) & mask];
+            std::memcpy(&key[i * sizeof(frame)], &frame, sizeof(frame));
+        }
+        stacks[key]++;
+        samples++;
+        position += depth + 1;
+    }
+    tail.store(position, std::memory_order_release);
+}
+
+void SamplingProfiler::runCollector()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping)
+    {
+        wake.wait_for(lock, COLLECT_INTERVAL, [this]
+                      { return stopping; });
+        drain();
+    }
+}
+
+#if defined(__linux__)
+
+bool SamplingProfiler::start(std::string &error)
+{
+    if (running)
+    {
+        return true;
+    }
+
+    SamplingProfiler *expected = nullptr;
+    if (!activeProfiler.compare_exchange_strong(expected, this))
+    {
+        error = "Another sampling profiler is already running";
+        return false;
+    }
+
+    ring.reset(new std::uintptr_t[RING_CAPACITY]);
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = &SamplingProfiler::handleSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, nullptr);
+
+    // A CPU-time timer on this thread only, so samples are never taken
+    // from (or charged to) the output writer or the collector
+    struct sigevent event;
+    std::memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer) != 0)
+    {
+        activeProfiler.store(nullptr);
+        error = std::string("Unable to create the sampling timer: ") + std::strerror(errno);
+        return false;
+    }
+
+    stopping = false;
+    collector = std::thread(&SamplingProfiler::runCollector, this);
+
+    struct itimerspec interval;
+    interval.it_interval.tv_sec = intervalMicroseconds / 1000000;
+    interval.it_interval.tv_nsec = static_cast<long>(intervalMicroseconds % 1000000) * 1000;
+    interval.it_value = interval.it_interval;
+    timer_settime(timer, 0, &interval, nullptr);
+
+    running = true;
+    return true;
+}
+
+void SamplingProfiler::stop()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    // The handler stays installed: a tick still pending after the timer
+    // is deleted must not reach SIGPROF's default action, which is to exit
+    timer_delete(timer);
+    activeProfiler.store(nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    collector.join();
+    drain();
+    running = false;
+}
+
+#else
+
+bool SamplingProfiler::start(std::string &error)
+{
+    error = "Sampling is only available on Linux";
+    return false;
+}
+
+void SamplingProfiler::stop()
+{
+}
+
+#endif
+
+void SamplingProfiler::writeFolded(std::ostream &out) const
+{
+    // Different raw stacks can fold to the same names (e.g. once the
+    // containers are dropped), so merge by name, in name order
+    std::map<std::string, std::uint64_t> folded;
+    std::unordered_map<std::uintptr_t, std::string> names;
+
+    for (const auto &entry : stacks)
+    {
+        const std::string &key = entry.first;
+        std::string line;
+        for (std::size_t offset = 0; offset < key.size(); offset += sizeof(std::uintptr_t))
+        {
+            std::uintptr_t frame;
+            std::memcpy(&frame, &key[offset], sizeof(frame));
+
+            auto it = names.find(frame);
+            if (it == names.end())
+            {
+                it = names.emplace(frame, frameName(frame)).first;
+            }
+            if (it->second.empty())
+            {
+                continue;
+            }
+            if (!line.empty())
+            {
+                line += ';';
+            }
+            line += it->second;
+        }
+        if (!line.empty())
+        {
+            folded[line] += entry.second;
+        }
+    }
+
+    for (const auto &entry : folded)
+    {
+        out << entry.first << ' ' << entry.second << '\n';
+    }
+    out.flush();
+}
@@ -0,0 +1,166 @@
+#ifndef SAMPLING_PROFILER_HPP
+#define SAMPLING_PROFILER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "parser.hpp"
+
+/**
+ * @brief The procs and statements the interpreter is currently executing
+ *
+ * Maintained by the interpreter thread and read by the SIGPROF handler,
+ * which interrupts that same thread, so a push is two plain stores and a
+ * compiler fence. Frames beyond CAPACITY are counted but not recorded;
+ * samples then show the outermost CAPACITY frames.
+ */
+class ShadowStack
+{
+public:
+    static constexpr int CAPACITY = 256;
+
+    enum class Kind : std::uintptr_t
+    {
+        PROC = 0,     // A proc or builtin call (the node holds its name) or the begin block
+        STATEMENT = 1 // A node run through executeNode
+    };
+
+    void push(const AST_NODE *node, Kind kind)
+    {
+        int current = depth.load(std::memory_order_relaxed);
+        if (current < CAPACITY)
+        {
+            frames[current] = reinterpret_cast<std::uintptr_t>(node) | static_cast<std::uintptr_t>(kind);
+        }
+        std::atomic_signal_fence(std::memory_order_release);
+        depth.store(current + 1, std::memory_order_relaxed);
+    }
+
+    void pop()
+    {
+        depth.store(depth.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Keeps a frame on the stack for the lifetime of the scope; does nothing for a null stack
+     */
+    class Scope
+    {
+    public:
+        Scope(ShadowStack *stack, const AST_NODE *node, Kind kind) : stack(stack)
+        {
+            if (stack)
+                stack->push(node, kind);
+        }
+        ~Scope()
+        {
+            if (stack)
+                stack->pop();
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        ShadowStack *stack;
+    };
+
+private:
+    friend class SamplingProfiler;
+
+    std::uintptr_t frames[CAPACITY];
+    std::atomic<int> depth{0};
+};
+
+/**
+ * @brief Statistical profiler that samples a ShadowStack on a SIGPROF timer
+ *
+ * start() arms a timer on the CPU time of the calling thread, which must
+ * be the thread that runs the interpreter. Each tick the signal handler
+ * copies the shadow stack into a preallocated ring buffer; a background
+ * thread drains the ring and counts identical stacks. Nothing in the
+ * handler allocates or locks. When the ring is full a sample is dropped
+ * and counted.
+ *
+ * writeFolded() emits the counts in the "folded stacks" format read by
+ * flamegraph.pl and speedscope: one line per distinct stack, frames
+ * outermost first, separated by ';', followed by a space and the count.
+ * Procs appear by name, statements by node type, value and source line;
+ * the pure container nodes (blocks and function bodies) are left out.
+ *
+ * Only one profiler can sample at a time. Sampling needs Linux (per-thread
+ * CPU timers); elsewhere start() reports that it is unavailable.
+ */
+class SamplingProfiler
+{
+public:
+    static constexpr int DEFAULT_INTERVAL_US = 1000;
+
+    explicit SamplingProfiler(int intervalMicroseconds = DEFAULT_INTERVAL_US);
+    ~SamplingProfiler();
+
+    SamplingProfiler(const SamplingProfiler &) = delete;
+    SamplingProfiler &operator=(const SamplingProfiler &) = delete;
+
+    /**
+     * @brief Starts sampling the calling thread
+     * @param error Receives a message when false is returned
+     */
+    bool start(std::string &error);
+
+    /**
+     * @brief Stops the timer and collects the remaining samples
+     */
+    void stop();
+
+    ShadowStack *getShadowStack() { return &shadowStack; }
+
+    std::uint64_t getSampleCount() const { return samples; }
+    std::uint64_t getDroppedCount() const { return dropped.load(); }
+
+    /**
+     * @brief Writes the collected stacks in folded format
+     *
+     * The AST the samples point into must still be alive.
+     */
+    void writeFolded(std::ostream &out) const;
+
+private:
+    static void handleSignal(int signal);
+    void record();
+    void drain();
+    void runCollector();
+
+    int intervalMicroseconds;
+    ShadowStack shadowStack;
+
+    // Ring of sample records: a frame count followed by that many frames
+    static constexpr std::uint64_t RING_CAPACITY = 1 << 20; // Entries; a power of two
+    std::unique_ptr<std::uintptr_t[]> ring;
+    std::atomic<std::uint64_t> head{0}; // Written by the signal handler
+    std::atomic<std::uint64_t> tail{0}; // Written by the collector
+    std::atomic<std::uint64_t> dropped{0};
+
+    // Raw frame sequences and how often each was sampled; collector only
+    std::unordered_map<std::string, std::uint64_t> stacks;
+    std::uint64_t samples = 0;
+
+    bool running = false;
+#if defined(__linux__)
+    timer_t timer{};
+#endif
+    std::thread collector;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+#endif // SAMPLING_PROFILER_HPP
@@ -0,0 +1,139 @@
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#include "SourceBuffer.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SOURCE_BUFFER_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SourceBuffer::~SourceBuffer()
+{
+    release();
+}
+
+SourceBuffer::SourceBuffer(SourceBuffer &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+/**
+ * @brief Takes over another buffer's mapping or owned copy
+ *
+ * An owned copy may live in the string's small-buffer storage, so the data
+ * pointer is re-derived from our own string rather than copied across.
+ */
+SourceBuffer &SourceBuffer::operator=(SourceBuffer &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+
+        mapped = other.mapped;
+        length = other.length;
+        filePath = std::move(other.filePath);
+        if (mapped)
+        {
+            bytes = other.bytes;
+        }
+        else
+        {
+            owned = std::move(other.owned);
+            bytes = owned.c_str();
+        }
+
+        other.bytes = "";
+        other.length = 0;
+        other.mapped = false;
+        other.owned.clear();
+        other.filePath.clear();
+    }
+    return *this;
+}
+
+/**
+ * @brief Unmaps or frees the current contents and resets to an empty buffer
+ */
+void SourceBuffer::release()
+{
+#ifdef SOURCE_BUFFER_MMAP
+    if (mapped)
+    {
+        munmap(const_cast<char *>(bytes), length);
+    }
+#endif
+    bytes = "";
+    length = 0;
+    mapped = false;
+    owned.clear();
+    filePath.clear();
+}
+
+bool SourceBuffer::open(const std::string &path)
+{
+    release();
+
+#ifdef SOURCE_BUFFER_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    if (info.st_size > 0)
+    {
+        void *region = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (region == MAP_FAILED)
+        {
+            return false;
+        }
+
+        // Sources are lexed front to back exactly once
+        madvise(region, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+
+        bytes = static_cast<const char *>(region);
+        length = static_cast<std::size_t>(info.st_size);
+        mapped = true;
+        filePath = path;
+        return true;
+    }
+
+    // Zero-length files cannot be mapped; they are simply empty sources
+    ::close(fd);
+    filePath = path;
+    return true;
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    owned.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    bytes = owned.c_str();
+    length = owned.size();
+    filePath = path;
+    return true;
+#endif
+}
+
+SourceBuffer SourceBuffer::fromString(std::string text)
+{
+    SourceBuffer buffer;
+    buffer.owned = std::move(text);
+    buffer.bytes = buffer.owned.c_str();
+    buffer.length = buffer.owned.size();
+    return buffer;
+}
@@ -0,0 +1,64 @@
+#ifndef SOURCE_BUFFER_HPP
+#define SOURCE_BUFFER_HPP
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+/**
+ * @brief Read-only view of a source file's bytes
+ *
+ * On POSIX systems the file is memory-mapped, so opening even a large
+ * script or library does not copy it; the Lexer reads straight out of the
+ * mapping. Empty files, and platforms without mmap, fall back to an owned
+ * in-memory copy. The buffer must outlive any Lexer constructed from it.
+ */
+class SourceBuffer
+{
+public:
+    SourceBuffer() = default;
+    ~SourceBuffer();
+
+    SourceBuffer(const SourceBuffer &) = delete;
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+    SourceBuffer(SourceBuffer &&other) noexcept;
+    SourceBuffer &operator=(SourceBuffer &&other) noexcept;
+
+    /**
+     * @brief Maps a file into memory
+     * @param path Path of the file to open
+     * @return true on success, false if the file could not be opened or mapped
+     *
+     * Any previously opened file is released first.
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Wraps an in-memory string (used for generated or embedded sources)
+     * @param text The source text; the buffer keeps its own copy
+     */
+    static SourceBuffer fromString(std::string text);
+
+    const char *data() const { return bytes; }
+    std::size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    std::string_view view() const { return std::string_view(bytes, length); }
+
+    // True when the bytes come from a memory mapping rather than an owned copy
+    bool isMapped() const { return mapped; }
+
+    // Path passed to open(), empty for in-memory buffers
+    const std::string &path() const { return filePath; }
+
+private:
+    void release();
+
+    const char *bytes = "";
+    std::size_t length = 0;
+    bool mapped = false;
+    std::string owned;
+    std::string filePath;
+};
+
+#endif // SOURCE_BUFFER_HPP
@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cstring>
+
+#include "SourceLocation.hpp"
+
+SourceMap::SourceMap()
+{
+    files.push_back("<input>");
+    interned.push_back(SourceLocation()); // Keeps INTERNED_BIT | 0 unused
+}
+
+std::uint32_t SourceMap::internFileLocked(const std::string &name)
+{
+    auto it = fileIds.find(name);
+    if (it != fileIds.end())
+    {
+        return it->second;
+    }
+
+    std::uint32_t id = static_cast<std::uint32_t>(files.size());
+    files.push_back(name);
+    fileIds.emplace(name, id);
+    return id;
+}
+
+std::uint32_t SourceMap::internFile(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return internFileLocked(name);
+}
+
+std::string SourceMap::getFileName(std::uint32_t file) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return file < files.size() ? files[file] : files[0];
+}
+
+SourceMap::Handle SourceMap::registerSource(const std::string &name, std::string_view text)
+{
+    // One pass over the text for the line table
+    std::vector<std::uint32_t> lineStarts{0};
+    const char *begin = text.data();
+    const char *end = begin + text.size();
+    for (const char *p = begin; (p = static_cast<const char *>(std::memchr(p, '\n', end - p))) != nullptr; p++)
+    {
+        lineStarts.push_back(static_cast<std::uint32_t>(p - begin + 1));
+    }
+
+    const std::size_t textHash = std::hash<std::string_view>()(text);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::uint32_t file = internFileLocked(name);
+    const std::size_t key = textHash ^ (std::hash<std::uint32_t>()(file) * 0x9E3779B97F4A7C15ull);
+
+    // The same text lexed again keeps its handles
+    auto candidates = sourcesByContent.equal_range(key);
+    for (auto it = candidates.first; it != candidates.second; ++it)
+    {
+        const Source &source = sources[it->second];
+        if (source.file == file && source.length == text.size() && source.lineStarts == lineStarts)
+        {
+            return source.base;
+        }
+    }
+
+    if (text.size() >= INTERNED_BIT - nextBase)
+    {
+        return NO_LOCATION;
+    }
+
+    Source source{nextBase, static_cast<std::uint32_t>(text.size()), file, std::move(lineStarts)};
+    nextBase += source.length + 1; // One past the end, for tokens at end of input
+    sourcesByContent.emplace(key, sources.size());
+    sources.push_back(std::move(source));
+    return sources.back().base;
+}
+
+SourceMap::Handle SourceMap::internLocked(const SourceLocation &location)
+{
+    if (location.line == 0)
+    {
+        return NO_LOCATION;
+    }
+
+    auto it = internedHandles.find(location);
+    if (it != internedHandles.end())
+    {
+        return it->second;
+    }
+
+    Handle handle = INTERNED_BIT | static_cast<Handle>(interned.size());
+    interned.push_back(location);
+    internedHandles.emplace(location, handle);
+    return handle;
+}
+
+SourceMap::Handle SourceMap::intern(const SourceLocation &location)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return internLocked(location);
+}
+
+void SourceMap::intern(const std::vector<SourceLocation> &locations, std::vector<Handle> &result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    result.resize(locations.size());
+    for (std::size_t i = 0; i < locations.size(); i++)
+    {
+        result[i] = internLocked(locations[i]);
+    }
+}
+
+/**
+ * @brief Decodes a handle; the caller holds the lock
+ */
+SourceLocation SourceMap::locate(Handle handle) const
+{
+    if (handle == NO_LOCATION)
+    {
+        return SourceLocation();
+    }
+
+    if (handle & INTERNED_BIT)
+    {
+        Handle index = handle & ~INTERNED_BIT;
+        return index < interned.size() ? interned[index] : SourceLocation();
+    }
+
+    // The source whose range holds the handle: the last one starting at or before it
+    auto source = std::upper_bound(sources.begin(), sources.end(), handle, [](Handle value, const Source &candidate)
+                                   { return value < candidate.base; });
+    if (source == sources.begin())
+    {
+        return SourceLocation();
+    }
+    --source;
+
+    std::uint32_t offset = handle - source->base;
+    if (offset > source->length)
+    {
+        return SourceLocation();
+    }
+
+    auto line = std::upper_bound(source->lineStarts.begin(), source->lineStarts.end(), offset);
+    SourceLocation location;
+    location.file = source->file;
+    location.line = static_cast<std::uint32_t>(line - source->lineStarts.begin());
+    location.column = offset - *(line - 1) + 1;
+    return location;
+}
+
+SourceLocation SourceMap::get(Handle handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return locate(handle);
+}
+
+void SourceMap::resolve(const std::vector<Handle> &handles, std::vector<SourceLocation> &result) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    result.resize(handles.size());
+    for (std::size_t i = 0; i < handles.size(); i++)
+    {
+        result[i] = locate(handles[i]);
+    }
+}
+
+std::string SourceMap::describe(Handle handle) const
+{
+    SourceLocation location = get(handle);
+    if (location.line == 0)
+    {
+        return std::string();
+    }
+    return getFileName(location.file) + ":" + std::to_string(location.line) + ":" + std::to_string(location.column);
+}
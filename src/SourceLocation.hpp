@@ -0,0 +1,131 @@
+#ifndef SOURCE_LOCATION_HPP
+#define SOURCE_LOCATION_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief A position in a source file; line and column count from 1
+ */
+struct SourceLocation
+{
+    std::uint32_t file = 0; // SourceMap file id
+    std::uint32_t line = 0; // 0 when unknown
+    std::uint32_t column = 0;
+
+    bool operator==(const SourceLocation &other) const
+    {
+        return file == other.file && line == other.line && column == other.column;
+    }
+};
+
+/**
+ * @class SourceMap
+ * @brief Process-wide table of source files and locations
+ *
+ * Tokens and AST nodes do not carry a SourceLocation; they hold a 32-bit
+ * handle into this table, so a node stays the same size and a location is
+ * only decoded when something is reported.
+ *
+ * There are two kinds of handle:
+ *  - Offset handles. registerSource() reserves a range of handles for a
+ *    source text and records where its lines start; the lexer then labels
+ *    each token with range start + byte offset, which costs nothing per
+ *    token. Registering the same text under the same name again returns
+ *    the same range.
+ *  - Interned handles (top bit set), for locations that arrive without
+ *    their text, such as trees loaded from a cache file. Equal locations
+ *    share a handle.
+ *
+ * Handle 0 (NO_LOCATION) means the position is unknown, e.g. for nodes
+ * synthesized by the library manager. File id 0 names sources that did
+ * not come from a file.
+ */
+class SourceMap
+{
+public:
+    using Handle = std::uint32_t;
+    static constexpr Handle NO_LOCATION = 0;
+
+    static SourceMap &getInstance()
+    {
+        static SourceMap instance;
+        return instance;
+    }
+
+    SourceMap(const SourceMap &) = delete;
+    SourceMap &operator=(const SourceMap &) = delete;
+
+    // Returns the id of a file name, adding it on first sight
+    std::uint32_t internFile(const std::string &name);
+    std::string getFileName(std::uint32_t file) const;
+
+    /**
+     * @brief Reserves offset handles for a source text
+     * @return Handle of byte 0; byte i is that plus i. NO_LOCATION once the
+     *         offset handle space is exhausted.
+     *
+     * A text registered again under the same name is found by a hash of
+     * its contents, so compiling the same scripts over and over (batch
+     * mode, an embedding host) neither slows down nor uses up handles.
+     */
+    Handle registerSource(const std::string &name, std::string_view text);
+
+    // Returns the handle of a location, adding it on first sight
+    Handle intern(const SourceLocation &location);
+    SourceLocation get(Handle handle) const;
+
+    // Bulk forms of get() and intern(), taking the lock once
+    void resolve(const std::vector<Handle> &handles, std::vector<SourceLocation> &result) const;
+    void intern(const std::vector<SourceLocation> &locations, std::vector<Handle> &result);
+
+    /**
+     * @brief Formats a location as "file:line:column"
+     * @return Empty for NO_LOCATION
+     */
+    std::string describe(Handle handle) const;
+
+private:
+    SourceMap();
+
+    static constexpr Handle INTERNED_BIT = 0x80000000u;
+
+    struct Source
+    {
+        Handle base;                          // Handle of byte 0
+        std::uint32_t length;                 // Bytes, so the range is [base, base + length]
+        std::uint32_t file;                   // File id
+        std::vector<std::uint32_t> lineStarts; // Offset of each line's first byte
+    };
+
+    struct LocationHash
+    {
+        std::size_t operator()(const SourceLocation &location) const
+        {
+            std::uint64_t key = (static_cast<std::uint64_t>(location.file) << 48) ^
+                                (static_cast<std::uint64_t>(location.line) << 16) ^ location.column;
+            return std::hash<std::uint64_t>()(key);
+        }
+    };
+
+    SourceLocation locate(Handle handle) const;
+    Handle internLocked(const SourceLocation &location);
+    std::uint32_t internFileLocked(const std::string &name);
+
+    mutable std::mutex mutex;
+    std::vector<std::string> files;
+    std::unordered_map<std::string, std::uint32_t> fileIds;
+
+    std::vector<Source> sources; // In handle order
+    std::unordered_multimap<std::size_t, std::size_t> sourcesByContent; // Hash of file id and text -> index in sources
+    Handle nextBase = 1;
+
+    std::vector<SourceLocation> interned; // Indexed by handle without INTERNED_BIT
+    std::unordered_map<SourceLocation, Handle, LocationHash> internedHandles;
+};
+
+#endif // SOURCE_LOCATION_HPP
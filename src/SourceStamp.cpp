@@ -0,0 +1,25 @@
+#include <filesystem>
+#include <system_error>
+
+#include "SourceStamp.hpp"
+
+namespace fs = std::filesystem;
+
+bool SourceStamp::read(const std::string &path, SourceStamp &stamp)
+{
+    std::error_code error;
+    auto modified = fs::last_write_time(path, error);
+    if (error)
+    {
+        return false;
+    }
+    auto length = fs::file_size(path, error);
+    if (error)
+    {
+        return false;
+    }
+
+    stamp.modifiedTime = static_cast<std::int64_t>(modified.time_since_epoch().count());
+    stamp.size = static_cast<std::uint64_t>(length);
+    return true;
+}
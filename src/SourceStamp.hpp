@@ -0,0 +1,35 @@
+#ifndef SOURCE_STAMP_HPP
+#define SOURCE_STAMP_HPP
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Identifies one version of a source file
+ *
+ * Every cache that must notice an edited file checks it the same way: the
+ * HeaderCache and LibraryUnitCache in memory, the LibraryCache on disk.
+ * read() takes the modification time and size, which is all that is
+ * compared before an entry is trusted; contentHash is filled in by
+ * whoever reads the bytes.
+ */
+struct SourceStamp
+{
+    std::int64_t modifiedTime = 0; // last_write_time ticks
+    std::uint64_t size = 0;
+    std::uint64_t contentHash = 0;
+
+    /**
+     * @brief Reads a file's modification time and size (not its hash)
+     * @return false if the file cannot be examined
+     */
+    static bool read(const std::string &path, SourceStamp &stamp);
+
+    // Same modification time and size; the content hash is not compared
+    bool sameFile(const SourceStamp &other) const
+    {
+        return modifiedTime == other.modifiedTime && size == other.size;
+    }
+};
+
+#endif // SOURCE_STAMP_HPP
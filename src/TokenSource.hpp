@@ -0,0 +1,59 @@
+#ifndef TOKEN_SOURCE_HPP
+#define TOKEN_SOURCE_HPP
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+struct Token;
+
+/**
+ * @brief Pull interface for a stream of tokens
+ *
+ * The Parser asks for tokens one at a time instead of taking the whole
+ * program up front. The Lexer implements this directly so parsing can start
+ * before lexing finishes and only a small lookahead window of tokens is
+ * alive at once.
+ */
+class TokenSource
+{
+public:
+    virtual ~TokenSource() = default;
+
+    /**
+     * @brief Produces the next token
+     * @return The next token, or nullptr once the stream is exhausted
+     */
+    virtual Token *nextToken() = 0;
+
+    /**
+     * @brief Whether tokens handed out become the consumer's to delete
+     */
+    virtual bool transfersOwnership() const = 0;
+};
+
+/**
+ * @brief Token source over an already tokenized program
+ *
+ * Used when the caller needs the full token vector anyway (e.g. to print
+ * it). The tokens stay owned by the caller.
+ */
+class VectorTokenSource : public TokenSource
+{
+public:
+    explicit VectorTokenSource(std::vector<Token *> tokens)
+        : tokens(std::move(tokens)), position(0) {}
+
+    Token *nextToken() override
+    {
+        return position < tokens.size() ? tokens[position++] : nullptr;
+    }
+
+    bool transfersOwnership() const override { return false; }
+
+private:
+    std::vector<Token *> tokens;
+    std::size_t position;
+};
+
+#endif // TOKEN_SOURCE_HPP
@@ -1,9 +1,9 @@
 #include <stdexcept>
-#include <sstream>
-#include <iomanip>
 #include <cctype>
 
 #include "dynamic_array.hpp"
+#include "MemoryStats.hpp"
+#include "NumberFormat.hpp"
 #include "Value.hpp"
 
 Value::Value() : type(Type::NONE) {}
@@ -12,23 +12,41 @@ Value::Value(int v) : type(Type::INTEGER), data(v) {}
 Value::Value(double v) : type(Type::DOUBLE), data(v) {}
 Value::Value(char v) : type(Type::CHAR), data(v) {}
 Value::Value(bool v) : type(Type::BOOL), data(v) {}
-Value::Value(const std::string &v) : type(Type::STRING), data(v) {}
+Value::Value(const std::string &v) : type(Type::STRING), data(v)
+{
+    trackPayload(MemoryStats::allocate);
+}
+Value::Value(std::string &&v) : type(Type::STRING), data(std::move(v))
+{
+    trackPayload(MemoryStats::allocate);
+}
 Value::Value(std::shared_ptr<DynamicArray> arr) : type(Type::ARRAY), data(arr) {}
 
-Value::Value(const Value &other) : type(other.type), data(other.data) {}
+Value::Value(const Value &other) : type(other.type), data(other.data)
+{
+    trackPayload(MemoryStats::allocate);
+}
 
+// A moved string keeps its buffer, so the moved-to Value takes over its accounting
 Value::Value(Value &&other) noexcept : type(other.type), data(std::move(other.data))
 {
     other.type = Type::NONE;
 }
 
+void Value::releasePayload() const
+{
+    trackPayload(MemoryStats::release);
+}
+
 // Copy assignment operator
 Value &Value::operator=(const Value &other)
 {
     if (this != &other)
     {
+        trackPayload(MemoryStats::release);
         type = other.type;
         data = other.data;
+        trackPayload(MemoryStats::allocate);
     }
     return *this;
 }
@@ -38,6 +56,7 @@ Value &Value::operator=(Value &&other) noexcept
 {
     if (this != &other)
     {
+        trackPayload(MemoryStats::release);
         type = other.type;
         data = std::move(other.data);
         other.type = Type::NONE;
@@ -45,6 +64,14 @@ Value &Value::operator=(Value &&other) noexcept
     return *this;
 }
 
+void Value::trackPayload(void (*track)(MemoryCategory, std::size_t)) const
+{
+    if (type == Type::STRING && MemoryStats::isEnabled())
+    {
+        track(MemoryCategory::STRINGS, MemoryStats::payloadBytes(std::get<std::string>(data)));
+    }
+}
+
 // Type info
 Value::Type Value::getType() const
 {
@@ -153,59 +180,67 @@ std::string Value::getString() const { return asString(); }
 // String conversion
 std::string Value::toString() const
 {
-    std::stringstream ss;
+    if (type == Type::STRING)
+    {
+        return std::get<std::string>(data);
+    }
+
+    std::string str;
+    appendTo(str);
+    return str;
+}
 
+void Value::appendTo(std::string &out) const
+{
     switch (type)
     {
     case Type::INTEGER:
-        ss << std::get<int>(data);
+        numberformat::appendInt(out, std::get<int>(data));
         break;
 
     case Type::DOUBLE:
-        ss << std::fixed << std::setprecision(6) << std::get<double>(data);
-        // Trim trailing zeros
-        {
-            std::string str = ss.str();
-            size_t pos = str.find_last_not_of('0');
-            if (pos != std::string::npos && str[pos] == '.')
-                pos--; // Keep one trailing zero after decimal point
-            str.erase(pos + 1);
-            // Clear and reset the stringstream
-            ss.str("");
-            ss << str;
-        }
+        // Six decimals with trailing zeros trimmed
+        numberformat::appendFixed(out, std::get<double>(data));
         break;
 
     case Type::BOOL:
-        ss << (std::get<bool>(data) ? "true" : "false");
+        out += std::get<bool>(data) ? "true" : "false";
         break;
 
     case Type::CHAR:
-        ss << std::get<char>(data);
+        out += std::get<char>(data);
         break;
 
     case Type::STRING:
-        ss << std::get<std::string>(data);
+        out += std::get<std::string>(data);
         break;
 
     case Type::ARRAY:
         if (auto arr = std::get<std::shared_ptr<DynamicArray>>(data))
         {
-            // Assuming DynamicArray has a toString method
-            ss << arr->toString();
+            out += arr->toString();
         }
         else
         {
-            ss << "[]"; // Empty or null array
+            out += "[]"; // Empty or null array
         }
         break;
 
     case Type::NONE:
-        ss << "none";
+        out += "none";
         break;
     }
+}
 
-    return ss.str();
+/**
+ * @brief Concatenates the string forms of two values into one new string
+ */
+static Value concatenate(const Value &lhs, const Value &rhs)
+{
+    std::string text;
+    lhs.appendTo(text);
+    rhs.appendTo(text);
+    return Value(std::move(text));
 }
 
 // Operators
@@ -214,7 +249,7 @@ Value Value::operator+(const Value &rhs) const
     // String concatenation has highest precedence
     if (isString() || rhs.isString())
     {
-        return Value(toString() + rhs.toString());
+        return concatenate(*this, rhs);
     }
 
     // Array concatenation
@@ -244,7 +279,7 @@ Value Value::operator+(const Value &rhs) const
         else if (rhs.isChar())
             right = static_cast<int>(rhs.asChar());
         else
-            return Value(toString() + rhs.toString()); // Fallback to string concat
+            return concatenate(*this, rhs); // Fallback to string concat
 
         return Value(left + right);
     }
@@ -256,7 +291,7 @@ Value Value::operator+(const Value &rhs) const
     }
 
     // Fallback - stringify both and concatenate
-    return Value(toString() + rhs.toString());
+    return concatenate(*this, rhs);
 }
 
 // Stream output operator
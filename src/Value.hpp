@@ -9,6 +9,7 @@
 
 // Forward declaration
 class DynamicArray;
+enum class MemoryCategory;
 
 class Value
 {
@@ -31,6 +32,7 @@ public:
     Value(bool v);
     Value(char v);
     Value(const std::string &v);
+    Value(std::string &&v);
     Value(std::shared_ptr<DynamicArray> arr);
 
     // Copy/move
@@ -38,6 +40,13 @@ public:
     Value(Value &&) noexcept;
     Value &operator=(const Value &);
     Value &operator=(Value &&) noexcept;
+    ~Value()
+    {
+        if (type == Type::STRING)
+        {
+            releasePayload();
+        }
+    }
 
     // Type info
     Type getType() const;
@@ -73,6 +82,7 @@ public:
 
     // String conversion
     std::string toString() const;
+    void appendTo(std::string &out) const; // Appends toString() without a temporary
 
     // Operators
     Value operator+(const Value &rhs) const;
@@ -81,6 +91,10 @@ public:
     friend std::ostream &operator<<(std::ostream &os, const Value &v);
 
 private:
+    // Reports a string payload to MemoryStats (track is allocate or release)
+    void trackPayload(void (*track)(MemoryCategory, std::size_t)) const;
+    void releasePayload() const;
+
     Type type;
     std::variant<
         int,
@@ -0,0 +1,125 @@
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+
+thread_local WorkStealingPool *WorkStealingPool::currentPool = nullptr;
+thread_local std::size_t WorkStealingPool::currentIndex = 0;
+
+WorkStealingPool::WorkStealingPool(std::size_t threads)
+{
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (std::size_t i = 0; i < threads; i++)
+    {
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    }
+    for (std::size_t i = 0; i < threads; i++)
+    {
+        workers.emplace_back(&WorkStealingPool::run, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    std::size_t index = currentPool == this ? currentIndex
+                                            : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        unfinished++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // Counted under stateMutex so an idle worker cannot miss it
+        std::lock_guard<std::mutex> lock(stateMutex);
+        queued.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake.notify_one();
+}
+
+void WorkStealingPool::wait()
+{
+    std::unique_lock<std::mutex> lock(stateMutex);
+    idle.wait(lock, [this]
+              { return unfinished == 0; });
+}
+
+bool WorkStealingPool::popLocal(std::size_t index, Task &task)
+{
+    Queue &queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(std::size_t index, Task &task)
+{
+    for (std::size_t offset = 1; offset < queues.size(); offset++)
+    {
+        Queue &victim = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(std::size_t index)
+{
+    currentPool = this;
+    currentIndex = index;
+
+    while (true)
+    {
+        Task task;
+        if (popLocal(index, task) || steal(index, task))
+        {
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            task();
+
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (--unfinished == 0)
+            {
+                idle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(stateMutex);
+        wake.wait(lock, [this]
+                  { return stopping || queued.load(std::memory_order_relaxed) > 0; });
+        if (stopping && queued.load(std::memory_order_relaxed) <= 0)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed set of threads running tasks from per-thread queues
+ *
+ * Each worker owns a queue. It takes its own tasks newest first, and when
+ * the queue is empty steals the oldest task from another worker's queue.
+ * Tasks of very different lengths therefore still keep every thread busy
+ * until the work runs out. Tasks submitted from outside the pool are dealt
+ * out round-robin; tasks submitted by a running task go to its own worker's
+ * queue.
+ *
+ * Each queue has its own lock, held only to push or pop, so workers touch
+ * a shared lock only when they steal, go idle or finish a task.
+ */
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @param threads Worker count; 0 means one per hardware thread
+     */
+    explicit WorkStealingPool(std::size_t threads = 0);
+
+    /**
+     * @brief Waits for the submitted tasks, then stops the workers
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    void submit(Task task);
+
+    /**
+     * @brief Blocks until every task submitted so far has finished
+     *
+     * Tasks must not throw; an exception escaping a task ends the process.
+     */
+    void wait();
+
+    std::size_t getThreadCount() const { return workers.size(); }
+
+    // Tasks taken from another worker's queue so far
+    unsigned long long getStealCount() const { return steals.load(std::memory_order_relaxed); }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run(std::size_t index);
+    bool popLocal(std::size_t index, Task &task);
+    bool steal(std::size_t index, Task &task);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex stateMutex;
+    std::condition_variable wake; // Signals idle workers
+    std::condition_variable idle; // Signals wait()
+    std::size_t unfinished = 0;   // Guarded by stateMutex
+    bool stopping = false;        // Guarded by stateMutex
+
+    std::atomic<long> queued{0}; // Tasks in some queue, not yet taken
+    std::atomic<std::size_t> nextQueue{0};
+    std::atomic<unsigned long long> steals{0};
+
+    // The pool and queue of the worker running on this thread, if any
+    static thread_local WorkStealingPool *currentPool;
+    static thread_local std::size_t currentIndex;
+};
+
+#endif // WORK_STEALING_POOL_HPP
@@ -1,17 +1,83 @@
 #include <algorithm>
-#include <sstream>
 
 #include "dynamic_array.hpp"
 #include "ErrorHandler.hpp"
+#include "MemoryStats.hpp"
 #include "Value.hpp"
 
 DynamicArray::DynamicArray() = default;
 
-DynamicArray::DynamicArray(const std::vector<Value> &values) : elements(values) {}
+DynamicArray::DynamicArray(const std::vector<Value> &values) : elements(values)
+{
+    syncStorage();
+}
+
+DynamicArray::DynamicArray(std::vector<Value> &&values) : elements(std::move(values))
+{
+    syncStorage();
+}
+
+DynamicArray::DynamicArray(const DynamicArray &other) : elements(other.elements)
+{
+    syncStorage();
+}
+
+DynamicArray::DynamicArray(DynamicArray &&other) noexcept
+    : elements(std::move(other.elements)), accountedBytes(other.accountedBytes)
+{
+    other.accountedBytes = 0;
+}
+
+DynamicArray &DynamicArray::operator=(const DynamicArray &other)
+{
+    if (this != &other)
+    {
+        elements = other.elements;
+        syncStorage();
+    }
+    return *this;
+}
+
+DynamicArray &DynamicArray::operator=(DynamicArray &&other) noexcept
+{
+    if (this != &other)
+    {
+        MemoryStats::release(MemoryCategory::ARRAYS, accountedBytes);
+        elements = std::move(other.elements);
+        accountedBytes = other.accountedBytes;
+        other.accountedBytes = 0;
+    }
+    return *this;
+}
+
+DynamicArray::~DynamicArray()
+{
+    MemoryStats::release(MemoryCategory::ARRAYS, accountedBytes);
+}
+
+void DynamicArray::syncStorage()
+{
+    if (!MemoryStats::isEnabled())
+    {
+        return;
+    }
+
+    size_t bytes = elements.capacity() * sizeof(Value);
+    if (bytes > accountedBytes)
+    {
+        MemoryStats::allocate(MemoryCategory::ARRAYS, bytes - accountedBytes);
+    }
+    else
+    {
+        MemoryStats::release(MemoryCategory::ARRAYS, accountedBytes - bytes);
+    }
+    accountedBytes = bytes;
+}
 
 void DynamicArray::initialize(const std::vector<Value> &values)
 {
     elements = values;
+    syncStorage();
 }
 
 void DynamicArray::initializeRange(int start, int end)
@@ -26,6 +92,7 @@ void DynamicArray::initializeRange(int start, int end)
     {
         elements.push_back(Value(i));
     }
+    syncStorage();
 }
 
 void DynamicArray::initializeRepeat(const Value &value, int count)
@@ -37,6 +104,7 @@ void DynamicArray::initializeRepeat(const Value &value, int count)
 
     elements.clear();
     elements.resize(count, value);
+    syncStorage();
 }
 
 // Element access and manipulation
@@ -78,6 +146,7 @@ void DynamicArray::insertElement(int index, const Value &value)
     }
 
     elements.insert(elements.begin() + index, value);
+    syncStorage();
 }
 
 void DynamicArray::removeElement(int index)
@@ -96,6 +165,11 @@ size_t DynamicArray::getLength() const
     return elements.size();
 }
 
+const std::vector<Value> &DynamicArray::getElements() const
+{
+    return elements;
+}
+
 // Sorting
 void DynamicArray::sortAscending()
 {
@@ -141,6 +215,7 @@ void DynamicArray::sortDescending()
 void DynamicArray::append(const Value &value)
 {
     elements.push_back(value);
+    syncStorage();
 }
 
 void DynamicArray::concatenate(const DynamicArray &other)
@@ -153,6 +228,7 @@ void DynamicArray::concatenate(const DynamicArray &other)
     {
         elements.push_back(other.elements[i]);
     }
+    syncStorage();
 }
 
 void DynamicArray::clear()
@@ -237,19 +313,18 @@ DynamicArray DynamicArray::filter(std::function<bool(const Value &)> filterFunct
 // String representation
 std::string DynamicArray::toString() const
 {
-    std::stringstream ss;
-    ss << "[";
+    std::string str = "[";
 
     for (size_t i = 0; i < elements.size(); ++i)
     {
-        ss << elements[i].toString();
+        elements[i].appendTo(str);
 
         if (i < elements.size() - 1)
         {
-            ss << ", ";
+            str += ", ";
         }
     }
 
-    ss << "]";
-    return ss.str();
+    str += "]";
+    return str;
 }
\ No newline at end of file
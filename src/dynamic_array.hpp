@@ -17,6 +17,12 @@ class DynamicArray
 public:
     DynamicArray();
     DynamicArray(const std::vector<Value> &values);
+    DynamicArray(std::vector<Value> &&values);
+    DynamicArray(const DynamicArray &other);
+    DynamicArray(DynamicArray &&other) noexcept;
+    DynamicArray &operator=(const DynamicArray &other);
+    DynamicArray &operator=(DynamicArray &&other) noexcept;
+    ~DynamicArray();
 
     void initialize(const std::vector<Value> &values);
     void initializeRange(int start, int end); // Only for int/Value(int)
@@ -30,6 +36,9 @@ public:
 
     size_t getLength() const;
 
+    // Read-only access for native code that walks every element
+    const std::vector<Value> &getElements() const;
+
     void sortAscending();
     void sortDescending();
 
@@ -48,7 +57,12 @@ public:
     std::string toString() const;
 
 private:
+    // Brings the ARRAYS figure in MemoryStats up to date after elements
+    // may have been reallocated
+    void syncStorage();
+
     std::vector<Value> elements;
+    size_t accountedBytes = 0; // Element storage last reported to MemoryStats
 };
 
 #endif
\ No newline at end of file
@@ -16,92 +16,181 @@
 #include "Value.hpp"
 #include "dynamic_array.hpp"
 #include "ErrorHandler.hpp"
+#include "Log.hpp"
 #include "parser.hpp"
+#include "library/MathLibrary.hpp"
 
 namespace fs = std::filesystem;
 
-void Interpreter::initializeInterperterMaps()
+const Interpreter::ExecutorTable &Interpreter::nodeExecutors()
 {
-    nodeExecutors = {
+    static const ExecutorTable table = []
+    {
+        ExecutorTable executors{};
         // type literals
-        {NODE_INT_LITERAL, &Interpreter::evaluateIntLiteral},
-        {NODE_DOUBLE_LITERAL, &Interpreter::evaluateDoubleLiteral},
-        {NODE_CHAR_LITERAL, &Interpreter::evaluateCharLiteral},
-        {NODE_STRING_LITERAL, &Interpreter::evaluateStringLiteral},
-        {NODE_BOOL_LITERAL, &Interpreter::evaluateBoolLiteral},
+        executors[NODE_INT_LITERAL] = &Interpreter::evaluateIntLiteral;
+        executors[NODE_DOUBLE_LITERAL] = &Interpreter::evaluateDoubleLiteral;
+        executors[NODE_CHAR_LITERAL] = &Interpreter::evaluateCharLiteral;
+        executors[NODE_STRING_LITERAL] = &Interpreter::evaluateStringLiteral;
+        executors[NODE_BOOL_LITERAL] = &Interpreter::evaluateBoolLiteral;
         // Operators
-        {NODE_ADD, &Interpreter::evaluateAdd},
-        {NODE_SUBT, &Interpreter::evaluateSubt},
-        {NODE_MULT, &Interpreter::evaluateMult},
-        {NODE_DIVISION, &Interpreter::evaluateDiv},
-        {NODE_MODULUS, &Interpreter::evaluateMod},
-        {NODE_OPERATOR_DECREMENT, &Interpreter::evaluateDecrement},
-        {NODE_OPERATOR_INCREMENT, &Interpreter::evaluateIncrement},
+        executors[NODE_ADD] = &Interpreter::evaluateAdd;
+        executors[NODE_SUBT] = &Interpreter::evaluateSubt;
+        executors[NODE_MULT] = &Interpreter::evaluateMult;
+        executors[NODE_DIVISION] = &Interpreter::evaluateDiv;
+        executors[NODE_MODULUS] = &Interpreter::evaluateMod;
+        executors[NODE_OPERATOR_DECREMENT] = &Interpreter::evaluateDecrement;
+        executors[NODE_OPERATOR_INCREMENT] = &Interpreter::evaluateIncrement;
         // Input
-        {NODE_KEYWORD_INPUT, &Interpreter::executeInputStatement},
+        executors[NODE_KEYWORD_INPUT] = &Interpreter::executeInputStatement;
         // Comparison Ops
-        {NODE_NOT_EQUAL, &Interpreter::evaluateNotEqual},
-        {NODE_LESS_THAN, &Interpreter::evaluateLessThan},
-        {NODE_GREATER_THAN, &Interpreter::evaluateGreaterThan},
-        {NODE_LESS_EQUAL, &Interpreter::evaluateLessEqual},
+        executors[NODE_NOT_EQUAL] = &Interpreter::evaluateNotEqual;
+        executors[NODE_LESS_THAN] = &Interpreter::evaluateLessThan;
+        executors[NODE_GREATER_THAN] = &Interpreter::evaluateGreaterThan;
+        executors[NODE_LESS_EQUAL] = &Interpreter::evaluateLessEqual;
         // Newline
-        {NODE_NEWLINE, &Interpreter::evaluateNewLine},
+        executors[NODE_NEWLINE] = &Interpreter::evaluateNewLine;
         // Array Stuff
-        {NODE_ARRAY_DECLARATION, &Interpreter::evaluateArrayDecleration},
-        {NODE_ARRAY_REPEAT, &Interpreter::evaluateArrayRepeat},
-        {NODE_ARRAY_LENGTH, &Interpreter::evaluateArrayLength},
-        {NODE_ARRAY_ACCESS, &Interpreter::evaluateArrayAccess},
-        {NODE_ARRAY_ASSIGN, &Interpreter::evaluateArrayAssign},
-        {NODE_ARRAY_INIT, &Interpreter::evaluateArrayInit},
-        {NODE_ARRAY_RANGE, &Interpreter::evaluateArrayRange},
-        {NODE_ARRAY_INSERT, &Interpreter::evaluateArrayInsert},
-        {NODE_ARRAY_REMOVE, &Interpreter::evaluateArrayRemove},
-        {NODE_DOT, &Interpreter::evaluateArrayIndexMod},
-        {NODE_ARRAY_SORT_ASC, &Interpreter::evaluateArraySortAsc},
-        {NODE_ARRAY_SORT_DESC, &Interpreter::evaluateArraySortDesc},
-
-        {NODE_FUNCTION_CALL, &Interpreter::evaluateFunctionCall},
-        {NODE_PAREN_EXPR, &Interpreter::evaluateParenExpr},
-    };
+        executors[NODE_ARRAY_DECLARATION] = &Interpreter::evaluateArrayDecleration;
+        executors[NODE_ARRAY_REPEAT] = &Interpreter::evaluateArrayRepeat;
+        executors[NODE_ARRAY_LENGTH] = &Interpreter::evaluateArrayLength;
+        executors[NODE_ARRAY_ACCESS] = &Interpreter::evaluateArrayAccess;
+        executors[NODE_ARRAY_ASSIGN] = &Interpreter::evaluateArrayAssign;
+        executors[NODE_ARRAY_INIT] = &Interpreter::evaluateArrayInit;
+        executors[NODE_ARRAY_RANGE] = &Interpreter::evaluateArrayRange;
+        executors[NODE_ARRAY_INSERT] = &Interpreter::evaluateArrayInsert;
+        executors[NODE_ARRAY_REMOVE] = &Interpreter::evaluateArrayRemove;
+        executors[NODE_DOT] = &Interpreter::evaluateArrayIndexMod;
+        executors[NODE_ARRAY_SORT_ASC] = &Interpreter::evaluateArraySortAsc;
+        executors[NODE_ARRAY_SORT_DESC] = &Interpreter::evaluateArraySortDesc;
+
+        executors[NODE_FUNCTION_CALL] = &Interpreter::evaluateFunctionCall;
+        executors[NODE_PAREN_EXPR] = &Interpreter::evaluateParenExpr;
+
+        return executors;
+    }();
+    return table;
+}
 
-    standardLib = {
-        {"randomInt", &Interpreter::evaluateRandomInt},
-        {"coinFlip", &Interpreter::evaluateCoinFlip},
-        {"diceRoll", &Interpreter::evaluateDiceRoll},
-        {"generatePin", &Interpreter::evaluateGeneratePin},
-        {"sqrt", &Interpreter::evaluateSQRT},
-        {"abs", &Interpreter::evaluateABS},
-        {"pow", &Interpreter::evaluatePOW},
-        {"min", &Interpreter::evaluateMIN},
-        {"max", &Interpreter::evaluateMAX},
-        {"ceil", &Interpreter::evaluateCEIL},
-        {"floor", &Interpreter::evaluateFLOOR},
-    };
+/**
+ * @brief Registers a builtin and returns its id
+ */
+int Interpreter::BuiltinRegistry::add(const std::string &name, standardLibrary function)
+{
+    int id = static_cast<int>(functions.size());
+    functions.push_back(function);
+    ids[name] = id;
+    return id;
+}
+
+int Interpreter::BuiltinRegistry::find(const std::string &name) const
+{
+    auto it = ids.find(name);
+    return it != ids.end() ? it->second : -1;
 }
 
 /**
- * @brief Sets up the output file for the interpreter
- *
- * Creates a directory for output files if it doesn't exist and
- * opens a new file with a timestamp in the filename.
+ * @brief The process-wide builtin table; add new builtins here
  */
-void Interpreter::setupOutputFile()
+const Interpreter::BuiltinRegistry &Interpreter::builtinRegistry()
 {
-    fs::create_directories("output");
+    static const BuiltinRegistry registry = []
+    {
+        BuiltinRegistry builtins;
+        // Random library
+        builtins.add("randomInt", &Interpreter::evaluateRandomInt);
+        builtins.add("coinFlip", &Interpreter::evaluateCoinFlip);
+        builtins.add("diceRoll", &Interpreter::evaluateDiceRoll);
+        builtins.add("generatePin", &Interpreter::evaluateGeneratePin);
+        // Math library
+        builtins.add("sqrt", &Interpreter::evaluateSQRT);
+        builtins.add("abs", &Interpreter::evaluateABS);
+        builtins.add("pow", &Interpreter::evaluatePOW);
+        builtins.add("min", &Interpreter::evaluateMIN);
+        builtins.add("max", &Interpreter::evaluateMAX);
+        builtins.add("ceil", &Interpreter::evaluateCEIL);
+        builtins.add("floor", &Interpreter::evaluateFLOOR);
+        return builtins;
+    }();
+    return registry;
+}
+
+void Interpreter::resolveBuiltinCalls(AST_NODE *node)
+{
+    if (node == nullptr)
+    {
+        return;
+    }
+
+    if (node->TYPE == NODE_FUNCTION_CALL)
+    {
+        node->BUILTIN_ID = static_cast<std::int16_t>(builtinRegistry().find(node->VALUE));
+    }
+
+    resolveBuiltinCalls(node->CHILD);
+    for (AST_NODE *sub : node->SUB_STATEMENTS)
+    {
+        resolveBuiltinCalls(sub);
+    }
+}
+
+void Interpreter::collectFunctions(AST_NODE *node, FunctionTable &table)
+{
+    if (node == nullptr)
+    {
+        return;
+    }
+
+    // Same walk as findFunctionByName(), so the first declaration of a name wins
+    if (node->TYPE == NODE_FUNCTION_DECLERATION)
+    {
+        table.emplace(node->VALUE, node);
+    }
+
+    for (AST_NODE *sub : node->SUB_STATEMENTS)
+    {
+        if (sub->TYPE == NODE_READ_HEADER && sub->CHILD)
+        {
+            collectFunctions(sub->CHILD, table);
+        }
+        else
+        {
+            collectFunctions(sub, table);
+        }
+    }
+
+    collectFunctions(node->CHILD, table);
+}
 
-    auto now = std::chrono::system_clock::now();
-    std::time_t timeNow = std::chrono::system_clock::to_time_t(now);
+void Interpreter::reset()
+{
+    variables.clear();
+    returnValue = Value();
+    functionReturnValues.clear();
+}
 
-    std::stringstream ss;
-    ss << "../output/output_" << std::put_time(std::localtime(&timeNow), "%Y-%m-%d_%H-%M-%S") << ".txt";
-    std::string filename = ss.str();
+const Value *Interpreter::findVariable(const std::string &name) const
+{
+    auto it = variables.find(name);
+    return it != variables.end() ? &it->second : nullptr;
+}
 
-    outputFile.open(filename);
-    if (!outputFile.is_open())
+/**
+ * @brief Sets up the output file for the interpreter
+ *
+ * Output goes to the console and to a new file with a timestamp in its
+ * name, in a directory that is created if it doesn't exist.
+ */
+void Interpreter::setupOutputFile()
+{
+    OutputConfig config;
+    std::string error;
+    if (!OutputConfig::parse(OutputConfig::DEFAULT_SPEC, config, error))
     {
-        std::cerr << "Failed to create output file: " << filename << std::endl;
+        std::cerr << error << std::endl;
         std::exit(1);
     }
+    output.open(config);
 }
 
 /**
@@ -128,7 +217,21 @@ void Interpreter::execute()
         // exit(1);
         ErrorHandler::getInstance().reportSemanticError("No 'begin' block found in program.");
     }
-    executeNode(beginBlock);
+
+    // Bind builtin calls once so each call dispatches without a name lookup;
+    // a prepared program was bound when it was compiled
+    if (functions == nullptr)
+    {
+        resolveBuiltinCalls(root);
+    }
+    {
+        Profiler::ProcScope programScope(profiler, "begin");
+        ShadowStack::Scope programFrame(shadowStack, beginBlock, ShadowStack::Kind::PROC);
+        executeNode(beginBlock);
+    }
+
+    // Deliver program output before any summary printed by the caller
+    output.flush();
 }
 
 /**
@@ -142,10 +245,14 @@ Value Interpreter::evaluateExpression(AST_NODE *node)
     if (!node)
         return Value(0);
 
-    auto it = nodeExecutors.find(node->TYPE);
-    if (it != nodeExecutors.end())
+    if (profiler)
     {
-        return (this->*(it->second))(node);
+        profiler->countNode(node->TYPE);
+    }
+
+    if (evaluatorFunction executor = nodeExecutors()[node->TYPE])
+    {
+        return (this->*executor)(node);
     }
 
     if (node->TYPE == NODE_IDENTIFIER)
@@ -155,11 +262,11 @@ Value Interpreter::evaluateExpression(AST_NODE *node)
         {
             return varIt->second;
         }
-        ErrorHandler::getInstance().reportSemanticError("Undefined variables: '" + node->VALUE + "'");
+        ErrorHandler::getInstance().reportSemanticError("Undefined variables: '" + node->VALUE + "'", node->LOCATION);
         return Value(0);
     }
 
-    ErrorHandler::getInstance().reportSemanticError("Unexpected expression of type: '" + getNodeTypeName(node->TYPE) + "'");
+    ErrorHandler::getInstance().reportSemanticError("Unexpected expression of type: '" + getNodeTypeName(node->TYPE) + "'", node->LOCATION);
     return Value(0);
 }
 
@@ -229,7 +336,7 @@ void Interpreter::executeStatement(AST_NODE *node)
         }
         else
         {
-            std::cout << "EMPTY PRINT" << std::endl;
+            MINILANG_LOG_WARN("Empty print statement");
         }
         break;
     case NODE_ARRAY_DECLARATION:
@@ -243,7 +350,7 @@ void Interpreter::executeStatement(AST_NODE *node)
     default:
         // std::cerr << "Unknown Statement Type: " << getNodeTypeName(node->TYPE) << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSemanticError("Unknown Statement Type: " + getNodeTypeName(node->TYPE));
+        ErrorHandler::getInstance().reportSemanticError("Unknown Statement Type: " + getNodeTypeName(node->TYPE), node->LOCATION);
     }
 }
 
@@ -257,10 +364,14 @@ void Interpreter::executeNode(AST_NODE *node)
     if (!node)
         return;
 
-    std::cout << "DEBUG: executeNode called with node type: " << getNodeTypeName(node->TYPE) << std::endl;
-    if (!node->VALUE.empty())
+    MINILANG_LOG_TRACE("executeNode called with node type: " << getNodeTypeName(node->TYPE)
+                       << (node->VALUE.empty() ? "" : ", value: ") << node->VALUE);
+
+    Profiler::StatementScope statementScope(profiler, node);
+    ShadowStack::Scope statementFrame(shadowStack, node, ShadowStack::Kind::STATEMENT);
+    if (profiler)
     {
-        std::cout << "DEBUG: Node value: " << node->VALUE << std::endl;
+        profiler->countNode(node->TYPE);
     }
     switch (node->TYPE)
     {
@@ -423,7 +534,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "ERROR: decrement operator requires exactly one operand" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError("Decrement operator requires exactly one operand.");
+            ErrorHandler::getInstance().reportSemanticError("Decrement operator requires exactly one operand.", node->LOCATION);
         }
 
         // Get the operand (should be an identifier)
@@ -432,7 +543,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "ERROR: decrement operator can only be applied to variables" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError("Decrement operator can only be applied to variables.");
+            ErrorHandler::getInstance().reportSemanticError("Decrement operator can only be applied to variables.", node->LOCATION);
         }
 
         // Get the variable name
@@ -441,7 +552,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "ERROR: Undefined variable '" << varName << "'" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError("Undefined variable '" + varName + "'");
+            ErrorHandler::getInstance().reportSemanticError("Undefined variable '" + varName + "'", node->LOCATION);
         }
 
         // Decrement the value based on its type
@@ -454,7 +565,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "ERROR: Increment operator requires exactly one operand" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError("Increment operator requires exactly one operand.");
+            ErrorHandler::getInstance().reportSemanticError("Increment operator requires exactly one operand.", node->LOCATION);
         }
 
         // Get the operand (should be an identifier)
@@ -463,7 +574,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "ERROR: Increment operator can only be applied to variables" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError("Increment operator can only be applied to variables.");
+            ErrorHandler::getInstance().reportSemanticError("Increment operator can only be applied to variables.", node->LOCATION);
         }
 
         // Get the variable name
@@ -472,7 +583,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "ERROR: Undefined variable '" << varName << "'" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError("Undefined variable: '" + varName + "'");
+            ErrorHandler::getInstance().reportSemanticError("Undefined variable: '" + varName + "'", node->LOCATION);
         }
 
         // Increment the value based on its type
@@ -491,7 +602,7 @@ void Interpreter::executeNode(AST_NODE *node)
             {
                 // std::cerr << "ERROR: Undefined Variable '" << node->VALUE << "'" << std::endl;
                 // exit(1);
-                ErrorHandler::getInstance().reportSemanticError("Undefined variable '" + node->VALUE + "'");
+                ErrorHandler::getInstance().reportSemanticError("Undefined variable '" + node->VALUE + "'", node->LOCATION);
             }
 
             variables[varName] = result;
@@ -503,18 +614,14 @@ void Interpreter::executeNode(AST_NODE *node)
             {
                 // std::cerr << "ERROR: Undefined Variable '" << varName << "'" << std::endl;
                 // exit(1);
-                ErrorHandler::getInstance().reportSemanticError("Undefined variable: '" + varName + "'");
+                ErrorHandler::getInstance().reportSemanticError("Undefined variable: '" + varName + "'", node->LOCATION);
             }
         }
         break;
     }
     case NODE_NEWLINE:
         // Print a newline to both console and output file
-        std::cout << std::endl;
-        if (outputFile.is_open())
-        {
-            outputFile << std::endl;
-        }
+        output.write('\n');
         break;
     case NODE_PRINT:
         if (node->CHILD)
@@ -524,7 +631,7 @@ void Interpreter::executeNode(AST_NODE *node)
         }
         else
         {
-            std::cout << "EMPTY PRINT STATEMENT" << std::endl;
+            MINILANG_LOG_WARN("Empty print statement");
         }
         break;
     case NODE_PAREN_EXPR:
@@ -550,7 +657,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "Error: " << arrayName << " is not an array" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.");
+            ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.", node->LOCATION);
         }
 
         int index = evaluateExpression(node->SUB_STATEMENTS[0]).asInt();
@@ -565,7 +672,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "Error: Array index out of bounds" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError("Array index out of bounds.");
+            ErrorHandler::getInstance().reportSemanticError("Array index out of bounds.", node->LOCATION);
         }
         break;
     }
@@ -603,7 +710,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "Error: Repeat requires value and count" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError("Repeat requires value and count.");
+            ErrorHandler::getInstance().reportSemanticError("Repeat requires value and count.", node->LOCATION);
         }
 
         Value value = evaluateExpression(node->SUB_STATEMENTS[0]);
@@ -628,7 +735,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "Error: " << arrayName << " is not an array" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.");
+            ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.", node->LOCATION);
         }
 
         // FIX: index is in node->CHILD, not SUB_STATEMENTS[0]
@@ -644,7 +751,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "Error: Invalid array index for insertion" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError("Invalid array index for insertion.");
+            ErrorHandler::getInstance().reportSemanticError("Invalid array index for insertion.", node->LOCATION);
         }
         break;
     }
@@ -655,7 +762,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "Error: " << arrayName << " is not an array" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.");
+            ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.", node->LOCATION);
         }
 
         int index = evaluateExpression(node->CHILD).asInt();
@@ -669,7 +776,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "Error: Array index out of bounds" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError("Array index out of bounds.");
+            ErrorHandler::getInstance().reportSemanticError("Array index out of bounds.", node->LOCATION);
         }
         break;
     }
@@ -680,7 +787,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "Error: " << arrayName << " is not an array" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.");
+            ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.", node->LOCATION);
         }
 
         auto array = variables[arrayName].asArray();
@@ -694,7 +801,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "Error: " << arrayName << " is not an array" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.");
+            ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.", node->LOCATION);
         }
 
         auto array = variables[arrayName].asArray();
@@ -714,7 +821,7 @@ void Interpreter::executeNode(AST_NODE *node)
         {
             // std::cerr << "Error: few too many arguments for loop structure";
             // exit(1);
-            ErrorHandler::getInstance().reportSemanticError("Few too many arguments for loop structure.");
+            ErrorHandler::getInstance().reportSemanticError("Few too many arguments for loop structure.", node->LOCATION);
         }
 
         AST_NODE *initNode = args->SUB_STATEMENTS[0];
@@ -803,9 +910,8 @@ void Interpreter::executeNode(AST_NODE *node)
         AST_NODE *funcDef = findFunctionByName(funcName);
         if (!funcDef)
         {
-            // std::cerr << "Undefined function: " << funcName << std::endl;
-            // exit(1);
-            ErrorHandler::getInstance().reportSemanticError("Undefined function: '" + funcName + "'");
+            // Does not return: the call has nothing to execute
+            ErrorHandler::getInstance().reportRuntimeError("Undefined function: '" + funcName + "'", node->LOCATION);
         }
 
         // Create a new scope for function parameters
@@ -817,9 +923,7 @@ void Interpreter::executeNode(AST_NODE *node)
         // Make sure params exists and is the right type
         if (!params || params->TYPE != NODE_FUNCTION_PARAMS)
         {
-            // std::cerr << "Error: Function " << funcName << " has invalid parameter list" << std::endl;
-            // exit(1);
-            ErrorHandler::getInstance().reportSemanticError("Function: '" + funcName + "' has invalid parameter list.");
+            ErrorHandler::getInstance().reportRuntimeError("Function: '" + funcName + "' has invalid parameter list.", node->LOCATION);
         }
 
         for (size_t i = 0; i < node->SUB_STATEMENTS.size() && i < params->SUB_STATEMENTS.size(); i++)
@@ -872,10 +976,7 @@ void Interpreter::executeNode(AST_NODE *node)
         evaluateExpression(node);
         break;
     case NODE_NEWLINE_SYMBOL:
-        if (outputFile.is_open())
-        {
-            outputFile << std::endl;
-        }
+        output.writeToLog("\n");
         break;
     case NODE_NOT_EQUAL:
         evaluateExpression(node);
@@ -888,7 +989,7 @@ void Interpreter::executeNode(AST_NODE *node)
         }
         else
         {
-            std::cout << "EMPTY RESULT STATEMENT" << std::endl;
+            MINILANG_LOG_WARN("Empty result statement");
             setReturnValue(Value(0));
         }
         break;
@@ -898,7 +999,7 @@ void Interpreter::executeNode(AST_NODE *node)
     default:
         // std::cerr << "Interpretation Error: Unknown node type: " << getNodeTypeName(node->TYPE) << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSemanticError("Unknown node type: '" + getNodeTypeName(node->TYPE) + "'");
+        ErrorHandler::getInstance().reportSemanticError("Unknown node type: '" + getNodeTypeName(node->TYPE) + "'", node->LOCATION);
     }
 }
 
@@ -911,6 +1012,12 @@ void Interpreter::executeNode(AST_NODE *node)
 
 AST_NODE *Interpreter::findFunctionByName(const std::string &name)
 {
+    if (functions != nullptr)
+    {
+        auto it = functions->find(name);
+        return it != functions->end() ? it->second : nullptr;
+    }
+
     // Helper function for recursive search
     std::function<AST_NODE *(AST_NODE *)> searchNodeForFunction =
         [&](AST_NODE *node) -> AST_NODE *
@@ -990,7 +1097,7 @@ void Interpreter::evaluateImport(AST_NODE *node)
 
     if (!libraryManager.loadLibrary(libraryName))
     {
-        ErrorHandler::getInstance().reportRuntimeError("Failed to load library: " + libraryName);
+        ErrorHandler::getInstance().reportRuntimeError("Failed to load library: " + libraryName, node->LOCATION);
     }
 }
 
@@ -998,7 +1105,7 @@ Value Interpreter::evaluateRandomInt(AST_NODE *node)
 {
     if (node->SUB_STATEMENTS.size() < 2)
     {
-        ErrorHandler::getInstance().reportRuntimeError("randomInt requires two arguments: min and max.");
+        ErrorHandler::getInstance().reportRuntimeError("randomInt requires two arguments: min and max.", node->LOCATION);
         return Value(0);
     }
 
@@ -1010,7 +1117,7 @@ Value Interpreter::evaluateRandomInt(AST_NODE *node)
 
     if (min > max)
     {
-        ErrorHandler::getInstance().reportRuntimeError("randomInt: min must be less than or equal to max.");
+        ErrorHandler::getInstance().reportRuntimeError("randomInt: min must be less than or equal to max.", node->LOCATION);
         std::swap(min, max);
     }
 
@@ -1043,12 +1150,12 @@ Value Interpreter::evaluateDiceRoll(AST_NODE *node)
 
         if (sides < 6)
         {
-            ErrorHandler::getInstance().reportRuntimeError("diceRoll: Minimum number of sides is 6.");
+            ErrorHandler::getInstance().reportRuntimeError("diceRoll: Minimum number of sides is 6.", node->LOCATION);
             sides = 6;
         }
         else if (sides > 20)
         {
-            ErrorHandler::getInstance().reportRuntimeError("diceRoll: Maximum number of sides is 20.");
+            ErrorHandler::getInstance().reportRuntimeError("diceRoll: Maximum number of sides is 20.", node->LOCATION);
             sides = 20;
         }
     }
@@ -1072,12 +1179,12 @@ Value Interpreter::evaluateGeneratePin(AST_NODE *node)
 
         if (digits < 1)
         {
-            ErrorHandler::getInstance().reportRuntimeError("generatePin: Minimum number of digits is 1.");
+            ErrorHandler::getInstance().reportRuntimeError("generatePin: Minimum number of digits is 1.", node->LOCATION);
             digits = 1;
         }
         else if (digits > 100)
         {
-            ErrorHandler::getInstance().reportRuntimeError("generatePin: Maximum number of digits is 100.");
+            ErrorHandler::getInstance().reportRuntimeError("generatePin: Maximum number of digits is 100.", node->LOCATION);
             digits = 100;
         }
     }
@@ -1095,150 +1202,161 @@ Value Interpreter::evaluateGeneratePin(AST_NODE *node)
     return Value(pin);
 }
 
+/**
+ * @brief Reports a failed Math library call
+ * @param notNumeric Message for a non-numeric argument
+ * @param node The call, whose location prefixes the message
+ */
+static void reportMathError(mathlib::Status status, const std::string &function, const std::string &notNumeric,
+                            const AST_NODE *node)
+{
+    if (status == mathlib::Status::LENGTH_MISMATCH)
+    {
+        ErrorHandler::getInstance().reportRuntimeError(function + ": Array arguments must have the same length.", node->LOCATION);
+    }
+    else
+    {
+        ErrorHandler::getInstance().reportRuntimeError(notNumeric, node->LOCATION);
+    }
+}
+
+// Math library: each accepts numbers or arrays of numbers (see MathLibrary.hpp)
 Value Interpreter::evaluateABS(AST_NODE *node)
 {
     if (node->SUB_STATEMENTS.empty())
     {
-        ErrorHandler::getInstance().reportRuntimeError("abs: Must have value to evaluate absolute.");
+        ErrorHandler::getInstance().reportRuntimeError("abs: Must have value to evaluate absolute.", node->LOCATION);
         return Value(0);
     }
 
     Value absVal = evaluateExpression(node->SUB_STATEMENTS[0]);
 
-    if (absVal.isNumeric())
+    Value result;
+    mathlib::Status status = mathlib::apply(mathlib::UnaryOp::ABS, absVal, result);
+    if (status != mathlib::Status::OK)
     {
-        return Value(std::abs(absVal.asDoubleSafe()));
-    }
-    else
-    {
-        std::stringstream errorMsg;
-        ErrorHandler::getInstance().reportRuntimeError("abs: Expected numeric value.");
+        reportMathError(status, "abs", "abs: Expected numeric value.", node);
         return Value(0);
     }
+    return result;
 }
 Value Interpreter::evaluateSQRT(AST_NODE *node)
 {
     if (node->SUB_STATEMENTS.empty())
     {
-        ErrorHandler::getInstance().reportRuntimeError("sqrt: Must have value to evaluate square root.");
+        ErrorHandler::getInstance().reportRuntimeError("sqrt: Must have value to evaluate square root.", node->LOCATION);
         return Value(0);
     }
 
     Value sqrtVal = evaluateExpression(node->SUB_STATEMENTS[0]);
 
-    if (sqrtVal.isNumeric())
+    Value result;
+    mathlib::Status status = mathlib::apply(mathlib::UnaryOp::SQRT, sqrtVal, result);
+    if (status != mathlib::Status::OK)
     {
-        return Value(std::sqrt(sqrtVal.asDoubleSafe()));
-    }
-    else
-    {
-        ErrorHandler::getInstance().reportRuntimeError("sqrt: Expected numerical value.");
+        reportMathError(status, "sqrt", "sqrt: Expected numerical value.", node);
         return Value(0);
     }
+    return result;
 }
 Value Interpreter::evaluatePOW(AST_NODE *node)
 {
     if (node->SUB_STATEMENTS.size() != 2)
     {
-        ErrorHandler::getInstance().reportRuntimeError("pow: Expected two values to evaluate power.");
+        ErrorHandler::getInstance().reportRuntimeError("pow: Expected two values to evaluate power.", node->LOCATION);
         return Value(0);
     }
 
     Value base = evaluateExpression(node->SUB_STATEMENTS[0]);
     Value exponent = evaluateExpression(node->SUB_STATEMENTS[1]);
 
-    if (base.isNumeric() && exponent.isNumeric())
+    Value result;
+    mathlib::Status status = mathlib::apply(mathlib::BinaryOp::POW, base, exponent, result);
+    if (status != mathlib::Status::OK)
     {
-        return Value(std::pow(base.asDoubleSafe(), exponent.asDoubleSafe()));
-    }
-    else
-    {
-        ErrorHandler::getInstance().reportRuntimeError("pow: Expected numerical values.");
+        reportMathError(status, "pow", "pow: Expected numerical values.", node);
         return Value(0);
     }
+    return result;
 }
 Value Interpreter::evaluateMIN(AST_NODE *node)
 {
     if (node->SUB_STATEMENTS.size() != 2)
     {
-        ErrorHandler::getInstance().reportRuntimeError("min: Expected two values to compare.");
+        ErrorHandler::getInstance().reportRuntimeError("min: Expected two values to compare.", node->LOCATION);
         return Value(0);
     }
 
     Value a = evaluateExpression(node->SUB_STATEMENTS[0]);
     Value b = evaluateExpression(node->SUB_STATEMENTS[1]);
 
-    if (a.isNumeric() && b.isNumeric())
+    Value result;
+    mathlib::Status status = mathlib::apply(mathlib::BinaryOp::MIN, a, b, result);
+    if (status != mathlib::Status::OK)
     {
-        return Value(std::min(a.asDoubleSafe(), b.asDoubleSafe()));
-    }
-    else
-    {
-        ErrorHandler::getInstance().reportRuntimeError("min: Expected numerical values.");
+        reportMathError(status, "min", "min: Expected numerical values.", node);
         return Value(0);
     }
+    return result;
 }
 Value Interpreter::evaluateMAX(AST_NODE *node)
 {
     if (node->SUB_STATEMENTS.size() != 2)
     {
-        ErrorHandler::getInstance().reportRuntimeError("max: Expected two values to evaluate max.");
+        ErrorHandler::getInstance().reportRuntimeError("max: Expected two values to evaluate max.", node->LOCATION);
         return Value(0);
     }
 
     Value a = evaluateExpression(node->SUB_STATEMENTS[0]);
     Value b = evaluateExpression(node->SUB_STATEMENTS[1]);
 
-    if (a.isNumeric() && b.isNumeric())
-    {
-        return Value(std::max(a.asDoubleSafe(), b.asDoubleSafe()));
-    }
-    else
+    Value result;
+    mathlib::Status status = mathlib::apply(mathlib::BinaryOp::MAX, a, b, result);
+    if (status != mathlib::Status::OK)
     {
-        ErrorHandler::getInstance().reportRuntimeError("max: Expected two numerical values.");
+        reportMathError(status, "max", "max: Expected two numerical values.", node);
         return Value(0);
     }
+    return result;
 }
 
 Value Interpreter::evaluateCEIL(AST_NODE *node)
 {
     if (node->SUB_STATEMENTS.empty())
     {
-        ErrorHandler::getInstance().reportRuntimeError("ceil: Expeceted a numerical value for param.");
+        ErrorHandler::getInstance().reportRuntimeError("ceil: Expeceted a numerical value for param.", node->LOCATION);
         return Value(0);
     }
 
     Value value = evaluateExpression(node->SUB_STATEMENTS[0]);
 
-    if (value.isNumeric())
-    {
-        return Value(std::ceil(value.asDoubleSafe()));
-    }
-    else
+    Value result;
+    mathlib::Status status = mathlib::apply(mathlib::UnaryOp::CEIL, value, result);
+    if (status != mathlib::Status::OK)
     {
-        ErrorHandler::getInstance().reportRuntimeError("ceil: Expected a numeric value to calculate ceiling.");
+        reportMathError(status, "ceil", "ceil: Expected a numeric value to calculate ceiling.", node);
         return Value(0);
     }
+    return result;
 }
 Value Interpreter::evaluateFLOOR(AST_NODE *node)
 {
     if (node->SUB_STATEMENTS.empty())
     {
-        ErrorHandler::getInstance().reportRuntimeError("floor: Expeceted a numerical value for param.");
+        ErrorHandler::getInstance().reportRuntimeError("floor: Expeceted a numerical value for param.", node->LOCATION);
         return Value(0);
     }
 
     Value value = evaluateExpression(node->SUB_STATEMENTS[0]);
 
-    if (value.isNumeric())
+    Value result;
+    mathlib::Status status = mathlib::apply(mathlib::UnaryOp::FLOOR, value, result);
+    if (status != mathlib::Status::OK)
     {
-        return Value(std::floor(value.asDoubleSafe()));
-    }
-    else
-    {
-        ErrorHandler::getInstance().reportRuntimeError("floor: Expected a numeric value to calculate floor.");
+        reportMathError(status, "floor", "floor: Expected a numeric value to calculate floor.", node);
         return Value(0);
     }
+    return result;
 }
 
 // Type Literals
@@ -1271,7 +1389,7 @@ Value Interpreter::evaluateSubt(AST_NODE *node)
         }
         else
         {
-            ErrorHandler::getInstance().reportSemanticError("Cannot negate non-numeric value.");
+            ErrorHandler::getInstance().reportSemanticError("Cannot negate non-numeric value.", node->LOCATION);
             return Value(0);
         }
     }
@@ -1289,7 +1407,7 @@ Value Interpreter::evaluateSubt(AST_NODE *node)
         }
         else
         {
-            ErrorHandler::getInstance().reportSemanticError("Cannot perform subtraction on non numeric values.");
+            ErrorHandler::getInstance().reportSemanticError("Cannot perform subtraction on non numeric values.", node->LOCATION);
             return Value(0);
         }
     }
@@ -1311,7 +1429,7 @@ Value Interpreter::evaluateMult(AST_NODE *node)
         }
         else
         {
-            ErrorHandler::getInstance().reportSemanticError("Cannot perform multiplication on non-numeric values.");
+            ErrorHandler::getInstance().reportSemanticError("Cannot perform multiplication on non-numeric values.", node->LOCATION);
             return Value(0);
         }
     }
@@ -1331,7 +1449,7 @@ Value Interpreter::evaluateDiv(AST_NODE *node)
 
             if (rightVal == 0)
             {
-                ErrorHandler::getInstance().reportSemanticError("Division by zero is not allowed.");
+                ErrorHandler::getInstance().reportSemanticError("Division by zero is not allowed.", node->LOCATION);
                 return Value(0);
             }
 
@@ -1339,7 +1457,7 @@ Value Interpreter::evaluateDiv(AST_NODE *node)
         }
         else
         {
-            ErrorHandler::getInstance().reportSemanticError("Cannot perform division on non-numeric values.");
+            ErrorHandler::getInstance().reportSemanticError("Cannot perform division on non-numeric values.", node->LOCATION);
             return Value(0);
         }
     }
@@ -1356,7 +1474,7 @@ Value Interpreter::evaluateMod(AST_NODE *node)
         {
             if (right.asInt() == 0)
             {
-                ErrorHandler::getInstance().reportSemanticError("Modulus by zero is not allowed.");
+                ErrorHandler::getInstance().reportSemanticError("Modulus by zero is not allowed.", node->LOCATION);
                 return Value(0);
             }
             return Value(left.asInt() % right.asInt());
@@ -1368,20 +1486,20 @@ Value Interpreter::evaluateDecrement(AST_NODE *node)
 {
     if (node->SUB_STATEMENTS.size() != 1)
     {
-        ErrorHandler::getInstance().reportSemanticError("Decrement operator requires one operand.");
+        ErrorHandler::getInstance().reportSemanticError("Decrement operator requires one operand.", node->LOCATION);
         return Value(0);
     }
     AST_NODE *operand = node->SUB_STATEMENTS[0];
     if (operand->TYPE != NODE_IDENTIFIER)
     {
-        ErrorHandler::getInstance().reportSemanticError("Decrement operator can only be performed on variables.");
+        ErrorHandler::getInstance().reportSemanticError("Decrement operator can only be performed on variables.", node->LOCATION);
         return Value(0);
     }
 
     std::string varName = operand->VALUE;
     if (variables.find(varName) == variables.end())
     {
-        ErrorHandler::getInstance().reportSemanticError("Undefined variable '" + varName + "'");
+        ErrorHandler::getInstance().reportSemanticError("Undefined variable '" + varName + "'", node->LOCATION);
         return Value(0);
     }
 
@@ -1406,7 +1524,7 @@ Value Interpreter::evaluateDecrement(AST_NODE *node)
     }
     else
     {
-        ErrorHandler::getInstance().reportSemanticError("Decrement operator not supported for this type.");
+        ErrorHandler::getInstance().reportSemanticError("Decrement operator not supported for this type.", node->LOCATION);
         return Value(0);
     }
 }
@@ -1414,21 +1532,21 @@ Value Interpreter::evaluateIncrement(AST_NODE *node)
 {
     if (node->SUB_STATEMENTS.size() != 1)
     {
-        ErrorHandler::getInstance().reportSemanticError("Increment operator requires exactly one operand.");
+        ErrorHandler::getInstance().reportSemanticError("Increment operator requires exactly one operand.", node->LOCATION);
         return Value(0);
     }
 
     AST_NODE *operand = node->SUB_STATEMENTS[0];
     if (operand->TYPE != NODE_IDENTIFIER)
     {
-        ErrorHandler::getInstance().reportSemanticError("Increment operator can only be applied to variables.");
+        ErrorHandler::getInstance().reportSemanticError("Increment operator can only be applied to variables.", node->LOCATION);
         return Value(0);
     }
 
     std::string varName = operand->VALUE;
     if (variables.find(varName) == variables.end())
     {
-        ErrorHandler::getInstance().reportSemanticError("Undefined variable: '" + varName + "'");
+        ErrorHandler::getInstance().reportSemanticError("Undefined variable: '" + varName + "'", node->LOCATION);
         return Value(0);
     }
 
@@ -1453,7 +1571,7 @@ Value Interpreter::evaluateIncrement(AST_NODE *node)
     }
     else
     {
-        ErrorHandler::getInstance().reportSemanticError("Increment operator not supported for this type.");
+        ErrorHandler::getInstance().reportSemanticError("Increment operator not supported for this type.", node->LOCATION);
         return Value(0);
     }
 }
@@ -1499,7 +1617,7 @@ Value Interpreter::evaluateLessThan(AST_NODE *node)
         }
         else
         {
-            ErrorHandler::getInstance().reportSemanticError("Cannot compare non-numeric values.");
+            ErrorHandler::getInstance().reportSemanticError("Cannot compare non-numeric values.", node->LOCATION);
             return Value(false);
         }
     }
@@ -1520,7 +1638,7 @@ Value Interpreter::evaluateGreaterThan(AST_NODE *node)
         }
         else
         {
-            ErrorHandler::getInstance().reportSemanticError("Cannot compare non-numeric values.");
+            ErrorHandler::getInstance().reportSemanticError("Cannot compare non-numeric values.", node->LOCATION);
             return Value(false);
         }
     }
@@ -1541,7 +1659,7 @@ Value Interpreter::evaluateLessEqual(AST_NODE *node)
         }
         else
         {
-            ErrorHandler::getInstance().reportSemanticError("Cannot compare non-numeric values.");
+            ErrorHandler::getInstance().reportSemanticError("Cannot compare non-numeric values.", node->LOCATION);
             return Value(false);
         }
     }
@@ -1573,7 +1691,7 @@ Value Interpreter::evaluateArrayLength(AST_NODE *node)
     std::string arrayName = node->VALUE;
     if (variables.find(arrayName) == variables.end() || !variables[arrayName].isArray())
     {
-        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.");
+        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.", node->LOCATION);
         return Value(0);
     }
 
@@ -1585,7 +1703,7 @@ Value Interpreter::evaluateArrayAccess(AST_NODE *node)
     std::string arrayName = node->VALUE;
     if (!variables.count(arrayName) || !variables[arrayName].isArray())
     {
-        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.");
+        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.", node->LOCATION);
         return Value(0);
     }
     auto arr = variables[arrayName].asArray();
@@ -1599,7 +1717,7 @@ Value Interpreter::evaluateArrayAccess(AST_NODE *node)
     // else child is last-element marker:
     if (arr->getLength() == 0)
     {
-        ErrorHandler::getInstance().reportSemanticError("Cannot get last element of an empty array.");
+        ErrorHandler::getInstance().reportSemanticError("Cannot get last element of an empty array.", node->LOCATION);
         return Value(0);
     }
     return arr->getLastElement();
@@ -1609,7 +1727,7 @@ Value Interpreter::evaluateArrayAssign(AST_NODE *node)
     std::string arrayName = node->VALUE;
     if (variables.find(arrayName) == variables.end() || !variables[arrayName].isArray())
     {
-        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.");
+        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.", node->LOCATION);
         return Value(0);
     }
 
@@ -1624,7 +1742,7 @@ Value Interpreter::evaluateArrayAssign(AST_NODE *node)
     }
     catch (const std::out_of_range &e)
     {
-        ErrorHandler::getInstance().reportSemanticError("Array index out of bounds.");
+        ErrorHandler::getInstance().reportSemanticError("Array index out of bounds.", node->LOCATION);
         return Value(0);
     }
 }
@@ -1654,7 +1772,7 @@ Value Interpreter::evaluateArrayInsert(AST_NODE *node)
     std::string arrayName = node->VALUE;
     if (variables.find(arrayName) == variables.end() || !variables[arrayName].isArray())
     {
-        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.");
+        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.", node->LOCATION);
         return Value(0);
     }
 
@@ -1669,7 +1787,7 @@ Value Interpreter::evaluateArrayInsert(AST_NODE *node)
     }
     catch (const std::out_of_range &e)
     {
-        ErrorHandler::getInstance().reportSemanticError("Invalid array index for insertion.");
+        ErrorHandler::getInstance().reportSemanticError("Invalid array index for insertion.", node->LOCATION);
         return Value(0);
     }
 }
@@ -1678,7 +1796,7 @@ Value Interpreter::evaluateArrayRemove(AST_NODE *node)
     std::string arrayName = node->VALUE;
     if (variables.find(arrayName) == variables.end() || !variables[arrayName].isArray())
     {
-        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.");
+        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.", node->LOCATION);
         return Value(0);
     }
 
@@ -1693,7 +1811,7 @@ Value Interpreter::evaluateArrayRemove(AST_NODE *node)
     }
     catch (const std::out_of_range &e)
     {
-        ErrorHandler::getInstance().reportSemanticError("Array index out of bounds.");
+        ErrorHandler::getInstance().reportSemanticError("Array index out of bounds.", node->LOCATION);
         return Value(0);
     }
 }
@@ -1702,28 +1820,28 @@ Value Interpreter::evaluateArrayIndexMod(AST_NODE *node)
     std::string arrayName = node->VALUE;
     if (!variables.count(arrayName) || !variables[arrayName].isArray())
     {
-        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.");
+        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.", node->LOCATION);
     }
 
     auto array = variables[arrayName].asArray();
 
     if (!node || node->CHILD->TYPE != NODE_ARRAY_INDEX)
     {
-        ErrorHandler::getInstance().reportSemanticError("Invalid dot expression structure.");
+        ErrorHandler::getInstance().reportSemanticError("Invalid dot expression structure.", node->LOCATION);
     }
 
     int index = std::stoi(node->CHILD->VALUE);
 
     if (index < 0 || static_cast<size_t>(index) >= array->getLength())
     {
-        ErrorHandler::getInstance().reportSemanticError("Array index out of bounds: " + index);
+        ErrorHandler::getInstance().reportSemanticError("Array index out of bounds: " + index, node->LOCATION);
     }
 
     Value currentValueOfIndex = array->getElement(index);
 
     if (!node->CHILD->CHILD)
     {
-        ErrorHandler::getInstance().reportSemanticError("Missing operator in dot expression.");
+        ErrorHandler::getInstance().reportSemanticError("Missing operator in dot expression.", node->LOCATION);
     }
 
     Value operandValue = Value(std::stoi(node->CHILD->CHILD->CHILD->VALUE));
@@ -1749,14 +1867,14 @@ Value Interpreter::evaluateArrayIndexMod(AST_NODE *node)
         }
         else
         {
-            ErrorHandler::getInstance().reportSemanticError("Cannot multiply non-numeric values.");
+            ErrorHandler::getInstance().reportSemanticError("Cannot multiply non-numeric values.", node->LOCATION);
         }
         break;
     case NODE_DIVISION:
         if ((operandValue.isInt() && operandValue.asInt() == 0) ||
             (operandValue.isDouble() && operandValue.asDouble() == 0.0))
         {
-            ErrorHandler::getInstance().reportSemanticError("Division by zero.");
+            ErrorHandler::getInstance().reportSemanticError("Division by zero.", node->LOCATION);
         }
 
         if (currentValueOfIndex.isInt() && operandValue.isInt())
@@ -1772,7 +1890,7 @@ Value Interpreter::evaluateArrayIndexMod(AST_NODE *node)
         }
         else
         {
-            ErrorHandler::getInstance().reportSemanticError("Cannot divide non-numeric values.");
+            ErrorHandler::getInstance().reportSemanticError("Cannot divide non-numeric values.", node->LOCATION);
         }
         break;
     case NODE_SUBT:
@@ -1789,13 +1907,13 @@ Value Interpreter::evaluateArrayIndexMod(AST_NODE *node)
         }
         else
         {
-            ErrorHandler::getInstance().reportSemanticError("Cannot subtract non-numeric values.");
+            ErrorHandler::getInstance().reportSemanticError("Cannot subtract non-numeric values.", node->LOCATION);
         }
         break;
     case NODE_MODULUS:
         if (operandValue.isInt() && operandValue.asInt() == 0)
         {
-            ErrorHandler::getInstance().reportSemanticError("Modulus by zero");
+            ErrorHandler::getInstance().reportSemanticError("Modulus by zero", node->LOCATION);
         }
 
         if (currentValueOfIndex.isInt() && operandValue.isInt())
@@ -1804,11 +1922,11 @@ Value Interpreter::evaluateArrayIndexMod(AST_NODE *node)
         }
         else
         {
-            ErrorHandler::getInstance().reportSemanticError("Modulus requires integer operands.");
+            ErrorHandler::getInstance().reportSemanticError("Modulus requires integer operands.", node->LOCATION);
         }
         break;
     default:
-        ErrorHandler::getInstance().reportSemanticError("Unknown operator in dot expression.");
+        ErrorHandler::getInstance().reportSemanticError("Unknown operator in dot expression.", node->LOCATION);
     }
 
     array->setElement(index, resultOfExpression);
@@ -1819,7 +1937,7 @@ Value Interpreter::evaluateArraySortAsc(AST_NODE *node)
     std::string arrayName = node->VALUE;
     if (variables.find(arrayName) == variables.end() || !variables[arrayName].isArray())
     {
-        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.");
+        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.", node->LOCATION);
         return Value(0);
     }
 
@@ -1832,7 +1950,7 @@ Value Interpreter::evaluateArraySortDesc(AST_NODE *node)
     std::string arrayName = node->VALUE;
     if (variables.find(arrayName) == variables.end() || !variables[arrayName].isArray())
     {
-        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.");
+        ErrorHandler::getInstance().reportSemanticError(arrayName + " is not an array.", node->LOCATION);
         return Value(0);
     }
 
@@ -1844,89 +1962,27 @@ Value Interpreter::evaluateArraySortDesc(AST_NODE *node)
 // Other stuff
 Value Interpreter::evaluateFunctionCall(AST_NODE *node)
 {
-    static int recursionDepth = 0;
-    recursionDepth++;
-
-    std::string funcName = node->VALUE;
-    // std::cout << "Entering Function: " << funcName << " depth: " << recursionDepth << std::endl;
-    std::string callID = generateCallID(funcName, recursionDepth);
-    // ** Handle random library functions first ** //
-    if (funcName == "randomInt")
+    // Builtins were bound to the call node by resolveBuiltinCalls()
+    if (node->BUILTIN_ID >= 0)
     {
-        Value result = evaluateRandomInt(node);
-        recursionDepth--;
-        return result;
-    }
-    else if (funcName == "coinFlip")
-    {
-        Value result = evaluateCoinFlip(node);
-        recursionDepth--;
-        return result;
-    }
-    else if (funcName == "diceRoll")
-    {
-        Value result = evaluateDiceRoll(node);
-        recursionDepth--;
-        return result;
-    }
-    else if (funcName == "generatePin")
-    {
-        Value result = evaluateGeneratePin(node);
-        recursionDepth--;
-        return result;
-    }
-    else if (funcName == "sqrt")
-    {
-        Value result = evaluateSQRT(node);
-        recursionDepth--;
-        return result;
-    }
-    else if (funcName == "abs")
-    {
-        Value result = evaluateABS(node);
-        recursionDepth--;
-        return result;
-    }
-    else if (funcName == "pow")
-    {
-        Value result = evaluatePOW(node);
-        recursionDepth--;
-        return result;
-    }
-    else if (funcName == "min")
-    {
-        Value result = evaluateMIN(node);
-        recursionDepth--;
-        return result;
-    }
-    else if (funcName == "max")
-    {
-        Value result = evaluateMAX(node);
-        recursionDepth--;
-        return result;
-    }
-    else if (funcName == "ceil")
-    {
-        Value result = evaluateCEIL(node);
-        recursionDepth--;
-        return result;
-    }
-    else if (funcName == "floor")
-    {
-        Value result = evaluateFLOOR(node);
-        recursionDepth--;
-        return result;
+        Profiler::ProcScope builtinScope(profiler, node->VALUE, true);
+        ShadowStack::Scope builtinFrame(shadowStack, node, ShadowStack::Kind::PROC);
+        return (this->*builtinRegistry().functions[node->BUILTIN_ID])(node);
     }
 
+    std::string funcName = node->VALUE;
+
     // Look up function definition
     AST_NODE *funcDef = findFunctionByName(funcName);
     if (!funcDef)
     {
-        // std::cerr << "Undefined function: " << funcName << std::endl;
-        // exit(1);
-        ErrorHandler::getInstance().reportSemanticError("Undefined function: " + funcName);
+        // Does not return: the call has nothing to execute
+        ErrorHandler::getInstance().reportRuntimeError("Undefined function: " + funcName, node->LOCATION);
     }
 
+    Profiler::ProcScope procScope(profiler, funcName);
+    ShadowStack::Scope procFrame(shadowStack, node, ShadowStack::Kind::PROC);
+
     // Save the current state of all variables
     std::map<std::string, Value> oldVariables = variables;
 
@@ -1953,16 +2009,10 @@ Value Interpreter::evaluateFunctionCall(AST_NODE *node)
     // Get this function's return value
     Value result = returnValue;
 
-    // IMPORTANT: Print debug info to see what each recursive call is returning
-    // std::cout << "Function " << funcName << " at depth " << recursionDepth
-    //           << " returning: " << result.toString() << std::endl;
-
     // Restore the previous state
     variables = oldVariables;
     returnValue = oldReturnValue;
 
-    recursionDepth--;
-
     // Return this function's result
     return result;
 }
@@ -1,6 +1,7 @@
 #ifndef INTERPRETER_HPP
 #define INTERPRETER_HPP
 
+#include <array>
 #include <map>
 #include <iostream>
 #include <sstream>
@@ -17,6 +18,9 @@
 #include "dynamic_array.hpp"
 #include "ErrorHandler.hpp"
 #include "library/LibraryManager.hpp"
+#include "OutputWriter.hpp"
+#include "Profiler.hpp"
+#include "SamplingProfiler.hpp"
 
 /**
  * @class Interpreter
@@ -33,27 +37,50 @@ public:
      * @brief Constructor that initializes the interpreter with an AST
      * @param root The root node of the abstract syntax tree
      *
-     * Sets up the interpreter with the provided AST and initializes the output file.
+     * Output goes to stdout and to a new timestamped file in ../output.
      */
     Interpreter(AST_NODE *root) : root(root)
     {
         setupOutputFile();
-        initializeInterperterMaps();
     }
 
     /**
-     * @brief Destructor that ensures output file is closed
+     * @brief Constructor that sends the program's output to the given sinks
+     * @param root The root node of the abstract syntax tree
+     * @param outputConfig Console and log sinks; see OutputConfig::parse
+     */
+    Interpreter(AST_NODE *root, const OutputConfig &outputConfig) : root(root)
+    {
+        output.open(outputConfig);
+    }
+
+    using FunctionTable = std::unordered_map<std::string, AST_NODE *>;
+
+    /**
+     * @brief Constructor for a prepared program (see Program)
+     * @param root The root node of the abstract syntax tree
+     * @param outputConfig Console and log sinks; see OutputConfig::parse
+     * @param functions Procs by name, from collectFunctions()
+     *
+     * The tree must already have been through resolveBuiltinCalls(); it is
+     * only read, so several interpreters may share it.
+     */
+    Interpreter(AST_NODE *root, const OutputConfig &outputConfig, const FunctionTable *functions)
+        : root(root), functions(functions)
+    {
+        output.open(outputConfig);
+    }
+
+    /**
+     * @brief Destructor that ensures all output is delivered and the output file is closed
      */
     ~Interpreter()
     {
-        if (outputFile.is_open())
-        {
-            outputFile.close();
-        }
+        output.close();
     }
 
     /**
-     * @brief Sets up the output file for logging program execution
+     * @brief Sets up the default output: stdout plus a timestamped log file
      */
     void setupOutputFile();
 
@@ -62,25 +89,109 @@ public:
      */
     void execute();
 
+    /**
+     * @brief Collects execution statistics into profiler (null to stop profiling)
+     *
+     * The profiler must outlive execute().
+     */
+    void setProfiler(Profiler *newProfiler) { profiler = newProfiler; }
+
+    /**
+     * @brief Keeps stack the current procs and statements, for a SamplingProfiler (null to stop)
+     */
+    void setShadowStack(ShadowStack *stack) { shadowStack = stack; }
+
     const std::map<std::string, std::stack<Value>> &getFunctionReturnValues() const
     {
         return functionReturnValues;
     }
 
+    /**
+     * @brief Waits until all output so far has reached the sinks
+     *
+     * execute() does this itself when it returns normally.
+     */
+    void flushOutput() { output.flush(); }
+
+    /**
+     * @brief Forgets the variables and return values of earlier executions
+     */
+    void reset();
+
+    /**
+     * @brief Defines a variable before execute(), as if the program had declared it
+     */
+    void setVariable(const std::string &name, const Value &value) { variables[name] = value; }
+
+    /**
+     * @brief Looks up a variable after execute()
+     * @return nullptr if the program never defined it
+     */
+    const Value *findVariable(const std::string &name) const;
+
+    /**
+     * @brief Where input statements read from (std::cin by default)
+     *
+     * Prompts are only printed while reading std::cin.
+     */
+    void setInputStream(std::istream *stream) { input = stream; }
+
+    /**
+     * @brief Binds each NODE_FUNCTION_CALL in a tree to its builtin id
+     * @param node Root of the tree to resolve
+     *
+     * Calls to names without a builtin get -1 and go to user procs.
+     */
+    static void resolveBuiltinCalls(AST_NODE *node);
+
+    /**
+     * @brief Records every proc declared in a tree, headers included
+     *
+     * Where a name is declared twice the table keeps the declaration
+     * findFunctionByName() would find first.
+     */
+    static void collectFunctions(AST_NODE *root, FunctionTable &table);
+
 private:
     AST_NODE *root;                                                ///< Root of the abstract syntax tree
     std::map<std::string, Value> variables;                        ///< Symbol table for variable storage
-    std::ofstream outputFile;                                      ///< File stream for logging output
+    OutputWriter output;                                           ///< Buffered console and output-file writer
+    Profiler *profiler = nullptr;                                  ///< Statistics for 'profile' mode, usually null
+    ShadowStack *shadowStack = nullptr;                            ///< Sampled by --sample, usually null
+    const FunctionTable *functions = nullptr;                      ///< Procs of a prepared program, else null
+    std::istream *input = &std::cin;                               ///< Read by input statements
     Value returnValue;                                             ///< Holds return values from functions
     std::map<std::string, std::stack<Value>> functionReturnValues; ///< Tracks return values for recursive calls
 
     using evaluatorFunction = Value (Interpreter::*)(AST_NODE *);
     using standardLibrary = Value (Interpreter::*)(AST_NODE *);
-    // Map node types to their corresponding execute functions (void return)
-    std::unordered_map<std::string, standardLibrary> standardLib;
-    std::unordered_map<NODE_TYPE, evaluatorFunction> nodeExecutors;
+    using ExecutorTable = std::array<evaluatorFunction, NODE_FLOOR + 1>;
+
+    /**
+     * @brief Evaluator for each node type, or null; one table for every Interpreter
+     *
+     * Like the tree it is only read during execution, so it needs no per
+     * interpreter copy and no locking.
+     */
+    static const ExecutorTable &nodeExecutors();
+
+    /**
+     * @brief Native functions callable by name, addressed by integer id
+     *
+     * Ids follow registration order and are the same for every Interpreter,
+     * so they can be bound into call nodes once and dispatched by indexing.
+     */
+    struct BuiltinRegistry
+    {
+        std::vector<standardLibrary> functions;
+        std::unordered_map<std::string, int> ids;
+
+        int add(const std::string &name, standardLibrary function);
+        int find(const std::string &name) const;
+    };
+
+    static const BuiltinRegistry &builtinRegistry();
 
-    void initializeInterperterMaps();
     /**
      * @brief Finds a function declaration by name
      * @param name The name of the function to find
@@ -143,50 +254,26 @@ private:
      */
     void printToOutput(const Value &value)
     {
-        // Print to console
+        // Queue for the console and the output file
         if (value.isInt())
         {
-            std::cout << value.asInt();
-            outputFile << value.asInt();
+            output.write(value.asInt());
         }
         else if (value.isDouble())
         {
-            std::cout << value.asDouble();
-            outputFile << value.asDouble();
+            output.write(value.asDouble());
         }
         else if (value.isBool())
         {
-            std::cout << (value.asBool() ? "true" : "false");
-            outputFile << (value.asBool() ? "true" : "false");
+            output.write(value.asBool() ? "true" : "false");
         }
         else if (value.isString())
         {
-            // Check if the string contains newline characters
-            std::string str = value.asString();
-            bool containsNewline = str.find('\n') != std::string::npos;
-
-            std::cout << str;
-            outputFile << str;
-
-            // Only flush if the string contains a newline
-            if (containsNewline)
-            {
-                std::cout.flush();
-                outputFile.flush();
-            }
+            output.write(value.asString());
         }
         else if (value.isChar())
         {
-            char ch = value.asChar();
-            std::cout << ch;
-            outputFile << ch;
-
-            // Only flush if the character is a newline
-            if (ch == '\n')
-            {
-                std::cout.flush();
-                outputFile.flush();
-            }
+            output.write(value.asChar());
         }
         else if (value.isArray())
         {
@@ -200,8 +287,7 @@ private:
 
             const DynamicArray &arr = *arrPtr;
 
-            std::cout << "[";
-            outputFile << "[";
+            output.write('[');
 
             size_t n = arr.getLength();
             for (size_t i = 0; i < n; ++i)
@@ -212,18 +298,15 @@ private:
 
                 if (i + 1 < n)
                 {
-                    std::cout << ",";
-                    outputFile << ",";
+                    output.write(',');
                 }
             }
 
-            std::cout << "]";
-            outputFile << "]";
+            output.write(']');
         }
         else
         {
-            std::cout << "NULL";
-            outputFile << "NULL";
+            output.write("NULL");
         }
     }
 
@@ -283,8 +366,12 @@ private:
             ErrorHandler::getInstance().reportSemanticError("WARNING -> Empty prompt.");
         }
 
-        // Print prompt to console
-        std::cout << promptString << std::flush;
+        // Print prompt to console, after any output still queued
+        if (input == &std::cin)
+        {
+            output.flush();
+            std::cout << promptString << std::flush;
+        }
 
         // Get variable name safely
         std::string varName = "";
@@ -304,7 +391,7 @@ private:
         // Read user input
         // std::cerr << "DEBUG: Reading user input..." << std::endl;
         std::string userInput;
-        std::getline(std::cin, userInput);
+        std::getline(*input, userInput);
         // std::cerr << "DEBUG: User input received: " << userInput << std::endl;
 
         // Convert input to appropriate type
@@ -398,12 +485,6 @@ private:
         returnValue = value;
     }
 
-    // Function to create a unique call ID for each recursive function call
-    std::string generateCallID(const std::string &funcName, int depth)
-    {
-        return funcName + "_" + std::to_string(depth);
-    }
-
     bool hasReturnValue() const
     {
         return !returnValue.isNone();
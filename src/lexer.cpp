@@ -5,10 +5,133 @@
 #include <vector>
 #include <cctype>
 #include <fstream>
+#include <array>
 
 #include "lexer.hpp"
+#include "scanner.hpp"
+#include "SourceBuffer.hpp"
+#include "SourceLocation.hpp"
 #include "ErrorHandler.hpp"
 
+namespace
+{
+    /**
+     * @brief A keyword spelling and the token type it produces
+     */
+    struct KeywordEntry
+    {
+        std::string_view text;
+        tokenType type = TOKEN_IDENTIFIER;
+    };
+
+    //
+    // Every identifier-shaped word the lexer treats specially. "begin", "needs",
+    // "source" and "library" only become keywords when followed by a ':' and
+    // "true"/"false" become bool literals; processKeyword handles those cases.
+    //
+    constexpr KeywordEntry keywordList[] = {
+        {"begin", TOKEN_KEYWORD_BEGIN},
+        {"proc", TOKEN_KEYWORD_FUNCTION},
+        {"input", TOKEN_KEYWORD_INPUT},
+        {"int", TOKEN_KEYWORD_INT},
+        {"double", TOKEN_KEYWORD_DOUBLE},
+        {"str", TOKEN_KEYWORD_STR},
+        {"check", TOKEN_KEYWORD_CHECK},
+        {"char", TOKEN_KEYWORD_CHAR},
+        {"out_to_console", TOKEN_KEYWORD_PRINT},
+        {"if", TOKEN_KEYWORD_IF},
+        {"else", TOKEN_KEYWORD_ELSE},
+        {"for", TOKEN_KEYWORD_FOR},
+        {"end", TOKEN_EOF},
+        {"bool", TOKEN_KEYWORD_BOOL},
+        {"result", TOKEN_KEYWORD_RESULT},
+        {"elements", TOKEN_KEYWORD_ELEMENT},
+        {"repeat", TOKEN_KEYWORD_REPEAT},
+        {"range", TOKEN_KEYWORD_RANGE},
+        {"object", TOKEN_KEYWORD_OBJECT},
+        {"available", TOKEN_KEYWORD_AVAILABLE},
+        {"secure", TOKEN_KEYWORD_SECURE},
+        {"default", TOKEN_OBJECT_DEFAULT},
+        {"factory", TOKEN_OBJECT_FACTORY},
+        {"method", TOKEN_OBJECT_METHOD},
+        {"needs", TOKEN_KEYWORD_NEEDS},
+        {"const", TOKEN_CONST_NUM},
+        {"library", TOKEN_LIBRARY},
+        {"source", TOKEN_HEADER_FILE},
+        {"true", TOKEN_BOOL_VALUE},
+        {"false", TOKEN_BOOL_VALUE}};
+
+    constexpr std::size_t KEYWORD_TABLE_SIZE = 64;
+    constexpr std::size_t KEYWORD_MIN_LENGTH = 2;
+    constexpr std::size_t KEYWORD_MAX_LENGTH = 14;
+
+    /**
+     * @brief Perfect hash over the keyword set
+     * @param word Candidate word, at least KEYWORD_MIN_LENGTH characters long
+     * @return Slot index in the keyword table
+     *
+     * Mixes the length with the first, middle and last characters. The
+     * constants were picked so that no two keywords share a slot, which
+     * keywordTableIsPerfect() verifies at compile time.
+     */
+    constexpr std::size_t keywordSlot(std::string_view word)
+    {
+        return (word.size() * 9 +
+                static_cast<unsigned char>(word[0]) * 8 +
+                static_cast<unsigned char>(word[word.size() / 2]) * 6 +
+                static_cast<unsigned char>(word[word.size() - 1])) &
+               (KEYWORD_TABLE_SIZE - 1);
+    }
+
+    constexpr std::array<KeywordEntry, KEYWORD_TABLE_SIZE> buildKeywordTable()
+    {
+        std::array<KeywordEntry, KEYWORD_TABLE_SIZE> table{};
+        for (const KeywordEntry &entry : keywordList)
+        {
+            table[keywordSlot(entry.text)] = entry;
+        }
+        return table;
+    }
+
+    constexpr std::array<KeywordEntry, KEYWORD_TABLE_SIZE> keywordTable = buildKeywordTable();
+
+    constexpr bool keywordTableIsPerfect()
+    {
+        for (const KeywordEntry &entry : keywordList)
+        {
+            if (entry.text.size() < KEYWORD_MIN_LENGTH || entry.text.size() > KEYWORD_MAX_LENGTH ||
+                keywordTable[keywordSlot(entry.text)].text != entry.text)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(keywordTableIsPerfect(), "keyword hash has a collision or a keyword is out of the length bounds");
+
+    /**
+     * @brief Looks a word up in the keyword table without allocating
+     * @param word The identifier-shaped word to look up
+     * @param type Receives the keyword's token type on a match
+     * @return true if word is a keyword
+     */
+    inline bool lookupKeyword(std::string_view word, tokenType &type)
+    {
+        if (word.size() < KEYWORD_MIN_LENGTH || word.size() > KEYWORD_MAX_LENGTH)
+        {
+            return false;
+        }
+        const KeywordEntry &entry = keywordTable[keywordSlot(word)];
+        if (entry.text != word)
+        {
+            return false;
+        }
+        type = entry.type;
+        return true;
+    }
+}
+
 /**
  * @brief Constructor for Lexer class
  * @param sourceCode The source code to be tokenized
@@ -17,11 +140,30 @@
  * to begin tokenization from the start of the input.
  */
 Lexer::Lexer(std::string sourceCode)
+    : ownedSource(std::move(sourceCode))
+{
+    source = ownedSource;
+    startAtBeginning();
+}
+
+/**
+ * @brief Constructor for Lexer class over a source buffer
+ * @param buffer The (typically memory-mapped) source to be tokenized
+ *
+ * Reads directly from the buffer's bytes without copying them. The buffer
+ * must stay alive for as long as the lexer is used.
+ */
+Lexer::Lexer(const SourceBuffer &buffer)
+    : source(buffer.view()), sourceName(buffer.path())
+{
+    startAtBeginning();
+}
+
+void Lexer::startAtBeginning()
 {
-    source = sourceCode;
     cursor = 0;
-    current = sourceCode.at(cursor);
-    size = sourceCode.length();
+    size = source.length();
+    current = size > 0 ? source[0] : '\0';
 
     isArrayType = false;
     initializeLexerMaps();
@@ -76,37 +218,6 @@ void Lexer::initializeLexerMaps()
         {"=/=", TOKEN_OPERATOR_DOESNT_EQUAL},
         {"::", TOKEN_COLON_OOP},
         {"->", TOKEN_ARROW_OP}};
-
-    KeywordMap = {
-        {"begin:", TOKEN_KEYWORD_BEGIN},
-        {"proc", TOKEN_KEYWORD_FUNCTION},
-        {"input", TOKEN_KEYWORD_INPUT},
-        {"int", TOKEN_KEYWORD_INT},
-        {"double", TOKEN_KEYWORD_DOUBLE},
-        {"str", TOKEN_KEYWORD_STR},
-        {"check", TOKEN_KEYWORD_CHECK},
-        {"char", TOKEN_KEYWORD_CHAR},
-        {"out_to_console", TOKEN_KEYWORD_PRINT},
-        {"if", TOKEN_KEYWORD_IF},
-        {"else", TOKEN_KEYWORD_ELSE},
-        {"for", TOKEN_KEYWORD_FOR},
-        {"end", TOKEN_EOF},
-        {"bool", TOKEN_KEYWORD_BOOL},
-        {"result", TOKEN_KEYWORD_RESULT},
-        {"elements", TOKEN_KEYWORD_ELEMENT},
-        {"repeat", TOKEN_KEYWORD_REPEAT},
-        {"range", TOKEN_KEYWORD_RANGE},
-        {"@once", TOKEN_READ_HEADER},
-        {"@last", TOKEN_END_HEADER},
-        {"object", TOKEN_KEYWORD_OBJECT},
-        {"available", TOKEN_KEYWORD_AVAILABLE},
-        {"secure", TOKEN_KEYWORD_SECURE},
-        {"default", TOKEN_OBJECT_DEFAULT},
-        {"factory", TOKEN_OBJECT_FACTORY},
-        {"method", TOKEN_OBJECT_METHOD},
-        {"needs:", TOKEN_KEYWORD_NEEDS},
-        {"const", TOKEN_CONST_NUM},
-        {"library", TOKEN_LIBRARY}};
 }
 
 /**
@@ -132,38 +243,15 @@ char Lexer::advanceCursor()
 }
 
 /**
- * @brief Checks if the upcoming characters match a given keyword
- * @param keyword The keyword to match against
- * @return true if the keyword matches, false otherwise
+ * @brief Moves the cursor to an absolute position in the source
+ * @param position The new cursor position; positions past the end clamp to eof
  *
- * Compares characters starting from the current cursor position
- * with the given keyword without advancing the cursor.
+ * Used after the vectorized scanners have found where a run ends, so the
+ * skipped bytes are not visited one at a time.
  */
-bool Lexer::matchKeyword(const std::string &keyword)
+void Lexer::moveCursorTo(int position)
 {
-    if (cursor + keyword.size() > static_cast<size_t>(size))
-    {
-        return false;
-    }
-    return source.substr(cursor, keyword.size()) == keyword;
-}
-
-/**
- * @brief Consumes a keyword if it matches the upcoming characters
- * @param keyword The keyword to consume
- * @throws std::runtime_error if the keyword doesn't match
- *
- * Verifies that the upcoming characters match the keyword and advances
- * the cursor past the keyword if it matches. Throws an error otherwise.
- */
-void Lexer::consumeKeyword(const std::string &keyword)
-{
-    if (!matchKeyword(keyword))
-    {
-        // throw std::runtime_error("Error: Keyword mismatch during consumeKeyword.");
-        ErrorHandler::getInstance().reportRuntimeError("Keyword mismatch during consumeKeyword.");
-    }
-    cursor += keyword.length();
+    cursor = position < size ? position : size;
     current = (cursor < size) ? source[cursor] : '\0';
 }
 
@@ -194,10 +282,11 @@ char Lexer::peakAhead(int offset)
  */
 void Lexer::checkAndSkip()
 {
-    while (!eof() && (current == ' ' || current == '\n' || current == '\t' || current == '\r'))
+    if (eof() || (current != ' ' && current != '\n' && current != '\t' && current != '\r'))
     {
-        advanceCursor();
+        return;
     }
+    moveCursorTo(scanner::skipWhitespace(source.data(), cursor + 1, size));
 }
 
 /**
@@ -209,74 +298,58 @@ bool Lexer::eof() const
     return cursor >= size;
 }
 
+/**
+ * @brief Processes a single line comment (>>$ ...)
+ * @return Token pointer holding the comment text
+ *
+ * The end of the line is located with the vectorized scanner and the
+ * comment body is copied in one go.
+ */
 Token *Lexer::processSingleLineComment()
 {
+    std::size_t end = scanner::findLineEnd(source.data(), cursor, size);
+
     std::string commentText = ">>$";
+    commentText.append(source, cursor, end - cursor);
+    moveCursorTo(end);
 
-    while (!eof() && current != '\n' && current != '\r')
-    {
-        commentText += current;
-        advanceCursor();
-    }
     return new Token{TOKEN_SINGLELINE_COMMENT, commentText};
 }
 
+/**
+ * @brief Processes a multi line comment (<<$ ... $>>)
+ * @return Token pointer holding the comment text
+ *
+ * Jumps from one '$' to the next with the vectorized scanner until the
+ * closing "$>>" marker is found.
+ */
 Token *Lexer::processMultiLineComment()
 {
-    std::string commentText = "<<$";
+    std::size_t start = cursor;
+    std::size_t marker = scanner::findByte(source.data(), start, size, '$');
 
-    bool foundEndMarker = false;
-
-    while (!eof())
-    {
-        if (current == '$' && peakAhead(1) == '>' && peakAhead(2) == '>')
-        {
-            commentText += "$>>";
-            advanceCursor();
-            advanceCursor();
-            advanceCursor();
-            foundEndMarker = true;
-            break;
-        }
-        commentText += current;
-        advanceCursor();
-    }
-    if (!foundEndMarker)
+    while (marker < static_cast<std::size_t>(size) &&
+           !(marker + 2 < static_cast<std::size_t>(size) && source[marker + 1] == '>' && source[marker + 2] == '>'))
     {
-        // throw std::runtime_error("Error: Unterminated multiLine comment");
-        ErrorHandler::getInstance().reportRuntimeError("Unterminated multiline comment.");
+        marker = scanner::findByte(source.data(), marker + 1, size, '$');
     }
-    return new Token{TOKEN_MULTILINE_COMMENT, commentText};
-}
 
-/**
- * @brief Processes true or false statements
- * @return Token pointer representing the true or false value
- * @throws std::runtime error if true or false is invalid
- */
-Token *Lexer::processBool()
-{
-    std::string boolStr = "";
-    while (isalpha(current) && current != ';')
-    {
-        boolStr += current;
-        advanceCursor();
-    }
+    std::string commentText = "<<$";
+    commentText.append(source, start, marker - start);
 
-    if (boolStr == "true")
-    {
-        return new Token{TOKEN_BOOL_VALUE, boolStr};
-    }
-    else if (boolStr == "false")
+    if (marker >= static_cast<std::size_t>(size))
     {
-        return new Token{TOKEN_BOOL_VALUE, boolStr};
+        moveCursorTo(size);
+        // throw std::runtime_error("Error: Unterminated multiLine comment");
+        ErrorHandler::getInstance().reportRuntimeError("Unterminated multiline comment.",
+                                                       locationBase ? locationBase + start : SourceMap::NO_LOCATION);
     }
     else
     {
-        // throw std::runtime_error("Invalid boolean literal: " + boolStr);
-        ErrorHandler::getInstance().reportRuntimeError("Invalid boolean literal: " + boolStr);
-        return nullptr;
+        commentText += "$>>";
+        moveCursorTo(marker + 3);
     }
+    return new Token{TOKEN_MULTILINE_COMMENT, commentText};
 }
 
 /**
@@ -461,7 +534,7 @@ Token *Lexer::processOperator()
     }
 
     // throw std::runtime_error("Error: Unknown operator: " + op);
-    ErrorHandler::getInstance().reportLexicalError("Unknown operator: " + op);
+    reportLexicalError("Unknown operator: " + op);
     return nullptr;
 }
 
@@ -477,20 +550,17 @@ Token *Lexer::processStringLiteral()
     if (current == '"')
     {
         advanceCursor(); // Skip opening quote
-        std::string value;
 
-        // Collect characters until closing quote or EOF
-        while (current != '"' && !eof())
-        {
-            value += current;
-            advanceCursor();
-        }
+        // Find the closing quote (or EOF) and copy the contents in one go
+        std::size_t end = scanner::findByte(source.data(), cursor, size, '"');
+        std::string value(source, cursor, end - cursor);
+        moveCursorTo(end);
 
         // Verify string was properly terminated
         if (current != '"')
         {
             // throw std::runtime_error("Error: Unterminated String Literal.");
-            ErrorHandler::getInstance().reportLexicalError("Unterminated string literal.");
+            reportLexicalError("Unterminated string literal.");
         }
         advanceCursor(); // Skip closing quote
         return new Token{TOKEN_STRING_VAL, value};
@@ -498,7 +568,7 @@ Token *Lexer::processStringLiteral()
     else
     {
         // throw std::runtime_error("Error: Invalid string literal.");
-        ErrorHandler::getInstance().reportLexicalError("Invalid string literal.");
+        reportLexicalError("Invalid string literal.");
         return nullptr;
     }
 }
@@ -523,7 +593,7 @@ Token *Lexer::processCharLiteral()
         if (current != '\'')
         {
             // throw std::runtime_error("Error: Invalid character literal.");
-            ErrorHandler::getInstance().reportLexicalError("Invalid character literal.");
+            reportLexicalError("Invalid character literal.");
         }
 
         advanceCursor(); // Move past closing quote
@@ -540,14 +610,14 @@ Token *Lexer::processCharLiteral()
         if (current != '\'')
         {
             // throw std::runtime_error("Error: Invalid character literal.");
-            ErrorHandler::getInstance().reportLexicalError("Invalid character literal.");
+            reportLexicalError("Invalid character literal.");
         }
         advanceCursor(); // Move past closing quote
         return new Token{TOKEN_OPERATOR_NEWLINE, std::string(1, newLineValue)};
     }
 
     // throw std::runtime_error("Error: Invalid character literal format.");
-    ErrorHandler::getInstance().reportLexicalError("Invalid character literal format.");
+    reportLexicalError("Invalid character literal format.");
     return nullptr;
 }
 
@@ -562,7 +632,7 @@ Token *Lexer::processNeedsBlock()
 
     if (current != '{')
     {
-        ErrorHandler::getInstance().reportLexicalError("Expected '{' after 'needs:' directive");
+        reportLexicalError("Expected '{' after 'needs:' directive");
     }
     return needsToken;
 }
@@ -584,12 +654,12 @@ Token *Lexer::processSourceDirective()
 
     if (sourceKeyword != "source")
     {
-        ErrorHandler::getInstance().reportLexicalError("Expected 'source' directive in needs block");
+        reportLexicalError("Expected 'source' directive in needs block");
     }
 
     if (current != ':')
     {
-        ErrorHandler::getInstance().reportLexicalError("Expected ':' after 'source' directive");
+        reportLexicalError("Expected ':' after 'source' directive");
     }
     advanceCursor();
 
@@ -599,7 +669,7 @@ Token *Lexer::processSourceDirective()
 
     if (current != '"')
     {
-        ErrorHandler::getInstance().reportLexicalError("Expected string literal for filename after 'source:'");
+        reportLexicalError("Expected string literal for filename after 'source:'");
     }
     return sourceToken;
 }
@@ -615,12 +685,12 @@ Token *Lexer::processLibraryDirective()
 
     if (library != "library")
     {
-        ErrorHandler::getInstance().reportLexicalError("Expected 'library' directive in needs block");
+        reportLexicalError("Expected 'library' directive in needs block");
     }
 
     if (current != ':')
     {
-        ErrorHandler::getInstance().reportLexicalError("Expected ':' after 'library' directive");
+        reportLexicalError("Expected ':' after 'library' directive");
     }
     advanceCursor();
 
@@ -630,7 +700,7 @@ Token *Lexer::processLibraryDirective()
 
     if (current != '"')
     {
-        ErrorHandler::getInstance().reportLexicalError("Expected string literal for filename after 'library:'");
+        reportLexicalError("Expected string literal for filename after 'library:'");
     }
     return libraryDirective;
 }
@@ -658,7 +728,7 @@ Token *Lexer::processInputType()
         if (current != '>')
         {
             // throw std::runtime_error("Error: Unterminated input type specification.");
-            ErrorHandler::getInstance().reportLexicalError("Unterminated input type specification.");
+            reportLexicalError("Unterminated input type specification.");
             return nullptr;
         }
         advanceCursor();
@@ -674,73 +744,76 @@ Token *Lexer::processInputType()
         else
         {
             // throw std::runtime_error("Error: Invalid input type: " + typeName);
-            ErrorHandler::getInstance().reportLexicalError("Invalid input type: " + typeName);
+            reportLexicalError("Invalid input type: " + typeName);
             return nullptr;
         }
     }
     else
     {
         // throw std::runtime_error("Error: Expected '<' for input type specification.");
-        ErrorHandler::getInstance().reportLexicalError("Expected '<' for input type specification.");
+        reportLexicalError("Expected '<' for input type specification.");
         return nullptr;
     }
 }
 
 /**
  * @brief Processes keywords and identifiers
- * @param tokens Vector of tokens processed so far (unused)
  * @return Token pointer representing the keyword or identifier
  *
- * Identifies language keywords and user-defined identifiers.
- * Special handling for "begin:" with the colon as part of the token.
+ * Scans the whole word once and resolves it through the constexpr keyword
+ * table, so no temporary strings are built while probing. "begin:" and
+ * "needs:" keep the colon as part of the token, "source:" and "library:"
+ * become directive tokens, and every other word is an identifier.
  */
 Token *Lexer::processKeyword()
 {
-    std::string keyword;
+    int start = cursor;
 
     // Collect identifier characters
     while (std::isalpha(current) || current == '_')
     {
-        keyword += current;
         advanceCursor();
     }
 
-    // Handle special case for "begin:"
-    if (keyword == "begin" && current == ':')
+    std::string_view word(source.data() + start, cursor - start);
+
+    tokenType type;
+    if (!lookupKeyword(word, type))
     {
-        advanceCursor(); // consume colon
-        return new Token{TOKEN_KEYWORD_BEGIN, "begin"};
+        return new Token{TOKEN_IDENTIFIER, std::string(word)};
     }
 
-    // Look up in keyword map
-    auto it = KeywordMap.find(keyword);
-    if (it != KeywordMap.end())
+    switch (type)
     {
-        // std::cerr << "DEBUG: Found in KeywordMap: " << keyword << " -> "
-        //           << getTokenTypeName(it->second) << std::endl;
-
-        Token *token = new Token{it->second, keyword};
+    case TOKEN_KEYWORD_BEGIN:
+        if (current == ':')
+        {
+            advanceCursor(); // consume colon
+            return new Token{TOKEN_KEYWORD_BEGIN, "begin"};
+        }
+        return new Token{TOKEN_IDENTIFIER, std::string(word)};
 
-        // Special handling for input and element keywords
-        if ((token->TYPE == TOKEN_KEYWORD_INPUT || token->TYPE == TOKEN_KEYWORD_ELEMENT) && (current == '<'))
+    case TOKEN_KEYWORD_NEEDS:
+        if (current == ':')
         {
-            if (token->TYPE == TOKEN_KEYWORD_ELEMENT)
-            {
-                isArrayType = true;
-            }
+            advanceCursor(); // consume colon
+            return new Token{TOKEN_KEYWORD_NEEDS, "needs:"};
         }
+        return new Token{TOKEN_IDENTIFIER, std::string(word)};
 
-        return token;
-    }
+    case TOKEN_HEADER_FILE:
+    case TOKEN_LIBRARY:
+        checkAndSkip();
+        if (current == ':')
+        {
+            advanceCursor(); // consume colon
+            return new Token{type, std::string(word)};
+        }
+        return new Token{TOKEN_IDENTIFIER, std::string(word)};
 
-    // If "range" or "repeat" wasn't found in the map, log that too
-    if (keyword == "range" || keyword == "repeat")
-    {
-        // std::cerr << "DEBUG: '" << keyword << "' NOT found in KeywordMap" << std::endl;
+    default:
+        return new Token{type, std::string(word)};
     }
-
-    // If not found in keyword map, it's an identifier
-    return new Token{TOKEN_IDENTIFIER, keyword};
 }
 // Token *Lexer::processKeyword()
 // {
@@ -785,136 +858,155 @@ Token *Lexer::processKeyword()
 /**
  * @brief Main tokenization method that processes the entire source code
  * @return Vector of Token pointers representing the tokenized source
- * @throws std::runtime_error if unexpected characters are encountered
  *
  * Processes the entire source code and returns a vector of tokens
- * that can be used by a parser for syntax analysis.
+ * that can be used by a parser for syntax analysis. Equivalent to
+ * calling nextToken() until it returns nullptr.
  */
 std::vector<Token *> Lexer::tokenize()
 {
     std::vector<Token *> tokens;
 
-    while (!eof())
+    while (Token *token = nextToken())
     {
-        // Skip whitespace before processing next token
-        checkAndSkip();
+        tokens.push_back(token);
+    }
+
+    return tokens;
+}
 
-        // Process different token types based on the current character
-        if (std::isalpha(current))
+/**
+ * @brief Pulls the next token from the source
+ * @return The next token, or nullptr when the input is exhausted
+ *
+ * Lexes only as far as needed to produce one token, so a Parser pulling
+ * through the TokenSource interface never holds more than its lookahead
+ * window of tokens.
+ */
+Token *Lexer::nextToken()
+{
+    while (pendingHead == pending.size())
+    {
+        pending.clear();
+        pendingHead = 0;
+
+        if (eof())
         {
-            if ((current == 't' && matchKeyword("true")) ||
-                (current == 'f' && matchKeyword("false")))
-            {
-                Token *token = processBool();
-                tokens.push_back(token);
-            }
-            else if (current == 'n' && matchKeyword("needs:"))
-            {
-                consumeKeyword("needs:");
-                tokens.push_back(new Token{TOKEN_KEYWORD_NEEDS, "needs:"});
-            }
-            else if (current == 's' && matchKeyword("source"))
-            {
-                consumeKeyword("source");
-                checkAndSkip();
-
-                if (current == ':')
-                {
-                    advanceCursor();
-                    tokens.push_back(new Token{TOKEN_HEADER_FILE, "source"});
-                }
-                else
-                {
-                    tokens.push_back(new Token{TOKEN_IDENTIFIER, "source"});
-                }
-            }
-            else if (current == 'l' && matchKeyword("library"))
-            {
-                consumeKeyword("library");
-                checkAndSkip();
-
-                // Important: Check if current is ':' exactly like you do for "source:"
-                if (current == ':')
-                {
-                    advanceCursor();                                       // Consume the colon
-                    tokens.push_back(new Token{TOKEN_LIBRARY, "library"}); // Use TOKEN_LIBRARY token type
-
-                    checkAndSkip(); // Skip whitespace before string
-
-                    // Process the string that follows
-                    if (current == '"')
-                    {
-                        Token *stringToken = processStringLiteral();
-                        tokens.push_back(stringToken);
-                    }
-                    else
-                    {
-                        ErrorHandler::getInstance().reportLexicalError("Expected string literal after 'library:'");
-                    }
-                }
-                else
-                {
-                    // If no colon, treat as a normal identifier
-                    tokens.push_back(new Token{TOKEN_IDENTIFIER, "library"});
-                }
-            }
-            else
-            {
-                // Process keywords and identifiers
-                Token *token = processKeyword();
-                tokens.push_back(token);
-
-                if (token->TYPE == TOKEN_KEYWORD_ELEMENT)
-                {
-                    isArrayType = true;
-                }
-
-                if ((token->TYPE == TOKEN_KEYWORD_INPUT || token->TYPE == TOKEN_KEYWORD_ELEMENT) && (current == '<'))
-                {
-                    Token *typeToken = processInputType();
-                    if (isArrayType)
-                    {
-                        typeToken->TYPE = TOKEN_ELEMENT_TYPE;
-                        isArrayType = false; // reset flag
-                    }
-                    tokens.push_back(typeToken);
-                }
-            }
+            return nullptr;
         }
-        else if (std::isdigit(current))
+        scanNext();
+    }
+
+    return pending[pendingHead++];
+}
+
+void Lexer::reportLexicalError(const std::string &message) const
+{
+    ErrorHandler::getInstance().reportLexicalError(message, locationBase ? locationBase + cursor : SourceMap::NO_LOCATION);
+}
+
+/**
+ * @brief Lexes one lexeme starting at the cursor into the pending queue
+ *
+ * Most lexemes produce a single token; "library:" followed by its name and
+ * input/elements followed by a <type> produce two. Trailing whitespace
+ * produces none.
+ */
+void Lexer::scanNext()
+{
+    if (!sourceRegistered)
+    {
+        locationBase = SourceMap::getInstance().registerSource(sourceName.empty() ? "<input>" : sourceName, source);
+        sourceRegistered = true;
+    }
+
+    int start = cursor; // Where the token being emitted begins
+    auto emit = [this, &start](Token *token)
+    {
+        if (token != nullptr)
         {
-            // Process numeric literals
-            Token *token = processNumber();
-            tokens.push_back(token);
+            token->location = locationBase ? locationBase + start : SourceMap::NO_LOCATION;
+            pending.push_back(token);
         }
-        else if (std::ispunct(current))
+    };
+
+    // Skip whitespace before processing next token
+    checkAndSkip();
+    start = cursor;
+
+    // Process different token types based on the current character
+    if (std::isalpha(current))
+    {
+        // Process keywords and identifiers
+        Token *token = processKeyword();
+        emit(token);
+
+        if (token->TYPE == TOKEN_LIBRARY)
         {
-            // Process punctuation and operators
+            checkAndSkip(); // Skip whitespace before string
+            start = cursor;
+
+            // Process the string that follows
             if (current == '"')
             {
-                Token *token = processStringLiteral();
-                tokens.push_back(token);
+                Token *stringToken = processStringLiteral();
+                emit(stringToken);
             }
-            else if (current == '\'')
+            else
             {
-                Token *token = processCharLiteral();
-                tokens.push_back(token);
+                reportLexicalError("Expected string literal after 'library:'");
             }
-            else
+        }
+
+        if (token->TYPE == TOKEN_KEYWORD_ELEMENT)
+        {
+            isArrayType = true;
+        }
+
+        if ((token->TYPE == TOKEN_KEYWORD_INPUT || token->TYPE == TOKEN_KEYWORD_ELEMENT) && (current == '<'))
+        {
+            start = cursor;
+            Token *typeToken = processInputType();
+            if (typeToken && isArrayType)
             {
-                Token *token = processOperator();
-                tokens.push_back(token);
+                typeToken->TYPE = TOKEN_ELEMENT_TYPE;
+                isArrayType = false; // reset flag
             }
+            emit(typeToken);
+        }
+    }
+    else if (std::isdigit(current))
+    {
+        // Process numeric literals
+        Token *token = processNumber();
+        emit(token);
+    }
+    else if (std::ispunct(current))
+    {
+        // Process punctuation and operators
+        if (current == '"')
+        {
+            Token *token = processStringLiteral();
+            emit(token);
         }
-        else if (!eof())
+        else if (current == '\'')
         {
-            // Handle unexpected characters
-            // throw std::runtime_error("Error: Unexpected character: " + std::string(1, current));
-            ErrorHandler::getInstance().reportLexicalError("Unexpected character: " + std::string(1, current));
+            Token *token = processCharLiteral();
+            emit(token);
+        }
+        else
+        {
+            Token *token = processOperator();
+            emit(token);
         }
     }
-
-    return tokens;
+    else if (!eof())
+    {
+        // Handle unexpected characters
+        // throw std::runtime_error("Error: Unexpected character: " + std::string(1, current));
+        reportLexicalError("Unexpected character: " + std::string(1, current));
+        advanceCursor();
+    }
 }
 
 /**
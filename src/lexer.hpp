@@ -1,11 +1,18 @@
 #ifndef LEXER_HPP
 #define LEXER_HPP
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <sstream>
 #include <unordered_map>
 
+#include "MemoryStats.hpp"
+#include "TokenSource.hpp"
+
+class SourceBuffer;
+
 //
 // Enum listing all possible token types recognized by the lexer.
 //
@@ -129,20 +136,44 @@ enum tokenType
 //
 struct Token
 {
-    enum tokenType TYPE; // The type of token
-    std::string value;   // The actual text (lexeme) corresponding to the token
+    enum tokenType TYPE;        // The type of token
+    std::string value;          // The actual text (lexeme) corresponding to the token
+    std::uint32_t location = 0; // SourceMap handle of the first character
+
+    // Counted under MemoryCategory::TOKENS while MemoryStats is enabled
+    static void *operator new(std::size_t size)
+    {
+        MemoryStats::allocate(MemoryCategory::TOKENS, size);
+        return ::operator new(size);
+    }
+
+    static void operator delete(void *memory, std::size_t size)
+    {
+        MemoryStats::release(MemoryCategory::TOKENS, size);
+        ::operator delete(memory);
+    }
 };
 
 //
 // Lexer class
 // Responsible for reading the source input and splitting it into tokens.
+// Tokens can be pulled one at a time (nextToken) or all at once (tokenize).
 //
-class Lexer
+class Lexer : public TokenSource
 {
 public:
     // Constructor: Takes the input source string to be tokenized
     Lexer(std::string);
 
+    // Constructor: Tokenizes a source buffer in place; the buffer must outlive the lexer
+    Lexer(const SourceBuffer &);
+
+    Lexer(const Lexer &) = delete;
+    Lexer &operator=(const Lexer &) = delete;
+
+    // Names the source in token locations; set before the first token is pulled
+    void setSourceName(const std::string &name) { sourceName = name; }
+
     // Skips any whitespace and updates the current character
     void checkAndSkip();
 
@@ -152,12 +183,6 @@ public:
     // Looks ahead in the source without advancing the cursor
     char peakAhead(int);
 
-    // Checks if the current position matches a specific keyword
-    bool matchKeyword(const std::string &);
-
-    // Consumes the keyword if it matches
-    void consumeKeyword(const std::string &);
-
     // Processors for different token types:
 
     Token *processSingleLineComment();
@@ -184,9 +209,6 @@ public:
     // Handles operators (+, -, *, /, etc.)
     Token *processOperator();
 
-    // Handles true/false statements
-    Token *processBool();
-
     // Handles numbers (integers and doubles)
     Token *processNumber();
 
@@ -199,19 +221,44 @@ public:
     // The main function to tokenize the entire input
     std::vector<Token *> tokenize();
 
+    // Pulls the next token from the input, nullptr at the end (TokenSource)
+    Token *nextToken() override;
+
+    // Pulled tokens belong to the caller
+    bool transfersOwnership() const override { return true; }
+
 private:
-    std::string source; // The input source code as a string
+    std::string ownedSource; // Backing storage when constructed from a std::string
+    std::string_view source; // The input source code being tokenized
     int cursor;         // Current position in the source
     char current;       // Current character
     int size;           // Total size of the input
 
+    std::string sourceName;          // File name recorded in token locations
+    std::uint32_t locationBase = 0;  // SourceMap handle of source[0], once registered
+    bool sourceRegistered = false;
+
     std::unordered_map<char, tokenType> singleCharMap;
     std::unordered_map<std::string, tokenType> MultiCharMap;
-    std::unordered_map<std::string, tokenType> KeywordMap;
     std::unordered_map<std::string, tokenType> TokenMap;
 
     void initializeLexerMaps();
 
+    // Shared constructor tail: resets the cursor over the current source view
+    void startAtBeginning();
+
+    // Lexes the next lexeme into pending (some lexemes yield two tokens)
+    void scanNext();
+
+    // Reports a lexical error located at the cursor
+    void reportLexicalError(const std::string &message) const;
+
+    std::vector<Token *> pending; // Tokens scanned but not yet handed out
+    std::size_t pendingHead = 0;  // Index of the next pending token
+
+    // Jumps the cursor to an absolute position and refreshes the current character
+    void moveCursorTo(int);
+
     bool isArrayType;
 };
 
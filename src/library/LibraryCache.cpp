@@ -0,0 +1,144 @@
+#include "LibraryCache.hpp"
+#include "../ProgramCache.hpp"
+#include "../SourceBuffer.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr char LIBRARY_MAGIC[4] = {'M', 'L', 'L', '\0'};
+
+    // Bump whenever the entry layout or the FlatAST image format changes
+    constexpr std::uint32_t LIBRARY_FORMAT_VERSION = 2;
+
+    /**
+     * @brief Fixed-size start of a .mllc file, followed by the FlatAST image
+     */
+    struct EntryHeader
+    {
+        char magic[4];
+        std::uint32_t formatVersion;
+        std::uint32_t nodeTypeCount;
+        std::uint32_t reserved;
+        std::int64_t modifiedTime;
+        std::uint64_t size;
+        std::uint64_t contentHash;
+    };
+
+    EntryHeader makeHeader(const SourceStamp &stamp)
+    {
+        EntryHeader header;
+        std::memcpy(header.magic, LIBRARY_MAGIC, sizeof(LIBRARY_MAGIC));
+        header.formatVersion = LIBRARY_FORMAT_VERSION;
+        header.nodeTypeCount = NODE_FLOOR + 1;
+        header.reserved = 0;
+        header.modifiedTime = stamp.modifiedTime;
+        header.size = stamp.size;
+        header.contentHash = stamp.contentHash;
+        return header;
+    }
+}
+
+LibraryCache::LibraryCache(std::string cacheDirectory)
+    : cacheDirectory(std::move(cacheDirectory)) {}
+
+/**
+ * @brief Cache file for a library: its name plus a hash of its absolute path
+ */
+std::string LibraryCache::entryPath(const std::string &libraryPath) const
+{
+    std::error_code error;
+    fs::path library = fs::absolute(libraryPath, error);
+    if (error)
+    {
+        library = libraryPath;
+    }
+
+    char hashText[17];
+    std::snprintf(hashText, sizeof(hashText), "%016llx",
+                  static_cast<unsigned long long>(ProgramCache::hashBytes(library.string())));
+
+    return (fs::path(cacheDirectory) / (library.stem().string() + "-" + hashText + ".mllc")).string();
+}
+
+bool LibraryCache::load(const std::string &libraryPath, FlatAST &library) const
+{
+    SourceStamp current;
+    if (cacheDirectory.empty() || !SourceStamp::read(libraryPath, current))
+    {
+        return false;
+    }
+
+    std::string cachePath = entryPath(libraryPath);
+    SourceBuffer entry;
+    if (!entry.open(cachePath))
+    {
+        return false;
+    }
+
+    std::string_view bytes = entry.view();
+    EntryHeader header;
+    if (bytes.size() < sizeof(header))
+    {
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, LIBRARY_MAGIC, sizeof(LIBRARY_MAGIC)) != 0 ||
+        header.formatVersion != LIBRARY_FORMAT_VERSION ||
+        header.nodeTypeCount != NODE_FLOOR + 1 ||
+        header.size != current.size)
+    {
+        return false;
+    }
+
+    // Same mtime and size: trust the entry without reading the library.
+    // Otherwise the library must still hash to what was compiled.
+    bool restamp = false;
+    if (header.modifiedTime != current.modifiedTime)
+    {
+        SourceBuffer source;
+        if (!source.open(libraryPath) || ProgramCache::hashBytes(source.view()) != header.contentHash)
+        {
+            return false;
+        }
+        restamp = true;
+    }
+
+    std::string_view image = bytes.substr(sizeof(header));
+    if (!FlatAST::deserialize(image, library))
+    {
+        return false;
+    }
+
+    if (restamp)
+    {
+        current.contentHash = header.contentHash;
+        EntryHeader updated = makeHeader(current);
+
+        std::string contents(reinterpret_cast<const char *>(&updated), sizeof(updated));
+        contents.append(image.data(), image.size());
+        ProgramCache::writeFileAtomically(cachePath, contents);
+    }
+    return true;
+}
+
+bool LibraryCache::store(const std::string &libraryPath, const SourceStamp &stamp, const FlatAST &library) const
+{
+    if (cacheDirectory.empty())
+    {
+        return false;
+    }
+
+    EntryHeader header = makeHeader(stamp);
+    std::string contents(reinterpret_cast<const char *>(&header), sizeof(header));
+    library.serialize(contents);
+
+    return ProgramCache::writeFileAtomically(entryPath(libraryPath), contents);
+}
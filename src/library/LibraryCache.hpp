@@ -0,0 +1,53 @@
+#ifndef LIBRARY_CACHE_HPP
+#define LIBRARY_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "../FlatAST.hpp"
+#include "../SourceStamp.hpp"
+
+/**
+ * @brief On-disk cache of compiled library units (.mllc files)
+ *
+ * Each .mllib file parsed by the LibraryManager can be stored as a FlatAST
+ * image along with the library's modification time, size and content hash.
+ * A load whose mtime and size still match trusts the cache without reading
+ * the library at all; if only the mtime moved (a touch or a checkout), the
+ * content hash decides and the entry is re-stamped. Entries are written via
+ * an atomic rename, so concurrent processes can share one cache directory.
+ */
+class LibraryCache
+{
+public:
+    /**
+     * @param cacheDirectory Directory holding the .mllc files (created on first store)
+     */
+    explicit LibraryCache(std::string cacheDirectory = "");
+
+    void setCacheDirectory(const std::string &directory) { cacheDirectory = directory; }
+
+    /**
+     * @brief Loads the compiled form of a library if the cache entry is current
+     * @param libraryPath Path of the .mllib file
+     * @param library Receives the library's tree on a hit
+     * @return true on a hit, false on a miss or an unreadable entry
+     */
+    bool load(const std::string &libraryPath, FlatAST &library) const;
+
+    /**
+     * @brief Stores a freshly parsed library
+     * @param libraryPath Path of the .mllib file
+     * @param stamp Modification time and size taken before parsing, and the hash of the parsed bytes
+     * @param library The parsed library
+     */
+    bool store(const std::string &libraryPath, const SourceStamp &stamp, const FlatAST &library) const;
+
+
+private:
+    std::string entryPath(const std::string &libraryPath) const;
+
+    std::string cacheDirectory;
+};
+
+#endif // LIBRARY_CACHE_HPP
@@ -2,7 +2,11 @@
 #include "../ErrorHandler.hpp"
 #include "../lexer.hpp"
 #include "../parser.hpp"
+#include "../SourceBuffer.hpp"
+#include "../ProgramCache.hpp"
+#include "../FlatAST.hpp"
 
+#include <cstdlib>
 #include <iostream>
 #include <filesystem>
 #include <fstream>
@@ -16,6 +20,25 @@ LibraryManager::LibraryManager()
 }
 LibraryManager::~LibraryManager() {}
 
+void LibraryManager::setCacheEnabled(bool enabled)
+{
+    cacheEnabled = enabled;
+    if (!enabled)
+    {
+        return;
+    }
+
+    const char *configured = std::getenv("MINILANG_CACHE_DIR");
+    if (configured != nullptr && configured[0] != '\0')
+    {
+        libraryCache.setCacheDirectory(configured);
+    }
+    else
+    {
+        libraryCache.setCacheDirectory(libraryDirectory + ".mlcache/");
+    }
+}
+
 bool LibraryManager::loadPreCompiledLibrary(const std::string &name, AST_NODE *node)
 {
     if (loadedLibraries.find(name) != loadedLibraries.end())
@@ -43,17 +66,9 @@ bool LibraryManager::loadLibrary(const std::string &name)
         return true;
     }
 
-    std::string filePath = findLibraryFile(name);
-    if (filePath.empty())
-    {
-        ErrorHandler::getInstance().reportRuntimeError("Library, not found");
-        return false; // Not found
-    }
-    // Tokenize and parse the library file.
-    AST_NODE *libraryAST = parseLibraryFile(filePath);
+    AST_NODE *libraryAST = readLibrary(name);
     if (libraryAST == nullptr)
     {
-        ErrorHandler::getInstance().reportRuntimeError("Library AST empty");
         return false;
     }
 
@@ -65,6 +80,47 @@ bool LibraryManager::loadLibrary(const std::string &name)
     return true;
 }
 
+AST_NODE *LibraryManager::readLibrary(const std::string &name)
+{
+    std::string filePath = findLibraryFile(name);
+    if (filePath.empty())
+    {
+        ErrorHandler::getInstance().reportRuntimeError("Library not found: " + name);
+        return nullptr; // Not found
+    }
+
+    FlatAST cached;
+    if (cacheEnabled && libraryCache.load(filePath, cached))
+    {
+        return cached.toTree();
+    }
+
+    // Stamp before parsing: an edit made meanwhile leaves the entry stale, not wrong
+    SourceStamp stamp;
+    bool stamped = cacheEnabled && SourceStamp::read(filePath, stamp);
+
+    // Tokenize and parse the library file.
+    std::size_t errorsBefore = ErrorHandler::getInstance().getErrors().size();
+    AST_NODE *libraryAST = parseLibraryFile(filePath, &stamp.contentHash);
+    if (libraryAST == nullptr)
+    {
+        ErrorHandler::getInstance().reportRuntimeError("Library AST empty");
+        return nullptr;
+    }
+
+    if (stamped && ErrorHandler::getInstance().getErrors().size() == errorsBefore)
+    {
+        libraryCache.store(filePath, stamp, FlatAST::fromTree(libraryAST));
+    }
+    return libraryAST;
+}
+
+bool LibraryManager::isNativeLibrary(const std::string &name)
+{
+    // Their functions are interpreter builtins, bound by name (see Interpreter::resolveBuiltinCalls)
+    return name == "Math" || name == "random" || name == "Random";
+}
+
 AST_NODE *LibraryManager::findFunction(const std::string &name)
 {
     auto it = functionRegistry.find(name);
@@ -89,38 +145,64 @@ bool LibraryManager::isLibraryLoaded(const std::string &name) const
     return loadedLibraries.find(name) != loadedLibraries.end();
 }
 
+/**
+ * @brief Lists the .mllib files in the library directory
+ *
+ * The scan is kept and reused while the directory's modification time is
+ * unchanged (adding, removing or renaming a file updates it), so repeated
+ * calls cost one stat instead of a directory walk.
+ */
 std::vector<std::string> LibraryManager::getAvailableLibraries() const
 {
-    std::vector<std::string> available;
+    std::error_code error;
+    if (!fs::is_directory(libraryDirectory, error))
+    {
+        availableLibraries.clear();
+        availableScanned = false;
+        return availableLibraries;
+    }
 
-    if (fs::exists(libraryDirectory) && fs::is_directory(libraryDirectory))
+    std::int64_t scanTime = static_cast<std::int64_t>(fs::last_write_time(libraryDirectory, error).time_since_epoch().count());
+    if (!error && availableScanned && scanTime == availableScanTime)
     {
-        for (const auto &entry : fs::directory_iterator(libraryDirectory))
+        return availableLibraries;
+    }
+
+    availableLibraries.clear();
+    for (const auto &entry : fs::directory_iterator(libraryDirectory, error))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".mllib")
         {
-            if (entry.is_regular_file() && entry.path().extension() == ".mllib")
-            {
-                available.push_back(entry.path().stem().string());
-            }
+            availableLibraries.push_back(entry.path().stem().string());
         }
     }
-    return available;
+    availableScanTime = scanTime;
+    availableScanned = !error;
+    return availableLibraries;
 }
 
 //     // Find a library file
+// The library directory comes first, then the tests directory, as for 'source:' headers
 std::string LibraryManager::findLibraryFile(const std::string &libraryName)
 {
-    std::string fullPath = libraryDirectory + libraryName + ".mllib";
+    const std::string pathsToTry[] = {
+        libraryDirectory + libraryName + ".mllib",
+        "tests/" + libraryName + ".mllib",
+        "../tests/" + libraryName + ".mllib"};
 
-    if (fs::exists(fullPath))
+    for (const std::string &fullPath : pathsToTry)
     {
-        return fullPath;
+        if (fs::exists(fullPath))
+        {
+            return fullPath;
+        }
     }
 
     return "";
 }
 
 //     // Parse a library file
-AST_NODE *LibraryManager::parseLibraryFile(const std::string &filePath)
+AST_NODE *LibraryManager::parseLibraryFile(const std::string &filePath, std::uint64_t *contentHash)
 {
     if (!fs::exists(filePath))
     {
@@ -128,22 +210,29 @@ AST_NODE *LibraryManager::parseLibraryFile(const std::string &filePath)
         return nullptr;
     }
 
-    std::ifstream libraryFile(filePath);
-    if (!libraryFile.is_open())
+    SourceBuffer sourceCode;
+    if (!sourceCode.open(filePath))
     {
         ErrorHandler::getInstance().reportRuntimeError("Unable to open library file: " + filePath);
         return nullptr;
     }
 
-    std::string sourceCode((std::istreambuf_iterator<char>(libraryFile)),
-                           std::istreambuf_iterator<char>());
-    libraryFile.close();
+    if (sourceCode.empty())
+    {
+        ErrorHandler::getInstance().reportRuntimeError("Library file is empty: " + filePath);
+        return nullptr;
+    }
+
+    if (contentHash != nullptr)
+    {
+        *contentHash = ProgramCache::hashBytes(sourceCode.view());
+    }
 
     Lexer lexer(sourceCode);
-    std::vector<Token *> tokens = lexer.tokenize();
 
+    // Libraries are declaration-only units, parsed like headers (no begin/end)
     AST_NODE *ast = nullptr;
-    Parser parser(tokens);
+    Parser parser(lexer, true);
     ast = parser.parse();
 
     return ast;
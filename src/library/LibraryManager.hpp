@@ -1,10 +1,12 @@
 #ifndef LIBRARY_MANAGER_HPP
 #define LIBRARY_MANAGER_HPP
 
+#include <cstdint>
 #include <iostream>
 #include <unordered_map>
 #include <unordered_set>
 #include "../parser.hpp"
+#include "LibraryCache.hpp"
 
 class LibraryManager
 {
@@ -24,11 +26,17 @@ private:
     // Single directory for libraries
     std::string libraryDirectory;
 
-    // Find a library file
-    std::string findLibraryFile(const std::string &libraryName);
+    // Compiled library units on disk, used when caching is enabled
+    LibraryCache libraryCache;
+    bool cacheEnabled = false;
+
+    // Result of the last directory scan, reused until the directory changes
+    mutable std::vector<std::string> availableLibraries;
+    mutable std::int64_t availableScanTime = 0;
+    mutable bool availableScanned = false;
 
-    // Parse a library file
-    AST_NODE *parseLibraryFile(const std::string &filePath);
+    // Parse a library file, optionally reporting the hash of the bytes parsed
+    AST_NODE *parseLibraryFile(const std::string &filePath, std::uint64_t *contentHash = nullptr);
 
     // Register all functions in a library
     void registerLibraryFunctions(const std::string &libraryName, AST_NODE *libraryAST);
@@ -41,6 +49,21 @@ public:
     bool loadPreCompiledLibrary(const std::string &name, AST_NODE *node);
     bool loadLibrary(const std::string &name);
 
+    // Path of a library's .mllib file, or an empty string if there is none
+    std::string findLibraryFile(const std::string &libraryName);
+
+    /**
+     * @brief Parses a .mllib library, or loads it from the cache when enabled
+     * @return A tree the caller owns, or nullptr after reporting a runtime error
+     */
+    AST_NODE *readLibrary(const std::string &name);
+
+    // Libraries implemented in C++ rather than by a .mllib file
+    static bool isNativeLibrary(const std::string &name);
+
+    // Reuse compiled libraries from $MINILANG_CACHE_DIR or <library dir>/.mlcache/
+    void setCacheEnabled(bool enabled);
+
     AST_NODE *findFunction(const std::string &name);
 
     void registerBuiltinFunction(const std::string &name, AST_NODE *node);
@@ -54,11 +77,35 @@ public:
     AST_NODE *generateRandomAST();
     AST_NODE *generateMathAST();
 
+    /**
+     * @brief The calling thread's scoped manager, else the process-wide one
+     */
     static LibraryManager &getInstance()
     {
+        if (current != nullptr)
+        {
+            return *current;
+        }
         static LibraryManager instance;
         return instance;
     }
+
+    // Makes a manager the calling thread's getInstance() until destroyed
+    class Scope
+    {
+    public:
+        explicit Scope(LibraryManager &manager) : previous(current) { current = &manager; }
+        ~Scope() { current = previous; }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        LibraryManager *previous;
+    };
+
+private:
+    static inline thread_local LibraryManager *current = nullptr;
 };
 
 #endif // LIBRARY_MANAGER_HPP
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "LibraryTable.hpp"
+#include "LibraryManager.hpp"
+#include "../ErrorHandler.hpp"
+#include "../interperter.hpp"
+
+#include <algorithm>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+bool LibraryTable::load(AST_NODE *root, bool useCache, std::string &error)
+{
+    std::vector<std::string> imports;
+    collectImports(root, imports);
+
+    // A handler of our own, so a missing library is reported to the caller
+    ErrorHandler errors;
+    errors.setEcho(false);
+    ErrorHandler::Scope errorScope(errors);
+    LibraryManager loader;
+    loader.setCacheEnabled(useCache);
+    LibraryUnitCache &unitCache = LibraryUnitCache::getInstance();
+
+    for (const std::string &name : imports)
+    {
+        if (LibraryManager::isNativeLibrary(name) ||
+            std::find(names.begin(), names.end(), name) != names.end())
+        {
+            continue;
+        }
+
+        std::string path = loader.findLibraryFile(name);
+        std::error_code canonicalError;
+        std::string canonicalPath = path.empty() ? "" : fs::canonical(path, canonicalError).string();
+        if (path.empty() || canonicalError)
+        {
+            error = "Library not found: " + name + "\n";
+            return false;
+        }
+
+        std::shared_ptr<const LibraryUnitCache::Unit> unit = unitCache.find(canonicalPath);
+        if (!unit)
+        {
+            AST_NODE *library = nullptr;
+            try
+            {
+                library = loader.readLibrary(name);
+            }
+            catch (const ErrorHandler::RuntimeError &)
+            {
+                // Already recorded
+            }
+
+            if (library == nullptr || errors.hasError())
+            {
+                deleteTree(library); // The partial tree
+                error = errors.getErrorReport();
+                return false;
+            }
+
+            Interpreter::resolveBuiltinCalls(library);
+            unit = unitCache.insert(canonicalPath, library);
+        }
+
+        names.push_back(name);
+        roots.push_back(unit->root);
+        units.push_back(unit);
+    }
+    return true;
+}
+
+void LibraryTable::collectImports(const AST_NODE *node, std::vector<std::string> &imports)
+{
+    if (node == nullptr)
+    {
+        return;
+    }
+
+    // Imports only appear in top-level 'needs:' blocks, of the program or of a header
+    for (const AST_NODE *statement : node->SUB_STATEMENTS)
+    {
+        if (statement->TYPE != NODE_NEEDS_BLOCK)
+        {
+            continue;
+        }
+        for (const AST_NODE *need : statement->SUB_STATEMENTS)
+        {
+            if (need->TYPE == NODE_IMPORT_LIBRARY)
+            {
+                imports.push_back(need->VALUE);
+            }
+            else if (need->TYPE == NODE_READ_HEADER)
+            {
+                collectImports(need->CHILD, imports);
+            }
+        }
+    }
+}
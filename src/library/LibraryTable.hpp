@@ -0,0 +1,54 @@
+#ifndef LIBRARY_TABLE_HPP
+#define LIBRARY_TABLE_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../parser.hpp"
+#include "LibraryUnitCache.hpp"
+
+/**
+ * @brief The .mllib libraries one program imports, loaded before it runs
+ *
+ * load() walks the program's 'needs:' blocks, headers included, and takes
+ * each imported library from the LibraryUnitCache, loading it there first
+ * if needed. After that the table is only read: a Program owns one and
+ * every ExecutionContext running the program calls into the same library
+ * trees, as does every other program in the process importing the same
+ * library. Nothing is re-parsed per run, per context or per script. Native
+ * libraries (Math, Random) have no tree; their functions are interpreter
+ * builtins.
+ */
+class LibraryTable
+{
+public:
+    LibraryTable() = default;
+
+    LibraryTable(const LibraryTable &) = delete;
+    LibraryTable &operator=(const LibraryTable &) = delete;
+
+    /**
+     * @brief Loads every library the tree imports with 'library:'
+     * @param root The program's tree, with its headers attached
+     * @param useCache Reuse compiled libraries from .mllc files (see LibraryCache)
+     * @param error Receives the error report when false is returned
+     * @return false if a library cannot be found or has errors
+     */
+    bool load(AST_NODE *root, bool useCache, std::string &error);
+
+    // Library trees in import order, bound to the builtins; their procs are looked up after the script's own
+    const std::vector<AST_NODE *> &getRoots() const { return roots; }
+
+    // Names of the loaded .mllib libraries, parallel to getRoots()
+    const std::vector<std::string> &getNames() const { return names; }
+
+private:
+    static void collectImports(const AST_NODE *node, std::vector<std::string> &imports);
+
+    std::vector<std::string> names;
+    std::vector<AST_NODE *> roots;
+    std::vector<std::shared_ptr<const LibraryUnitCache::Unit>> units; // Own the roots
+};
+
+#endif // LIBRARY_TABLE_HPP
@@ -0,0 +1,57 @@
+#include "LibraryUnitCache.hpp"
+
+LibraryUnitCache::Unit::~Unit()
+{
+    deleteTree(root);
+}
+
+std::shared_ptr<const LibraryUnitCache::Unit> LibraryUnitCache::find(const std::string &canonicalPath)
+{
+    std::shared_ptr<const Unit> unit;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = units.find(canonicalPath);
+        if (it == units.end())
+        {
+            return nullptr;
+        }
+        unit = it->second;
+    }
+
+    // Stat outside the lock; a stale unit is simply loaded again
+    SourceStamp stamp;
+    if (!SourceStamp::read(canonicalPath, stamp) || !stamp.sameFile(unit->stamp))
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = units.find(canonicalPath);
+        if (it != units.end() && it->second == unit)
+        {
+            units.erase(it);
+        }
+        return nullptr;
+    }
+    return unit;
+}
+
+std::shared_ptr<const LibraryUnitCache::Unit> LibraryUnitCache::insert(const std::string &canonicalPath,
+                                                                       AST_NODE *root)
+{
+    auto unit = std::make_shared<Unit>();
+    unit->root = root;
+
+    bool stamped = SourceStamp::read(canonicalPath, unit->stamp);
+
+    std::shared_ptr<const Unit> shared = unit;
+    if (stamped)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        units[canonicalPath] = shared;
+    }
+    return shared;
+}
+
+void LibraryUnitCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    units.clear();
+}
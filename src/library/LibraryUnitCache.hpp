@@ -0,0 +1,71 @@
+#ifndef LIBRARY_UNIT_CACHE_HPP
+#define LIBRARY_UNIT_CACHE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "../parser.hpp"
+#include "../SourceStamp.hpp"
+
+/**
+ * @brief Process-wide cache of loaded .mllib libraries
+ *
+ * The in-memory counterpart of LibraryCache, as HeaderCache is for
+ * headers: a library imported by many programs in one process (a batch
+ * run, an embedding host) is parsed, or read from its .mllc file, once.
+ * Units are keyed by canonical path and dropped when the file's
+ * modification time or size changes. A unit's tree is bound to the
+ * builtins before it is inserted and never modified afterwards, so every
+ * Program importing the library calls into the same tree.
+ */
+class LibraryUnitCache
+{
+public:
+    /**
+     * @brief One library, ready to execute
+     */
+    struct Unit
+    {
+        Unit() = default;
+        ~Unit();
+
+        Unit(const Unit &) = delete;
+        Unit &operator=(const Unit &) = delete;
+
+        AST_NODE *root = nullptr; // Owned
+        SourceStamp stamp;        // Of the .mllib file when it was loaded
+    };
+
+    static LibraryUnitCache &getInstance()
+    {
+        static LibraryUnitCache instance;
+        return instance;
+    }
+
+    /**
+     * @brief Looks up a library
+     * @param canonicalPath Canonical path of the .mllib file
+     * @return The unit, or nullptr if absent or if the file changed on disk
+     */
+    std::shared_ptr<const Unit> find(const std::string &canonicalPath);
+
+    /**
+     * @brief Takes ownership of a freshly loaded library tree and records it
+     * @return The unit (a file that cannot be stamped is returned but not kept)
+     */
+    std::shared_ptr<const Unit> insert(const std::string &canonicalPath, AST_NODE *root);
+
+    // Drops every unit
+    void clear();
+
+private:
+    LibraryUnitCache() = default;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<const Unit>> units;
+};
+
+#endif // LIBRARY_UNIT_CACHE_HPP
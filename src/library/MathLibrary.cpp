@@ -0,0 +1,246 @@
+#include "MathLibrary.hpp"
+#include "../dynamic_array.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    using mathlib::BinaryOp;
+    using mathlib::Status;
+    using mathlib::UnaryOp;
+
+    /**
+     * @brief Copies an array's numeric elements into a contiguous buffer
+     * @return false if any element is not a number
+     */
+    bool unpack(const DynamicArray &array, std::vector<double> &values)
+    {
+        const std::vector<Value> &elements = array.getElements();
+        values.resize(elements.size());
+        for (std::size_t i = 0; i < elements.size(); i++)
+        {
+            const Value &element = elements[i];
+            if (element.isDouble())
+            {
+                values[i] = element.asDouble();
+            }
+            else if (element.isInt())
+            {
+                values[i] = static_cast<double>(element.asInt());
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Value pack(const std::vector<double> &values)
+    {
+        std::vector<Value> elements;
+        elements.reserve(values.size());
+        for (double value : values)
+        {
+            elements.emplace_back(value);
+        }
+        return Value(std::make_shared<DynamicArray>(std::move(elements)));
+    }
+
+    /**
+     * @brief One argument of an array call as doubles; a number is held as a single value
+     */
+    struct Operand
+    {
+        std::vector<double> values;
+        bool isArray = false;
+    };
+
+    Status load(const Value &argument, Operand &operand)
+    {
+        if (argument.isArray())
+        {
+            operand.isArray = true;
+            return unpack(*argument.asArray(), operand.values) ? Status::OK : Status::NOT_NUMERIC;
+        }
+        if (argument.isNumeric())
+        {
+            operand.values.assign(1, argument.asDoubleSafe());
+            return Status::OK;
+        }
+        return Status::NOT_NUMERIC;
+    }
+
+    // The loops below are instantiated once per operation, so each is a
+    // plain loop over doubles with the operation inlined.
+    template <typename Function>
+    void transform(std::vector<double> &values, Function function)
+    {
+        for (double &value : values)
+        {
+            value = function(value);
+        }
+    }
+
+    template <typename Function>
+    void combine(std::vector<double> &out, const Operand &left, const Operand &right, Function function)
+    {
+        const double *a = left.values.data();
+        const double *b = right.values.data();
+        const std::size_t count = out.size();
+
+        if (left.isArray && right.isArray)
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                out[i] = function(a[i], b[i]);
+            }
+        }
+        else if (left.isArray)
+        {
+            const double scalar = b[0];
+            for (std::size_t i = 0; i < count; i++)
+            {
+                out[i] = function(a[i], scalar);
+            }
+        }
+        else
+        {
+            const double scalar = a[0];
+            for (std::size_t i = 0; i < count; i++)
+            {
+                out[i] = function(scalar, b[i]);
+            }
+        }
+    }
+
+    // The number forms, computed directly with no buffer
+    double applyUnary(UnaryOp op, double x)
+    {
+        switch (op)
+        {
+        case UnaryOp::ABS:
+            return std::fabs(x);
+        case UnaryOp::SQRT:
+            return std::sqrt(x);
+        case UnaryOp::CEIL:
+            return std::ceil(x);
+        case UnaryOp::FLOOR:
+            return std::floor(x);
+        }
+        return x;
+    }
+
+    double applyBinary(BinaryOp op, double x, double y)
+    {
+        switch (op)
+        {
+        case BinaryOp::POW:
+            return std::pow(x, y);
+        case BinaryOp::MIN:
+            return std::min(x, y);
+        case BinaryOp::MAX:
+            return std::max(x, y);
+        }
+        return x;
+    }
+
+    void applyUnary(UnaryOp op, std::vector<double> &values)
+    {
+        switch (op)
+        {
+        case UnaryOp::ABS:
+            transform(values, [](double x) { return std::fabs(x); });
+            break;
+        case UnaryOp::SQRT:
+            transform(values, [](double x) { return std::sqrt(x); });
+            break;
+        case UnaryOp::CEIL:
+            transform(values, [](double x) { return std::ceil(x); });
+            break;
+        case UnaryOp::FLOOR:
+            transform(values, [](double x) { return std::floor(x); });
+            break;
+        }
+    }
+
+    void applyBinary(BinaryOp op, std::vector<double> &out, const Operand &left, const Operand &right)
+    {
+        switch (op)
+        {
+        case BinaryOp::POW:
+            combine(out, left, right, [](double x, double y) { return std::pow(x, y); });
+            break;
+        case BinaryOp::MIN:
+            combine(out, left, right, [](double x, double y) { return std::min(x, y); });
+            break;
+        case BinaryOp::MAX:
+            combine(out, left, right, [](double x, double y) { return std::max(x, y); });
+            break;
+        }
+    }
+}
+
+namespace mathlib
+{
+    Status apply(UnaryOp op, const Value &argument, Value &result)
+    {
+        if (!argument.isArray())
+        {
+            if (!argument.isNumeric())
+            {
+                return Status::NOT_NUMERIC;
+            }
+            result = Value(applyUnary(op, argument.asDoubleSafe()));
+            return Status::OK;
+        }
+
+        Operand operand;
+        Status status = load(argument, operand);
+        if (status != Status::OK)
+        {
+            return status;
+        }
+
+        applyUnary(op, operand.values);
+        result = pack(operand.values);
+        return Status::OK;
+    }
+
+    Status apply(BinaryOp op, const Value &left, const Value &right, Value &result)
+    {
+        if (!left.isArray() && !right.isArray())
+        {
+            if (!left.isNumeric() || !right.isNumeric())
+            {
+                return Status::NOT_NUMERIC;
+            }
+            result = Value(applyBinary(op, left.asDoubleSafe(), right.asDoubleSafe()));
+            return Status::OK;
+        }
+
+        Operand a, b;
+        Status status = load(left, a);
+        if (status == Status::OK)
+        {
+            status = load(right, b);
+        }
+        if (status != Status::OK)
+        {
+            return status;
+        }
+
+        if (a.isArray && b.isArray && a.values.size() != b.values.size())
+        {
+            return Status::LENGTH_MISMATCH;
+        }
+
+        std::vector<double> out(a.isArray ? a.values.size() : b.values.size());
+        applyBinary(op, out, a, b);
+        result = pack(out);
+        return Status::OK;
+    }
+}
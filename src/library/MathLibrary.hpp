@@ -0,0 +1,55 @@
+#ifndef MATH_LIBRARY_HPP
+#define MATH_LIBRARY_HPP
+
+#include "../Value.hpp"
+
+/**
+ * @brief Native implementation of the Math library
+ *
+ * Every function accepts a number or an array of numbers. Arrays are
+ * processed elementwise in one native loop: the elements are unpacked into
+ * a contiguous buffer of doubles, transformed, and packed into a new
+ * array, so no AST is walked per element. Binary functions also accept an
+ * array with a number, which is applied to every element. Calls on plain
+ * numbers skip the buffers and call the <cmath> function directly.
+ *
+ * Results are doubles, as they always were for the scalar builtins.
+ */
+namespace mathlib
+{
+    enum class UnaryOp
+    {
+        ABS,
+        SQRT,
+        CEIL,
+        FLOOR
+    };
+
+    enum class BinaryOp
+    {
+        POW,
+        MIN,
+        MAX
+    };
+
+    enum class Status
+    {
+        OK,
+        NOT_NUMERIC,    // An argument (or an array element) is not a number
+        LENGTH_MISMATCH // Two array arguments differ in length
+    };
+
+    /**
+     * @brief Applies a one-argument function to a number or to each element of an array
+     * @param result Receives a double or a new array of doubles on success
+     */
+    Status apply(UnaryOp op, const Value &argument, Value &result);
+
+    /**
+     * @brief Applies a two-argument function to numbers, arrays, or an array and a number
+     * @param result Receives a double or a new array of doubles on success
+     */
+    Status apply(BinaryOp op, const Value &left, const Value &right, Value &result);
+}
+
+#endif // MATH_LIBRARY_HPP
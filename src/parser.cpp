@@ -2,13 +2,96 @@
 #include "lexer.hpp"
 #include "dynamic_array.hpp"
 #include "ErrorHandler.hpp"
+#include "SourceBuffer.hpp"
+#include "HeaderCache.hpp"
+#include "Log.hpp"
+#include "SourceLocation.hpp"
 #include <iostream>
 
 #include <vector>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
 #include <fstream>
+
+Parser::Parser(std::vector<Token *> tokens, bool isHeader)
+    : ownedSource(new VectorTokenSource(std::move(tokens))),
+      source(ownedSource.get()),
+      ownsTokens(false)
+{
+    cursor = 0;
+    current = tokenAt(0);
+    this->isHeader = isHeader;
+
+    initializeParserMaps();
+}
+
+Parser::Parser(TokenSource &source, bool isHeader)
+    : source(&source),
+      ownsTokens(source.transfersOwnership())
+{
+    cursor = 0;
+    current = tokenAt(0);
+    this->isHeader = isHeader;
+
+    initializeParserMaps();
+}
+
+/**
+ * @brief Releases any tokens still held in the lookahead window
+ */
+Parser::~Parser()
+{
+    if (ownsTokens)
+    {
+        for (Token *token : window)
+        {
+            delete token;
+        }
+    }
+}
+
+Token *Parser::tokenAt(size_t index)
+{
+    if (index < windowStart)
+    {
+        return nullptr;
+    }
+
+    while (index >= windowStart + window.size() && !sourceExhausted)
+    {
+        Token *next = source->nextToken();
+        if (next == nullptr)
+        {
+            sourceExhausted = true;
+            break;
+        }
+        window.push_back(next);
+    }
+
+    if (index < windowStart + window.size())
+    {
+        return window[index - windowStart];
+    }
+    return nullptr;
+}
+
+void Parser::releaseConsumedTokens()
+{
+    while (!window.empty() && windowStart + 1 < cursor)
+    {
+        if (ownsTokens)
+        {
+            delete window.front();
+        }
+        window.pop_front();
+        windowStart++;
+    }
+}
+
 /**
  * @brief Initialize the maps used by the parser
  */
@@ -72,7 +155,7 @@ void Parser::initializeParserMaps()
     expressionDispatch = {
         {TOKEN_INTEGER_VAL, &Parser::parseIntegerValue},
         {TOKEN_IDENTIFIER, &Parser::parseID},
-        {TOKEN_LEFT_PAREN, &Parser::parseLeftParen},
+        {TOKEN_LEFT_PAREN, &Parser::parseParenExpression},
         {TOKEN_CHAR_VAL, &Parser::parseCharValue},
         {TOKEN_STRING_VAL, &Parser::parseStringValue},
         {TOKEN_DOUBLE_VAL, &Parser::parseDoubleValue},
@@ -179,20 +262,28 @@ Parser::parseByTokenType(const std::unordered_map<tokenType, ParseFunction> &dis
     auto it = dispatchTable.find(current->TYPE);
     if (it != dispatchTable.end())
     {
-        return (this->*(it->second))();
+        // Many parse functions build their node only after consuming the
+        // leading tokens, so locate the result at the token it started from
+        std::uint32_t start = current->location;
+        AST_NODE *node = (this->*(it->second))();
+        if (node != nullptr && start != SourceMap::NO_LOCATION)
+        {
+            node->LOCATION = start;
+        }
+        return node;
     }
     else
     {
         // std::cerr << "Unexpected Token: " + getTokenTypeName(current->TYPE);
         // exit(1);
-        ErrorHandler::getInstance().reportRuntimeError("Unexpected Token: " + getTokenTypeName(current->TYPE));
+        ErrorHandler::getInstance().reportRuntimeError("Unexpected Token: " + getTokenTypeName(current->TYPE), current->location);
         return nullptr;
     }
 }
 
 AST_NODE *Parser::parseSingleLineComment()
 {
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_COMMENT;
     node->VALUE = current->value;
     advanceCursor();
@@ -201,7 +292,7 @@ AST_NODE *Parser::parseSingleLineComment()
 
 AST_NODE *Parser::parseMultiLineComment()
 {
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_COMMENT;
     node->VALUE = current->value;
     advanceCursor();
@@ -219,39 +310,27 @@ AST_NODE *Parser::parseMultiLineComment()
  */
 Token *Parser::proceed(enum tokenType type)
 {
-    // std::cout << "About to proceed: Expected " << getTokenTypeName(type)
-    //           << ", Got " << getTokenTypeName(tokens[cursor]->TYPE)
-    //           << ", Value: " << tokens[cursor]->value << std::endl;
+    Token *token = tokenAt(cursor);
 
     // Check for end of file
-    if (cursor >= size)
+    if (token == nullptr)
     {
-        // std::cerr << "< Syntax Error > Unexpected end of file" << std::endl;
-        // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Unexpected end of file");
+        reportSyntaxError("Unexpected end of file");
+        current = nullptr;
+        return nullptr;
     }
 
     // Validate token type
-    if (tokens[cursor]->TYPE != type)
+    if (token->TYPE != type)
     {
-        // std::cerr << "< Syntax Error > Expected " << getTokenTypeName(type)
-        //           << " but got " << getTokenTypeName(tokens[cursor]->TYPE) << std::endl;
-        // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected: " + getTokenTypeName(type) + " but got: " + getTokenTypeName(tokens[cursor]->TYPE));
+        ErrorHandler::getInstance().reportSyntaxError("Expected: " + getTokenTypeName(type) + " but got: " + getTokenTypeName(token->TYPE),
+                                                      token->location);
     }
 
-    // Advance cursor
+    // Advance cursor and update current token pointer
     cursor++;
-
-    // Update current token pointer
-    if (cursor < size)
-    {
-        current = tokens[cursor];
-    }
-    else
-    {
-        current = nullptr;
-    }
+    current = tokenAt(cursor);
+    releaseConsumedTokens();
 
     return current;
 }
@@ -272,30 +351,37 @@ Token *Parser::getCurrentToken()
  */
 void Parser::advanceCursor()
 {
-    if (cursor < size)
+    if (tokenAt(cursor) == nullptr)
     {
-        cursor++;
-        current = tokens[cursor];
+        current = nullptr;
+        return;
+    }
 
-        while (current && (current->TYPE == TOKEN_SINGLELINE_COMMENT ||
-                           current->TYPE == TOKEN_MULTILINE_COMMENT))
-        {
-            if (cursor < size)
-            {
-                cursor++;
-                current = tokens[cursor];
-            }
-            else
-            {
-                current = nullptr;
-                break;
-            }
-        }
+    cursor++;
+    current = tokenAt(cursor);
+
+    while (current && (current->TYPE == TOKEN_SINGLELINE_COMMENT ||
+                       current->TYPE == TOKEN_MULTILINE_COMMENT))
+    {
+        cursor++;
+        current = tokenAt(cursor);
     }
-    else
+    releaseConsumedTokens();
+}
+
+AST_NODE *Parser::newNode()
+{
+    AST_NODE *node = new AST_NODE();
+    if (current != nullptr)
     {
-        current = nullptr;
+        node->LOCATION = current->location;
     }
+    return node;
+}
+
+void Parser::reportSyntaxError(const std::string &message) const
+{
+    ErrorHandler::getInstance().reportSyntaxError(message, current != nullptr ? current->location : SourceMap::NO_LOCATION);
 }
 
 /**
@@ -306,15 +392,7 @@ void Parser::advanceCursor()
  */
 Token *Parser::peakAhead()
 {
-    // Check if we can look ahead
-    if (cursor + 1 < size)
-    {
-        return tokens[cursor + 1];
-    }
-    else
-    {
-        return nullptr;
-    }
+    return tokenAt(cursor + 1);
 }
 
 //------------------------------------------------------------------
@@ -327,7 +405,7 @@ Token *Parser::peakAhead()
 //     readHeader->VALUE = "@once";
 //     if (!proceed(TOKEN_READ_HEADER))
 //     {
-//         ErrorHandler::getInstance().reportSyntaxError("Expected '@once' directive");
+//         reportSyntaxError("Expected '@once' directive");
 //         return nullptr;
 //     }
 
@@ -340,21 +418,21 @@ Token *Parser::peakAhead()
 //     endHeader->VALUE = "@last";
 //     if (!proceed(TOKEN_END_HEADER))
 //     {
-//         ErrorHandler::getInstance().reportSyntaxError("Expected '@last' directive.");
+//         reportSyntaxError("Expected '@last' directive.");
 //         return nullptr;
 //     }
 //     return endHeader;
 // }
 AST_NODE *Parser::parseReadHeader()
 {
-    AST_NODE *readHeader = new AST_NODE();
+    AST_NODE *readHeader = newNode();
     readHeader->TYPE = NODE_READ_HEADER;
     readHeader->VALUE = "@once";
     if (!proceed(TOKEN_READ_HEADER))
     {
         if (!isHeader)
         {
-            ErrorHandler::getInstance().reportSyntaxError("Expected '@once' directive");
+            reportSyntaxError("Expected '@once' directive");
         }
         return nullptr;
     }
@@ -363,14 +441,14 @@ AST_NODE *Parser::parseReadHeader()
 }
 AST_NODE *Parser::parseEndHeader()
 {
-    AST_NODE *endHeader = new AST_NODE();
+    AST_NODE *endHeader = newNode();
     endHeader->TYPE = NODE_END_HEADER;
     endHeader->VALUE = "@last";
     if (!proceed(TOKEN_END_HEADER))
     {
         if (!isHeader)
         {
-            ErrorHandler::getInstance().reportSyntaxError("Expected '@last' directive.");
+            reportSyntaxError("Expected '@last' directive.");
         }
         return nullptr;
     }
@@ -391,7 +469,7 @@ AST_NODE *Parser::parseDoubleValue()
     std::string doubleValue = current->value;
     proceed(TOKEN_DOUBLE_VAL);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_DOUBLE_LITERAL;
     node->VALUE = doubleValue;
 
@@ -412,7 +490,7 @@ AST_NODE *Parser::parseKeywordDouble()
     std::string identifierName = current->value;
     proceed(TOKEN_IDENTIFIER);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_DOUBLE;
     node->VALUE = identifierName;
 
@@ -439,7 +517,7 @@ AST_NODE *Parser::parseKeywordDouble()
  */
 AST_NODE *Parser::parseStringValue()
 {
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
 
     if (current->TYPE == TOKEN_STRING_VAL)
     {
@@ -469,7 +547,7 @@ AST_NODE *Parser::parseStringValue()
     {
         // std::cerr << "Unexpected token in string expression" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Unexpected token in string expression.");
+        reportSyntaxError("Unexpected token in string expression.");
     }
     return node;
 }
@@ -487,7 +565,7 @@ AST_NODE *Parser::parseKeywordChar()
     std::string identifierName = current->value;
     proceed(TOKEN_IDENTIFIER);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_CHAR;
     node->VALUE = identifierName;
 
@@ -516,7 +594,7 @@ AST_NODE *Parser::parseCharValue()
     std::string charValue = current->value;
     proceed(TOKEN_CHAR_VAL);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_CHAR_LITERAL;
     node->VALUE = charValue;
 
@@ -529,7 +607,7 @@ AST_NODE *Parser::parseCharValue()
  */
 AST_NODE *Parser::parseBoolValue()
 {
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_BOOL_LITERAL;
     node->VALUE = current->value;
 
@@ -545,7 +623,7 @@ AST_NODE *Parser::parseBoolValue()
  */
 AST_NODE *Parser::parseIntegerValue()
 {
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_INT_LITERAL;
     node->VALUE = current->value;
 
@@ -568,7 +646,7 @@ AST_NODE *Parser::parseKeywordINT()
     std::string variableName = current->value;
     proceed(TOKEN_IDENTIFIER);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_INT;
     node->VALUE = variableName;
 
@@ -593,7 +671,7 @@ AST_NODE *Parser::parseNewLine()
 {
     proceed(TOKEN_OPERATOR_NEWLINE);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_NEWLINE;
 
     return node;
@@ -606,14 +684,14 @@ AST_NODE *Parser::parseArrayDeclaration()
 {
     proceed(TOKEN_KEYWORD_ELEMENT);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_ARRAY_DECLARATION;
 
     if (current->TYPE != TOKEN_ELEMENT_TYPE)
     {
         // std::cerr << "< Syntax Error > Expected element type after 'elements'" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected element type after keyword 'elements'");
+        reportSyntaxError("Expected element type after keyword 'elements'");
     }
 
     std::string elementType = current->value;
@@ -624,14 +702,14 @@ AST_NODE *Parser::parseArrayDeclaration()
         // std::cerr << "< Syntax Error > Expected array name after type." << std::endl;
         // exit(1);
 
-        ErrorHandler::getInstance().reportSyntaxError("Expected array identifier after type.");
+        reportSyntaxError("Expected array identifier after type.");
     }
 
     std::string arrayName = current->value;
     proceed(TOKEN_IDENTIFIER);
     node->VALUE = arrayName;
 
-    AST_NODE *typeNode = new AST_NODE();
+    AST_NODE *typeNode = newNode();
     typeNode->TYPE = NODE_ELEMENT_TYPE;
     typeNode->VALUE = elementType;
     node->CHILD = typeNode;
@@ -641,7 +719,7 @@ AST_NODE *Parser::parseArrayDeclaration()
 
 AST_NODE *Parser::parseArrayInit()
 {
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_ARRAY_INIT;
     node->VALUE = current->value;
 
@@ -653,7 +731,7 @@ AST_NODE *Parser::parseArrayInit()
         // std::cerr << "< Syntax Error > Expected '|=' following array identifier" << std::endl;
         // exit(1);
 
-        ErrorHandler::getInstance().reportSyntaxError("Expected '|=' following array identifier.");
+        reportSyntaxError("Expected '|=' following array identifier.");
     }
 
     proceed(TOKEN_ARRAY_INITIALIZER);
@@ -662,7 +740,7 @@ AST_NODE *Parser::parseArrayInit()
     {
         // std::cerr << "< Syntax Error > Expected '(' to being initializing array" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '(' following '|=' to initialize array.");
+        reportSyntaxError("Expected '(' following '|=' to initialize array.");
     }
 
     proceed(TOKEN_LEFT_PAREN);
@@ -679,7 +757,7 @@ AST_NODE *Parser::parseArrayInit()
     {
         // std::cerr << "< Syntax Error > Expected closing parenthesis after array initialization" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected closing parenthesis after array initialization.");
+        reportSyntaxError("Expected closing parenthesis after array initialization.");
     }
 
     proceed(TOKEN_RIGHT_PAREN);
@@ -687,7 +765,7 @@ AST_NODE *Parser::parseArrayInit()
 }
 AST_NODE *Parser::parseArrayRange()
 {
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_ARRAY_RANGE;
     node->VALUE = current->value;
 
@@ -697,7 +775,7 @@ AST_NODE *Parser::parseArrayRange()
     {
         // std::cerr << "< Syntax Error > Expected '=' to initialize the array with a range" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '=' to initialize the array with a range.");
+        reportSyntaxError("Expected '=' to initialize the array with a range.");
     }
 
     proceed(TOKEN_EQUALS);
@@ -706,7 +784,7 @@ AST_NODE *Parser::parseArrayRange()
     {
         // std::cerr << "< Syntax Error > Expected keyword range." << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected keyword 'range'.");
+        reportSyntaxError("Expected keyword 'range'.");
     }
 
     // Directly parse the range expression (including parentheses)
@@ -716,7 +794,7 @@ AST_NODE *Parser::parseArrayRange()
 }
 AST_NODE *Parser::parseArrayRepeat()
 {
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_ARRAY_REPEAT;
     node->VALUE = current->value;
 
@@ -726,7 +804,7 @@ AST_NODE *Parser::parseArrayRepeat()
     {
         // std::cerr << "< Syntax Error > Expected '=' to initialize the array with a range" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '=' to initialize the array with a range.");
+        reportSyntaxError("Expected '=' to initialize the array with a range.");
     }
 
     proceed(TOKEN_ARRAY_INITIALIZER);
@@ -735,7 +813,7 @@ AST_NODE *Parser::parseArrayRepeat()
     {
         // std::cerr << "< Syntax Error > Expected keyword repeat.";
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected keyword 'repeat'");
+        reportSyntaxError("Expected keyword 'repeat'");
     }
 
     proceed(TOKEN_LEFT_PAREN);
@@ -747,7 +825,7 @@ AST_NODE *Parser::parseArrayRepeat()
     {
         // std::cerr << "< Syntax Error > Expected ',' seperating repeat value and amount." << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected ',' seperating repeat value and amount.");
+        reportSyntaxError("Expected ',' seperating repeat value and amount.");
     }
 
     proceed(TOKEN_COMMA);
@@ -759,7 +837,7 @@ AST_NODE *Parser::parseArrayRepeat()
     {
         // std::cerr << "< Syntax Error > Expected closing parenthesis ')'" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected closing parenthesis ')'.");
+        reportSyntaxError("Expected closing parenthesis ')'.");
     }
 
     proceed(TOKEN_RIGHT_PAREN);
@@ -773,7 +851,7 @@ AST_NODE *Parser::parseArrayLength()
     {
         // std::cerr << "< Syntax Error > Expected '#' for array length" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '#' for array length.");
+        reportSyntaxError("Expected '#' for array length.");
     }
     proceed(TOKEN_ARRAY_LENGTH);
 
@@ -782,13 +860,13 @@ AST_NODE *Parser::parseArrayLength()
     {
         // std::cerr << "< Syntax Error > Expected array identifier after '#'" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected array identifier after '#'");
+        reportSyntaxError("Expected array identifier after '#'");
     }
     std::string arrayName = current->value;
     proceed(TOKEN_IDENTIFIER);
 
     // Create and populate the node
-    AST_NODE *arrayLength = new AST_NODE();
+    AST_NODE *arrayLength = newNode();
     arrayLength->TYPE = NODE_ARRAY_LENGTH;
     arrayLength->VALUE = arrayName; // The array being measured
 
@@ -804,7 +882,7 @@ AST_NODE *Parser::parseArrayInsert()
     {
         // std::cerr << "< Syntax Error > Expected array identifier after '+>'" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected array identifier after '+>'");
+        reportSyntaxError("Expected array identifier after '+>'");
     }
     std::string arrayName = current->value;
     proceed(TOKEN_IDENTIFIER);
@@ -814,12 +892,12 @@ AST_NODE *Parser::parseArrayInsert()
     {
         // std::cerr << "< Syntax Error > Expected '(' after array identifier" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '(' after array identifier.");
+        reportSyntaxError("Expected '(' after array identifier.");
     }
     proceed(TOKEN_LEFT_PAREN);
 
     // Create the node
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_ARRAY_INSERT;
     node->VALUE = arrayName;
 
@@ -832,7 +910,7 @@ AST_NODE *Parser::parseArrayInsert()
     {
         // std::cerr << "< Syntax Error > Expected ',' after index in array insert" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected ',' after index in array insert.");
+        reportSyntaxError("Expected ',' after index in array insert.");
     }
     proceed(TOKEN_COMMA);
 
@@ -845,7 +923,7 @@ AST_NODE *Parser::parseArrayInsert()
     {
         // std::cerr << "< Syntax Error > Expected ')' after value in array insert" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected ')' after value in array insert.");
+        reportSyntaxError("Expected ')' after value in array insert.");
     }
     proceed(TOKEN_RIGHT_PAREN);
 
@@ -861,7 +939,7 @@ AST_NODE *Parser::parseArrayRemove()
     {
         // std::cerr << "< Syntax Error > Expected array identifier after '-<'" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected array identifier after '-<'");
+        reportSyntaxError("Expected array identifier after '-<'");
     }
     std::string arrayName = current->value;
     proceed(TOKEN_IDENTIFIER);
@@ -871,12 +949,12 @@ AST_NODE *Parser::parseArrayRemove()
     {
         // std::cerr << "< Syntax Error > Expected '(' after array identifier" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '(' after array identfier.");
+        reportSyntaxError("Expected '(' after array identfier.");
     }
     proceed(TOKEN_LEFT_PAREN);
 
     // Create the node
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_ARRAY_REMOVE;
     node->VALUE = arrayName;
 
@@ -889,7 +967,7 @@ AST_NODE *Parser::parseArrayRemove()
     {
         // std::cerr << "< Syntax Error > Expected ')' after index in array remove" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected ')' after index in array remove.");
+        reportSyntaxError("Expected ')' after index in array remove.");
     }
     proceed(TOKEN_RIGHT_PAREN);
 
@@ -904,13 +982,13 @@ AST_NODE *Parser::parseArraySortAsc()
     {
         // std::cerr << "< Syntax Error > Expected array identifier after '~>'" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected array identifier after '~>'");
+        reportSyntaxError("Expected array identifier after '~>'");
     }
     std::string arrayName = current->value;
     proceed(TOKEN_IDENTIFIER);
 
     // Create the node
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_ARRAY_SORT_ASC;
     node->VALUE = arrayName;
 
@@ -925,13 +1003,13 @@ AST_NODE *Parser::parseArraySortDesc()
     {
         // std::cerr << "< Syntax Error > Expected array identifier after '<~'" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected array identifier after '<~'");
+        reportSyntaxError("Expected array identifier after '<~'");
     }
     std::string arrayName = current->value;
     proceed(TOKEN_IDENTIFIER);
 
     // Create the node
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_ARRAY_SORT_DESC;
     node->VALUE = arrayName;
 
@@ -943,7 +1021,7 @@ AST_NODE *Parser::parseArrayLastIndex()
     // Consume the token
     proceed(TOKEN_ARRAY_LAST_INDEX);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_ARRAY_LAST_INDEX;
     node->VALUE = current->value; // or set as needed
 
@@ -959,7 +1037,7 @@ AST_NODE *Parser::parseKeywordElement()
     {
         // std::cerr << "< Syntax Error > Expected element type after 'elements'" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected element type after 'element'.");
+        reportSyntaxError("Expected element type after 'element'.");
     }
 
     std::string elementType = current->value;
@@ -970,19 +1048,19 @@ AST_NODE *Parser::parseKeywordElement()
     {
         // std::cerr << "< Syntax Error > Expected array identifier after element type" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected array identifier after element type.");
+        reportSyntaxError("Expected array identifier after element type.");
     }
 
     std::string arrayName = current->value;
     proceed(TOKEN_IDENTIFIER);
 
     // Create the array declaration node
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_ARRAY_DECLARATION;
     node->VALUE = arrayName;
 
     // Create and attach the element type node
-    AST_NODE *typeNode = new AST_NODE();
+    AST_NODE *typeNode = newNode();
     typeNode->TYPE = NODE_ELEMENT_TYPE;
     typeNode->VALUE = elementType;
     node->CHILD = typeNode;
@@ -1000,12 +1078,12 @@ AST_NODE *Parser::parseKeywordRange()
     {
         // std::cerr << "< Syntax Error > Expected '(' after 'range'" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '(' after 'range'.");
+        reportSyntaxError("Expected '(' after 'range'.");
     }
     proceed(TOKEN_LEFT_PAREN);
 
     // Create the range node
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_ARRAY_RANGE;
 
     // Parse the start integer
@@ -1013,9 +1091,9 @@ AST_NODE *Parser::parseKeywordRange()
     {
         // std::cerr << "< Syntax Error > Expected integer at start of range" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected integer at start of range.");
+        reportSyntaxError("Expected integer at start of range.");
     }
-    AST_NODE *startNode = new AST_NODE();
+    AST_NODE *startNode = newNode();
     startNode->TYPE = NODE_INT_LITERAL;
     startNode->VALUE = current->value;
     proceed(TOKEN_INTEGER_VAL);
@@ -1026,7 +1104,7 @@ AST_NODE *Parser::parseKeywordRange()
     {
         // std::cerr << "< Syntax Error > Expected '..' in range expression" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '..' in range expression.");
+        reportSyntaxError("Expected '..' in range expression.");
     }
     proceed(TOKEN_OPERATOR_ARRAYRANGE);
 
@@ -1035,9 +1113,9 @@ AST_NODE *Parser::parseKeywordRange()
     {
         // std::cerr << "< Syntax Error > Expected integer at end of range" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected integer at end of range.");
+        reportSyntaxError("Expected integer at end of range.");
     }
-    AST_NODE *endNode = new AST_NODE();
+    AST_NODE *endNode = newNode();
     endNode->TYPE = NODE_INT_LITERAL;
     endNode->VALUE = current->value;
     proceed(TOKEN_INTEGER_VAL);
@@ -1048,7 +1126,7 @@ AST_NODE *Parser::parseKeywordRange()
     {
         // std::cerr << "< Syntax Error > Expected ')' after range expression" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected ')' after range expression.");
+        reportSyntaxError("Expected ')' after range expression.");
     }
     proceed(TOKEN_RIGHT_PAREN);
 
@@ -1065,12 +1143,12 @@ AST_NODE *Parser::parseKeywordRepeat()
     {
         // std::cerr << "< Syntax Error > Expected '(' after 'repeat'" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '(' after 'repeat'.");
+        reportSyntaxError("Expected '(' after 'repeat'.");
     }
     proceed(TOKEN_LEFT_PAREN);
 
     // Create the repeat node
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_ARRAY_REPEAT;
 
     // Parse the value to repeat
@@ -1082,7 +1160,7 @@ AST_NODE *Parser::parseKeywordRepeat()
     {
         // std::cerr << "< Syntax Error > Expected ',' after value in repeat expression" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected ',' after value in repeat expression.");
+        reportSyntaxError("Expected ',' after value in repeat expression.");
     }
     proceed(TOKEN_COMMA);
 
@@ -1095,7 +1173,7 @@ AST_NODE *Parser::parseKeywordRepeat()
     {
         // std::cerr << "< Syntax Error > Expected ')' after count in repeat expression" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected ')' after count in repeat expression.");
+        reportSyntaxError("Expected ')' after count in repeat expression.");
     }
     proceed(TOKEN_RIGHT_PAREN);
 
@@ -1104,7 +1182,7 @@ AST_NODE *Parser::parseKeywordRepeat()
 
 AST_NODE *Parser::parseDot(/*const std::string &identifier*/)
 {
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_DOT;
     node->VALUE = arrayIDforDot;
 
@@ -1114,7 +1192,7 @@ AST_NODE *Parser::parseDot(/*const std::string &identifier*/)
     {
         // std::cerr << "< Syntax Error > Expected '(' after dot operator." << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '(' after dot operator.");
+        reportSyntaxError("Expected '(' after dot operator.");
     }
     proceed(TOKEN_LEFT_PAREN);
 
@@ -1124,7 +1202,7 @@ AST_NODE *Parser::parseDot(/*const std::string &identifier*/)
     {
         // std::cerr << "< Syntax Error > Expected ')' to close dot expression." << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected ')' to close dot expression.");
+        reportSyntaxError("Expected ')' to close dot expression.");
     }
     proceed(TOKEN_RIGHT_PAREN);
 
@@ -1136,7 +1214,7 @@ AST_NODE *Parser::parseDotExpression()
     // std::cout << "DEBUG: Entering parseDotExpression, current token: "
     //           << getTokenTypeName(current->TYPE) << " value: " << current->value << std::endl;
 
-    AST_NODE *indexNode = new AST_NODE();
+    AST_NODE *indexNode = newNode();
     indexNode->TYPE = NODE_ARRAY_INDEX;
     indexNode->VALUE = current->value;
 
@@ -1146,7 +1224,7 @@ AST_NODE *Parser::parseDotExpression()
         // std::cerr << "< Syntax Error > Expected INTEGER for array index but got "
         //           << getTokenTypeName(current->TYPE) << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected INTEGER for array index but got " + getTokenTypeName(current->TYPE));
+        reportSyntaxError("Expected INTEGER for array index but got " + getTokenTypeName(current->TYPE));
     }
 
     proceed(TOKEN_INTEGER_VAL);
@@ -1160,35 +1238,35 @@ AST_NODE *Parser::parseDotExpression()
     {
     case TOKEN_OPERATOR_ADD:
         // std::cout << "DEBUG: Found ADD operator" << std::endl;
-        operatorNode = new AST_NODE();
+        operatorNode = newNode();
         operatorNode->TYPE = NODE_ADD;
         operatorNode->VALUE = current->value;
         proceed(TOKEN_OPERATOR_ADD);
         break;
     case TOKEN_OPERATOR_SUBT:
         // std::cout << "DEBUG: Found SUBTRACT operator" << std::endl;
-        operatorNode = new AST_NODE();
+        operatorNode = newNode();
         operatorNode->TYPE = NODE_SUBT;
         operatorNode->VALUE = current->value;
         proceed(TOKEN_OPERATOR_SUBT);
         break;
     case TOKEN_OPERATOR_DIV:
         // std::cout << "DEBUG: Found DIVIDE operator" << std::endl;
-        operatorNode = new AST_NODE();
+        operatorNode = newNode();
         operatorNode->TYPE = NODE_DIVISION;
         operatorNode->VALUE = current->value;
         proceed(TOKEN_OPERATOR_DIV);
         break;
     case TOKEN_OPERATOR_MODULUS:
         // std::cout << "DEBUG: Found MODULUS operator" << std::endl;
-        operatorNode = new AST_NODE();
+        operatorNode = newNode();
         operatorNode->TYPE = NODE_MODULUS;
         operatorNode->VALUE = current->value;
         proceed(TOKEN_OPERATOR_MODULUS);
         break;
     case TOKEN_OPERATOR_MULT:
         // std::cout << "DEBUG: Found MULTIPLY operator" << std::endl;
-        operatorNode = new AST_NODE();
+        operatorNode = newNode();
         operatorNode->TYPE = NODE_MULT;
         operatorNode->VALUE = current->value;
         proceed(TOKEN_OPERATOR_MULT);
@@ -1197,7 +1275,7 @@ AST_NODE *Parser::parseDotExpression()
         // std::cerr << "< Syntax Error > Expected a mathematical operator between index and value, but got "
         //           << getTokenTypeName(current->TYPE) << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected a mathematical operator between index and value, but got " + getTokenTypeName(current->TYPE));
+        reportSyntaxError("Expected a mathematical operator between index and value, but got " + getTokenTypeName(current->TYPE));
     }
 
     // std::cout << "DEBUG: After operator, current token: "
@@ -1208,10 +1286,10 @@ AST_NODE *Parser::parseDotExpression()
         // std::cerr << "< Syntax Error > Expected a value after the operator, but got "
         //           << getTokenTypeName(current->TYPE) << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected a value after the operator, but got " + getTokenTypeName(current->TYPE));
+        reportSyntaxError("Expected a value after the operator, but got " + getTokenTypeName(current->TYPE));
     }
 
-    AST_NODE *operandNode = new AST_NODE();
+    AST_NODE *operandNode = newNode();
     operandNode->TYPE = NODE_INT;
     operandNode->VALUE = current->value;
 
@@ -1233,7 +1311,7 @@ AST_NODE *Parser::parseDotExpression()
 AST_NODE *Parser::parseHeaderFile()
 {
     // Create node for the needs block
-    AST_NODE *needsNode = new AST_NODE();
+    AST_NODE *needsNode = newNode();
     needsNode->TYPE = NODE_NEEDS_BLOCK;
 
     // We've already matched the 'needs:' token
@@ -1242,7 +1320,7 @@ AST_NODE *Parser::parseHeaderFile()
     // Expect left curl brace
     if (getCurrentToken()->TYPE != TOKEN_LEFT_CURL)
     {
-        ErrorHandler::getInstance().reportSyntaxError("Expected '{' after needs: directive");
+        reportSyntaxError("Expected '{' after needs: directive");
         return needsNode; // Return incomplete node to continue parsing
     }
     advanceCursor(); // Move past '{'
@@ -1260,7 +1338,7 @@ AST_NODE *Parser::parseHeaderFile()
             // Expect string for filename
             if (getCurrentToken()->TYPE != TOKEN_STRING_VAL)
             {
-                ErrorHandler::getInstance().reportSyntaxError("Expected string filename after source");
+                reportSyntaxError("Expected string filename after source");
                 // Skip to next token and try to continue parsing
                 advanceCursor();
                 continue;
@@ -1270,7 +1348,7 @@ AST_NODE *Parser::parseHeaderFile()
             std::string headerFileName = getCurrentToken()->value;
 
             // Create a node for this header include
-            AST_NODE *headerNode = new AST_NODE();
+            AST_NODE *headerNode = newNode();
             headerNode->TYPE = NODE_READ_HEADER;
             headerNode->VALUE = headerFileName;
 
@@ -1289,14 +1367,14 @@ AST_NODE *Parser::parseHeaderFile()
 
             if (getCurrentToken()->TYPE != TOKEN_STRING_VAL)
             {
-                ErrorHandler::getInstance().reportSyntaxError("Expected string library name after library.");
+                reportSyntaxError("Expected string library name after library.");
                 advanceCursor();
                 continue;
             }
 
             std::string libraryName = getCurrentToken()->value;
 
-            AST_NODE *libraryNode = new AST_NODE();
+            AST_NODE *libraryNode = newNode();
             libraryNode->TYPE = NODE_IMPORT_LIBRARY;
             libraryNode->VALUE = libraryName;
 
@@ -1307,7 +1385,7 @@ AST_NODE *Parser::parseHeaderFile()
         else
         {
             // Unexpected token in needs block
-            ErrorHandler::getInstance().reportSyntaxError("Unexpected token in needs: block: " +
+            reportSyntaxError("Unexpected token in needs: block: " +
                                                           getCurrentToken()->value);
             advanceCursor(); // Skip it and continue
         }
@@ -1316,7 +1394,7 @@ AST_NODE *Parser::parseHeaderFile()
     // Expect right curl brace
     if (getCurrentToken()->TYPE != TOKEN_RIGHT_CURL)
     {
-        ErrorHandler::getInstance().reportSyntaxError("Expected '}' to close needs: block");
+        reportSyntaxError("Expected '}' to close needs: block");
         return needsNode; // Return incomplete node
     }
 
@@ -1324,103 +1402,227 @@ AST_NODE *Parser::parseHeaderFile()
 
     return needsNode;
 }
+/**
+ * @brief Finds a header file and returns its canonical path
+ * @param headerFileName The name given after 'source:'
+ * @return Canonical path, or an empty string if no candidate exists
+ *
+ * Candidates are checked with stat alone; the file is only opened when it
+ * actually has to be parsed.
+ */
+std::string Parser::resolveHeaderPath(const std::string &headerFileName) const
+{
+    const std::string pathsToTry[] = {
+        headerFileName,
+        "./tests/" + headerFileName,
+        "../tests/" + headerFileName,
+        "tests/" + headerFileName,
+        "./" + headerFileName,
+        "../" + headerFileName};
+
+    for (const auto &path : pathsToTry)
+    {
+        std::error_code error;
+        if (std::filesystem::is_regular_file(path, error))
+        {
+            std::filesystem::path canonical = std::filesystem::canonical(path, error);
+            if (!error)
+            {
+                return canonical.string();
+            }
+        }
+    }
+    return "";
+}
+
+/**
+ * @brief Removes the trees of '@once' headers already attached to this program
+ * @param node A header tree about to be attached
+ *
+ * Header paths resolve the same way in every parser, so the header node's
+ * VALUE identifies the file just as it did for the unit's own parser.
+ */
+void Parser::detachIncludedOnceHeaders(AST_NODE *node) const
+{
+    if (node == nullptr)
+    {
+        return;
+    }
+
+    if (node->TYPE == NODE_READ_HEADER && node->CHILD != nullptr &&
+        includeState.onceHeaders.count(resolveHeaderPath(node->VALUE)) != 0)
+    {
+        deleteTree(node->CHILD);
+        node->CHILD = nullptr;
+        return;
+    }
+
+    detachIncludedOnceHeaders(node->CHILD);
+    for (AST_NODE *statement : node->SUB_STATEMENTS)
+    {
+        detachIncludedOnceHeaders(statement);
+    }
+}
+
+void deleteTree(AST_NODE *root)
+{
+    if (root == nullptr)
+    {
+        return;
+    }
+    deleteTree(root->CHILD);
+    for (AST_NODE *statement : root->SUB_STATEMENTS)
+    {
+        deleteTree(statement);
+    }
+    delete root;
+}
+
 /**
  * @brief Process an include file
  * @param headerNode The AST node representing the header inclusion
  * @param headerPath the path to the header file
  * @return true if successful, false on error
+ *
+ * Parsed headers are kept in the HeaderCache, keyed by canonical path, and
+ * reused by later includes in this or any other Parser. A header beginning
+ * with '@once' is attached to a program's tree only the first time it is
+ * included; later includes leave the header node without a CHILD.
  */
 bool Parser::processHeaderFile(AST_NODE *headerNode, const std::string &headerFileName)
 {
-    // Keep track of included headers to prevent circular inclusion
-    static std::unordered_set<std::string> includedHeaders;
+    std::string headerPath = resolveHeaderPath(headerFileName);
+    if (headerPath.empty())
+    {
+        reportSyntaxError("Could not open header file: " + headerFileName);
+        return false;
+    }
 
     // Check for circular inclusion
-    if (includedHeaders.find(headerFileName) != includedHeaders.end())
+    const std::vector<std::string> &active = includeState.activeHeaders;
+    if (std::find(active.begin(), active.end(), headerPath) != active.end())
     {
-        ErrorHandler::getInstance().reportSyntaxError("Circular header inclusion detected: " + headerFileName);
+        reportSyntaxError("Circular header inclusion detected: " + headerFileName);
         return false;
     }
 
-    // Add this file to the included set
-    includedHeaders.insert(headerFileName);
+    // Only '@once' headers are ever recorded here; this one is already part of the program
+    if (includeState.onceHeaders.count(headerPath) != 0)
+    {
+        return true;
+    }
+
+    HeaderCache &headerCache = HeaderCache::getInstance();
+    std::shared_ptr<const HeaderCache::Unit> unit = headerCache.find(headerPath);
+    AST_NODE *headerAST = nullptr;
 
-    // Open the header file
-    std::ifstream headerFile(headerFileName);
-    if (!headerFile.is_open())
+    if (!unit)
     {
-        // Try different paths
-        std::vector<std::string> pathsToTry = {
-            "./tests/" + headerFileName,
-            "../tests/" + headerFileName,
-            "tests/" + headerFileName,
-            "./" + headerFileName,
-            "../" + headerFileName};
+        // Map the header file
+        SourceBuffer headerContent;
+        if (!headerContent.open(headerPath))
+        {
+            reportSyntaxError("Could not open header file: " + headerFileName);
+            return false;
+        }
 
-        bool fileOpened = false;
-        for (const auto &path : pathsToTry)
+        // Create a lexer for the header content
+        Lexer headerLexer(headerContent);
+        std::vector<Token *> headerTokens = headerLexer.tokenize();
+
+#ifndef MINILANG_PRODUCTION
+        if (Log::isEnabled(LogLevel::TRACE))
         {
-            headerFile.open(path);
-            if (headerFile.is_open())
+            MINILANG_LOG_TRACE("Header file tokens: " << headerFileName);
+            for (const auto &token : headerTokens)
             {
-                fileOpened = true;
-                break;
+                MINILANG_LOG_TRACE("Token: " << getTokenTypeName(token->TYPE) << " | Value: " << token->value);
             }
         }
+#endif
+
+        bool hasOnceDirective = false;
+        [[maybe_unused]] bool hasLastDirective = false; // Only reported in debug builds
 
-        if (!fileOpened)
+        if (!headerTokens.empty())
         {
-            ErrorHandler::getInstance().reportSyntaxError("Could not open header file: " + headerFileName);
-            includedHeaders.erase(headerFileName);
-            return false;
+            if (headerTokens[0]->TYPE == TOKEN_READ_HEADER)
+            {
+                hasOnceDirective = true;
+            }
+            if (headerTokens.back()->TYPE == TOKEN_END_HEADER)
+            {
+                hasLastDirective = true;
+            }
         }
-    }
 
-    // Read the content
-    std::string headerContent((std::istreambuf_iterator<char>(headerFile)),
-                              std::istreambuf_iterator<char>());
+        MINILANG_LOG_DEBUG("Header " << headerFileName << " has @once: " << (hasOnceDirective ? "Yes" : "No")
+                                     << ", @last: " << (hasLastDirective ? "Yes" : "No"));
 
-    // Create a lexer for the header content
-    Lexer headerLexer(headerContent);
-    std::vector<Token *> headerTokens = headerLexer.tokenize();
+        // Create a parser for the header tokens - setting isHeader flag to true.
+        // It inherits the include chain but not our '@once' set, so the unit
+        // parses the same way wherever it is first included.
+        std::size_t errorsBefore = ErrorHandler::getInstance().getErrors().size();
+        HeaderCache::Unit parsed;
+        {
+            Parser headerParser(headerTokens, true);
+            headerParser.includeState.activeHeaders = includeState.activeHeaders;
+            headerParser.includeState.activeHeaders.push_back(headerPath);
+
+            // Parse the header
+            headerAST = headerParser.parse();
+
+            parsed.includeOnce = hasOnceDirective;
+            parsed.files.push_back(headerPath);
+            parsed.files.insert(parsed.files.end(),
+                                headerParser.getIncludedFiles().begin(),
+                                headerParser.getIncludedFiles().end());
+            parsed.onceHeaders.assign(headerParser.includeState.onceHeaders.begin(),
+                                      headerParser.includeState.onceHeaders.end());
+            if (hasOnceDirective)
+            {
+                parsed.onceHeaders.push_back(headerPath);
+            }
+        }
 
-    // Debug Log for header tokens
-    std::cout << "Header File Tokens: " << std::endl;
-    for (const auto &token : headerTokens)
-    {
-        std::cout << "Token: " << getTokenTypeName(token->TYPE)
-                  << " | Value: " << token->value << std::endl;
-    }
+        // The AST holds copies of the token values
+        for (Token *token : headerTokens)
+        {
+            delete token;
+        }
 
-    bool hasOnceDirective = false;
-    bool hasLastDirective = false;
+        if (headerAST == nullptr)
+        {
+            return false;
+        }
 
-    if (!headerTokens.empty())
-    {
-        if (headerTokens[0]->TYPE == TOKEN_READ_HEADER)
+        parsed.ast = FlatAST::fromTree(headerAST);
+        if (ErrorHandler::getInstance().getErrors().size() == errorsBefore)
         {
-            hasOnceDirective = true;
+            unit = headerCache.insert(headerPath, std::move(parsed));
         }
-        if (headerTokens.back()->TYPE == TOKEN_END_HEADER)
+        else
         {
-            hasLastDirective = true;
+            // Keep a header that failed to parse out of the cache
+            unit = std::make_shared<const HeaderCache::Unit>(std::move(parsed));
         }
     }
 
-    std::cout << "Header has @once: " << (hasOnceDirective ? "Yes" : "No") << std::endl;
-    std::cout << "Header has @last: " << (hasLastDirective ? "Yes" : "No") << std::endl;
-
-    // Create a parser for the header tokens - setting isHeader flag to true
-    Parser headerParser(headerTokens, true);
-
-    // Parse the header
-    AST_NODE *headerAST = headerParser.parse();
-
     // Attach the header AST to our node
-    headerNode->CHILD = headerAST;
+    headerNode->CHILD = headerAST != nullptr ? headerAST : unit->ast.toTree();
 
-    // Remove this file from the included set once we're done
-    includedHeaders.erase(headerFileName);
+    // The unit was parsed without our '@once' set, so it may embed a header we already have
+    for (const std::string &onceHeader : unit->onceHeaders)
+    {
+        if (includeState.onceHeaders.count(onceHeader) != 0)
+        {
+            detachIncludedOnceHeaders(headerNode->CHILD);
+            break;
+        }
+    }
+
+    includedFiles.insert(includedFiles.end(), unit->files.begin(), unit->files.end());
+    includeState.onceHeaders.insert(unit->onceHeaders.begin(), unit->onceHeaders.end());
 
     return true;
 }
@@ -1441,7 +1643,7 @@ AST_NODE *Parser::parseKeywordBool()
     std::string variableName = current->value;
     proceed(TOKEN_IDENTIFIER);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_BOOL;
     node->VALUE = variableName;
 
@@ -1471,15 +1673,12 @@ AST_NODE *Parser::parseKeywordEOF()
     proceed(TOKEN_EOF);
 
     // Check if there are tokens after EOF
-    if (cursor < size)
+    if (Token *trailing = tokenAt(cursor))
     {
-        // std::cerr << "Unexpected token after EOF: "
-        //           << getTokenTypeName(tokens[cursor]->TYPE) << std::endl;
-        // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Unexpected token after EOF: " + getTokenTypeName(tokens[cursor]->TYPE));
+        reportSyntaxError("Unexpected token after EOF: " + getTokenTypeName(trailing->TYPE));
     }
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_EOF;
     node->VALUE = eofValue;
 
@@ -1497,7 +1696,7 @@ AST_NODE *Parser::parseKeywordPrint()
 {
     proceed(TOKEN_KEYWORD_PRINT);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_PRINT;
 
     // Check for opening parenthesis
@@ -1505,7 +1704,7 @@ AST_NODE *Parser::parseKeywordPrint()
     {
         // std::cerr << "Expected '(' after print keyword" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '(' after print keyword.");
+        reportSyntaxError("Expected '(' after print keyword.");
     }
     proceed(TOKEN_LEFT_PAREN);
 
@@ -1517,7 +1716,7 @@ AST_NODE *Parser::parseKeywordPrint()
     {
         // std::cerr << "Expected ')' after print argument" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected ')' after print argument.");
+        reportSyntaxError("Expected ')' after print argument.");
     }
     proceed(TOKEN_RIGHT_PAREN);
 
@@ -1533,7 +1732,7 @@ AST_NODE *Parser::parseKeywordPrint()
 AST_NODE *Parser::parseKeywordInput()
 {
     // Create a node for input keyword
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_KEYWORD_INPUT;
     node->VALUE = "input";
 
@@ -1544,11 +1743,11 @@ AST_NODE *Parser::parseKeywordInput()
     {
         // std::cerr << "< Syntax Error > Expected input type after 'input' keyword" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected input type after keyword 'input'.");
+        reportSyntaxError("Expected input type after keyword 'input'.");
     }
 
     // Parse the input type (already parsed by lexer as TOKEN_INPUT_TYPE)
-    AST_NODE *inputType = new AST_NODE();
+    AST_NODE *inputType = newNode();
     inputType->TYPE = NODE_INPUT_TYPE;
     inputType->VALUE = current->value;
     node->CHILD = inputType;
@@ -1559,11 +1758,11 @@ AST_NODE *Parser::parseKeywordInput()
     {
         // std::cerr << "< Syntax Error > Expected '(' following input." << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '(' following input.");
+        reportSyntaxError("Expected '(' following input.");
     }
     proceed(TOKEN_LEFT_PAREN);
 
-    AST_NODE *promptNode = new AST_NODE();
+    AST_NODE *promptNode = newNode();
     promptNode->TYPE = NODE_INPUT_PROMPT;
     promptNode->CHILD = parseExpression();
 
@@ -1573,7 +1772,7 @@ AST_NODE *Parser::parseKeywordInput()
     {
         // std::cerr << "< Syntax Error > Expected ')' follwing the prompt" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected ')' following the input prompt.");
+        reportSyntaxError("Expected ')' following the input prompt.");
     }
     proceed(TOKEN_RIGHT_PAREN);
     // Expect spaceship operator (=>)
@@ -1581,7 +1780,7 @@ AST_NODE *Parser::parseKeywordInput()
     {
         // std::cerr << "< Syntax Error > Expected '=>' after input prompt" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '=>' after input prompt.");
+        reportSyntaxError("Expected '=>' after input prompt.");
     }
     proceed(TOKEN_SPACESHIP);
 
@@ -1590,11 +1789,11 @@ AST_NODE *Parser::parseKeywordInput()
     {
         // std::cerr << "< Syntax Error > Expected variable name after '=>'" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected variable name after '=>', for input.");
+        reportSyntaxError("Expected variable name after '=>', for input.");
     }
 
     // Create a variable node and add it to sub-statements
-    AST_NODE *varNode = new AST_NODE();
+    AST_NODE *varNode = newNode();
     varNode->TYPE = NODE_IDENTIFIER;
     varNode->VALUE = current->value;
 
@@ -1613,7 +1812,7 @@ AST_NODE *Parser::parseKeywordInput()
 
 AST_NODE *Parser::parseInputType()
 {
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_INPUT_TYPE;
 
     // Extract type from token value (which would be like "<int>")
@@ -1636,7 +1835,7 @@ AST_NODE *Parser::parseInputType()
     {
         // std::cerr << "< Syntax Error > Invalid input type: " << typeName << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Invalid input type: " + typeName);
+        reportSyntaxError("Invalid input type: " + typeName);
     }
 
     proceed(TOKEN_INPUT_TYPE);
@@ -1663,7 +1862,7 @@ AST_NODE *Parser::parseResultStatement()
     // Debug output to track parsing
     // std::cout << "Parsing result statement" << std::endl;
 
-    AST_NODE *resultStatement = new AST_NODE();
+    AST_NODE *resultStatement = newNode();
     resultStatement->TYPE = NODE_RESULTSTATEMENT;
     proceed(TOKEN_KEYWORD_RESULT);
 
@@ -1671,7 +1870,7 @@ AST_NODE *Parser::parseResultStatement()
     {
         // std::cerr << "< Syntax Error > Expected '=>' after result keyword." << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '=>' after result keyword.");
+        reportSyntaxError("Expected '=>' after result keyword.");
     }
     proceed(TOKEN_SPACESHIP);
 
@@ -1679,7 +1878,7 @@ AST_NODE *Parser::parseResultStatement()
     {
         // std::cerr << "< Syntax Error > Expected '{' following the '=>' in result statement." << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '{' following the '=>' in result statement.");
+        reportSyntaxError("Expected '{' following the '=>' in result statement.");
     }
     proceed(TOKEN_LEFT_CURL);
 
@@ -1695,7 +1894,7 @@ AST_NODE *Parser::parseResultStatement()
     {
         // std::cerr << "< Syntax Error > Expected '}' to close result statement." << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '}' to close result statement.");
+        reportSyntaxError("Expected '}' to close result statement.");
     }
     proceed(TOKEN_RIGHT_CURL);
 
@@ -1711,7 +1910,7 @@ AST_NODE *Parser::parseResultStatement()
  */
 AST_NODE *Parser::parseKeywordResult()
 {
-    AST_NODE *keywordResult = new AST_NODE();
+    AST_NODE *keywordResult = newNode();
     keywordResult->TYPE = NODE_RESULT;
     keywordResult->VALUE = current->value;
 
@@ -1731,7 +1930,7 @@ AST_NODE *Parser::parseResultExpression()
 {
     proceed(TOKEN_LEFT_CURL);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_RESULT_EXPRESSION;
 
     node->CHILD = parseExpression();
@@ -1741,7 +1940,7 @@ AST_NODE *Parser::parseResultExpression()
     {
         // std::cerr << "< Syntax Error > Expected closing curly brace" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected closing curly brace, '}'.");
+        reportSyntaxError("Expected closing curly brace, '}'.");
     }
     proceed(TOKEN_RIGHT_CURL);
 
@@ -1755,7 +1954,7 @@ AST_NODE *Parser::parseEquals()
 {
     proceed(TOKEN_EQUALS);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_EQUALS;
     node->VALUE = current->value;
 
@@ -1770,7 +1969,7 @@ AST_NODE *Parser::parseSemicolon()
 {
     proceed(TOKEN_SEMICOLON);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_SEMICOLON;
 
     return node;
@@ -1797,7 +1996,7 @@ AST_NODE *Parser::parseID()
     if (current && current->TYPE == TOKEN_ARRAY_INITIALIZER)
     {
         cursor--; // step back so parseArrayInit sees the identifier
-        current = tokens[cursor];
+        current = tokenAt(cursor);
         return parseArrayInit(); // consumes IDENT, '|=', and the list
     }
 
@@ -1808,10 +2007,10 @@ AST_NODE *Parser::parseID()
         {
             // std::cerr << "< Syntax Error > Expected '(' after '@'" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSyntaxError("Expected '(' after '@'.");
+            reportSyntaxError("Expected '(' after '@'.");
         }
         proceed(TOKEN_LEFT_PAREN);
-        AST_NODE *node = new AST_NODE();
+        AST_NODE *node = newNode();
         node->TYPE = NODE_ARRAY_ACCESS;
         node->VALUE = identifierName;
 
@@ -1819,7 +2018,7 @@ AST_NODE *Parser::parseID()
         if (current->TYPE == TOKEN_ARRAY_LAST_INDEX)
         {
             proceed(TOKEN_ARRAY_LAST_INDEX);
-            AST_NODE *lastNode = new AST_NODE();
+            AST_NODE *lastNode = newNode();
             lastNode->TYPE = NODE_ARRAY_LAST_INDEX;
             node->CHILD = lastNode;
         }
@@ -1832,7 +2031,7 @@ AST_NODE *Parser::parseID()
         {
             // std::cerr << "< Syntax Error > Expected ')' after array access" << std::endl;
             // exit(1);
-            ErrorHandler::getInstance().reportSyntaxError("Expected ')' after array access.");
+            reportSyntaxError("Expected ')' after array access.");
         }
         proceed(TOKEN_RIGHT_PAREN);
         return node;
@@ -1840,7 +2039,7 @@ AST_NODE *Parser::parseID()
 
     if (current && current->TYPE == TOKEN_LEFT_PAREN)
     {
-        AST_NODE *call = new AST_NODE();
+        AST_NODE *call = newNode();
         call->TYPE = NODE_FUNCTION_CALL;
         call->VALUE = identifierName;
         proceed(TOKEN_LEFT_PAREN);
@@ -1854,7 +2053,7 @@ AST_NODE *Parser::parseID()
             {
                 // std::cerr << "< Syntax Error > Expected ',' or ')'" << std::endl;
                 // exit(1);
-                ErrorHandler::getInstance().reportSyntaxError("Expected ',' or ')'.");
+                reportSyntaxError("Expected ',' or ')'.");
             }
         }
         proceed(TOKEN_RIGHT_PAREN);
@@ -1866,7 +2065,7 @@ AST_NODE *Parser::parseID()
         return parseKeywordEOF();
     }
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_IDENTIFIER;
     node->VALUE = identifierName;
 
@@ -1890,7 +2089,7 @@ AST_NODE *Parser::parseNewLineCharacter()
 {
     proceed(TOKEN_NL_SYMBOL);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_NEWLINE_SYMBOL;
 
     return node;
@@ -1911,7 +2110,7 @@ AST_NODE *Parser::parseLeftParen()
 {
     proceed(TOKEN_LEFT_PAREN);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_PAREN_EXPR;
 
     node->CHILD = parseExpression();
@@ -1921,13 +2120,36 @@ AST_NODE *Parser::parseLeftParen()
     {
         // std::cerr << "< Syntax Error > Expected closing parenthesis" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected closing parenthesis.");
+        reportSyntaxError("Expected closing parenthesis.");
     }
     proceed(TOKEN_RIGHT_PAREN);
 
     return node;
 }
 
+/**
+ * @brief Parses a parenthesized sub-expression
+ * @return AST node for the inner expression
+ *
+ * Parentheses only steer precedence, so no wrapper node is produced; the
+ * inner expression is returned directly and evaluation never has to step
+ * through a NODE_PAREN_EXPR.
+ */
+AST_NODE *Parser::parseParenExpression()
+{
+    proceed(TOKEN_LEFT_PAREN);
+
+    AST_NODE *inner = parseExpression();
+
+    if (current == nullptr || current->TYPE != TOKEN_RIGHT_PAREN)
+    {
+        reportSyntaxError("Expected closing parenthesis.");
+    }
+    proceed(TOKEN_RIGHT_PAREN);
+
+    return inner;
+}
+
 /**
  * @brief Handles unexpected right parenthesis
  * @return Always exits with error
@@ -1941,7 +2163,7 @@ AST_NODE *Parser::parseRightParen()
     // if we make it here something is wrong
     // std::cerr << "< Syntax Error > Unexpected right parenthesis." << std::endl;
     // exit(1);
-    ErrorHandler::getInstance().reportSyntaxError("Unexpected right parenthesis.");
+    reportSyntaxError("Unexpected right parenthesis.");
 
     return nullptr;
 }
@@ -1954,7 +2176,7 @@ AST_NODE *Parser::parseAdd()
 {
     proceed(TOKEN_OPERATOR_ADD);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_ADD;
 
     return node;
@@ -1968,7 +2190,7 @@ AST_NODE *Parser::parseMult()
 {
     proceed(TOKEN_OPERATOR_MULT);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_MULT;
 
     return node;
@@ -1982,7 +2204,7 @@ AST_NODE *Parser::parseSubt()
 {
     proceed(TOKEN_OPERATOR_SUBT);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_SUBT;
 
     return node;
@@ -1998,17 +2220,17 @@ AST_NODE *Parser::parseDecrementOperator()
 {
     proceed(TOKEN_OPERATOR_DECREMENT);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_OPERATOR_DECREMENT;
 
     if (current->TYPE != TOKEN_IDENTIFIER)
     {
         // std::cerr << "ERROR: Expected identifier after decrement operator." << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected identifier after decrement operator.");
+        reportSyntaxError("Expected identifier after decrement operator.");
     }
 
-    AST_NODE *identNode = new AST_NODE();
+    AST_NODE *identNode = newNode();
     identNode->TYPE = NODE_IDENTIFIER;
     identNode->VALUE = current->value;
     node->SUB_STATEMENTS.push_back(identNode);
@@ -2026,7 +2248,7 @@ AST_NODE *Parser::parseIncrementOperator()
 {
     proceed(TOKEN_OPERATOR_INCREMENT);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_OPERATOR_INCREMENT;
 
     // Check for identifier after increment
@@ -2034,11 +2256,11 @@ AST_NODE *Parser::parseIncrementOperator()
     {
         // std::cerr << "ERROR: Expected identifier after increment operator." << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected identifier after increment operator.");
+        reportSyntaxError("Expected identifier after increment operator.");
     }
 
     // Create identifier node as a child of the increment
-    AST_NODE *identNode = new AST_NODE();
+    AST_NODE *identNode = newNode();
     identNode->TYPE = NODE_IDENTIFIER;
     identNode->VALUE = current->value;
 
@@ -2057,7 +2279,7 @@ AST_NODE *Parser::greaterThan()
 {
     proceed(TOKEN_OPERATOR_GREATERTHAN);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_GREATER_THAN;
 
     return node;
@@ -2071,7 +2293,7 @@ AST_NODE *Parser::lessThan()
 {
     proceed(TOKEN_OPERATOR_LESSTHAN);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_LESS_THAN;
 
     return node;
@@ -2084,7 +2306,7 @@ AST_NODE *Parser::parseDivi()
 {
     proceed(TOKEN_OPERATOR_DIV);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_DIVISION;
     return node;
 }
@@ -2096,7 +2318,7 @@ AST_NODE *Parser::parseModulus()
 {
     proceed(TOKEN_OPERATOR_MODULUS);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_MODULUS;
     return node;
 }
@@ -2108,7 +2330,7 @@ AST_NODE *Parser::parseDoesntEqual()
 {
     proceed(TOKEN_OPERATOR_DOESNT_EQUAL);
 
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_NOT_EQUAL;
 
     return node;
@@ -2129,14 +2351,14 @@ AST_NODE *Parser::parseFunctionDecleration()
     {
         // std::cerr << "< Syntax Error > Functions must have a name." << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Functions must have a name.");
+        reportSyntaxError("Functions must have a name.");
         return nullptr;
     }
     std::string functionName = current->value;
     proceed(TOKEN_IDENTIFIER);
 
     // Create function node
-    AST_NODE *function = new AST_NODE();
+    AST_NODE *function = newNode();
     function->TYPE = NODE_FUNCTION_DECLERATION;
     function->VALUE = functionName;
 
@@ -2144,7 +2366,7 @@ AST_NODE *Parser::parseFunctionDecleration()
     {
         // std::cerr << "< Syntax Error > Function must have params within parenthesis" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Function must have params within parenthesis.");
+        reportSyntaxError("Function must have params within parenthesis.");
     }
     proceed(TOKEN_LEFT_PAREN);
 
@@ -2153,7 +2375,7 @@ AST_NODE *Parser::parseFunctionDecleration()
     {
         // std::cerr << "< Syntax Error > Expected closing parenthesis after functions params." << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected closing parenthesis after function params.");
+        reportSyntaxError("Expected closing parenthesis after function params.");
     }
     proceed(TOKEN_RIGHT_PAREN);
 
@@ -2161,7 +2383,7 @@ AST_NODE *Parser::parseFunctionDecleration()
     {
         // std::cerr << "< Syntax Error > Expected spaceship ( => ) following function decleration" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected spaceship '=>' following function decleration.");
+        reportSyntaxError("Expected spaceship '=>' following function decleration.");
     }
     proceed(TOKEN_SPACESHIP); // Consume arrow token
 
@@ -2173,7 +2395,7 @@ AST_NODE *Parser::parseFunctionDecleration()
     }
     else
     {
-        functionBody = new AST_NODE();
+        functionBody = newNode();
         functionBody->TYPE = NODE_FUNCTION_BODY;
         functionBody->SUB_STATEMENTS.push_back(parseStatement());
     }
@@ -2190,7 +2412,7 @@ AST_NODE *Parser::parseFunctionDecleration()
  */
 AST_NODE *Parser::parseFunctionParams()
 {
-    AST_NODE *paramsNode = new AST_NODE();
+    AST_NODE *paramsNode = newNode();
     paramsNode->TYPE = NODE_FUNCTION_PARAMS;
 
     if (current->TYPE == TOKEN_RIGHT_PAREN)
@@ -2224,7 +2446,7 @@ AST_NODE *Parser::parseFunctionParams()
  */
 AST_NODE *Parser::parseParameter()
 {
-    NODE_TYPE paramType;
+    NODE_TYPE paramType = NODE_INT;
 
     if (current->TYPE == TOKEN_KEYWORD_INT)
     {
@@ -2250,24 +2472,26 @@ AST_NODE *Parser::parseParameter()
     {
         // std::cerr << "< Syntax Error > Expected parameter type" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected parameter type.");
+        reportSyntaxError("Expected parameter type.");
+        return nullptr;
     }
 
     if (current->TYPE != TOKEN_IDENTIFIER)
     {
         // std::cerr << "< Syntax Error > Expected parameter name" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected parameter name.");
+        reportSyntaxError("Expected parameter name.");
+        return nullptr;
     }
 
     std::string paramName = current->value;
     proceed(TOKEN_IDENTIFIER);
 
-    AST_NODE *paramNode = new AST_NODE();
+    AST_NODE *paramNode = newNode();
     paramNode->TYPE = NODE_PARAM;
     paramNode->VALUE = paramName;
 
-    AST_NODE *typeNode = new AST_NODE();
+    AST_NODE *typeNode = newNode();
     typeNode->TYPE = paramType;
     paramNode->CHILD = typeNode;
 
@@ -2302,7 +2526,7 @@ AST_NODE *Parser::parseLeftCurl()
 {
     proceed(TOKEN_LEFT_CURL);
 
-    AST_NODE *blockNode = new AST_NODE();
+    AST_NODE *blockNode = newNode();
     blockNode->TYPE = NODE_BLOCK;
 
     // Parse statements until closing brace
@@ -2334,7 +2558,7 @@ AST_NODE *Parser::parseLeftCurl()
     {
         // std::cerr << "< Syntax Error > Expected '}' to close block" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '}' to close block.");
+        reportSyntaxError("Expected '}' to close block.");
     }
 
     // Consume the closing brace
@@ -2356,7 +2580,7 @@ AST_NODE *Parser::parseRightCurl()
     // If we make it here, it means we found a closing brace without a matching open brace
     // std::cerr << "< Syntax Error > Unexpected '}' without matching '{'" << std::endl;
     // exit(1);
-    ErrorHandler::getInstance().reportSyntaxError("Unexpected '}' without matching '{'");
+    reportSyntaxError("Unexpected '}' without matching '{'");
 
     return nullptr;
 }
@@ -2372,7 +2596,7 @@ AST_NODE *Parser::parseBeginBlock()
     proceed(TOKEN_KEYWORD_BEGIN);
 
     // Create node for begin block
-    AST_NODE *beginNode = new AST_NODE();
+    AST_NODE *beginNode = newNode();
     beginNode->TYPE = NODE_BEGIN_BLOCK;
 
     // Parse statements until EOF
@@ -2408,7 +2632,7 @@ AST_NODE *Parser::parseKeywordCheck()
     {
         // std::cerr << "Expected '(' after if keyword" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '(' after 'if' keyword.");
+        reportSyntaxError("Expected '(' after 'if' keyword.");
     }
     proceed(TOKEN_LEFT_PAREN);
 
@@ -2418,7 +2642,7 @@ AST_NODE *Parser::parseKeywordCheck()
     {
         // std::cerr << "Expected ')' after if condition" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected ')' after the if condition.");
+        reportSyntaxError("Expected ')' after the if condition.");
     }
     proceed(TOKEN_RIGHT_PAREN);
 
@@ -2431,13 +2655,13 @@ AST_NODE *Parser::parseKeywordCheck()
     }
     else
     {
-        loop = new AST_NODE();
+        loop = newNode();
         loop->TYPE = NODE_BLOCK;
         loop->SUB_STATEMENTS.push_back(parseStatement());
     }
 
     // Create if statement node
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_CHECK;
     node->CHILD = conditionNode;
     node->SUB_STATEMENTS.push_back(loop);
@@ -2461,7 +2685,7 @@ AST_NODE *Parser::parseKeywordIf()
     {
         // std::cerr << "Expected '(' after if keyword" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '(' after keyword 'if'.");
+        reportSyntaxError("Expected '(' after keyword 'if'.");
     }
     proceed(TOKEN_LEFT_PAREN);
 
@@ -2472,7 +2696,7 @@ AST_NODE *Parser::parseKeywordIf()
     {
         // std::cerr << "Expected ')' after if condition" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected ')' after if condition.");
+        reportSyntaxError("Expected ')' after if condition.");
     }
     proceed(TOKEN_RIGHT_PAREN);
 
@@ -2485,7 +2709,7 @@ AST_NODE *Parser::parseKeywordIf()
     }
     else
     {
-        thenBlock = new AST_NODE();
+        thenBlock = newNode();
         thenBlock->TYPE = NODE_BLOCK;
         thenBlock->SUB_STATEMENTS.push_back(parseStatement());
     }
@@ -2502,14 +2726,14 @@ AST_NODE *Parser::parseKeywordIf()
         }
         else
         {
-            elseBlock = new AST_NODE();
+            elseBlock = newNode();
             elseBlock->TYPE = NODE_BLOCK;
             elseBlock->SUB_STATEMENTS.push_back(parseStatement());
         }
     }
 
     // Create if statement node
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_IF;
     node->CHILD = condition;
     node->SUB_STATEMENTS.push_back(thenBlock);
@@ -2531,7 +2755,7 @@ AST_NODE *Parser::parseKeywordElse()
 {
     // std::cerr << "< Syntax Error > Unexpected 'else' without matching if" << std::endl;
     // exit(1);
-    ErrorHandler::getInstance().reportSyntaxError("Unexpected 'else' without matching if");
+    reportSyntaxError("Unexpected 'else' without matching if");
     return nullptr;
 }
 
@@ -2545,7 +2769,7 @@ AST_NODE *Parser::parseKeywordElse()
  */
 AST_NODE *Parser::parseArgs()
 {
-    AST_NODE *args = new AST_NODE();
+    AST_NODE *args = newNode();
     args->TYPE = NODE_FOR_ARGS;
 
     // Parse initialization (optional)
@@ -2565,7 +2789,7 @@ AST_NODE *Parser::parseArgs()
             {
                 // std::cerr << "< Syntax Error > Expected ';' after initialization in for loop" << std::endl;
                 // exit(1);
-                ErrorHandler::getInstance().reportSyntaxError("Expected ';' after initialization in for loop.");
+                reportSyntaxError("Expected ';' after initialization in for loop.");
             }
             proceed(TOKEN_SEMICOLON);
         }
@@ -2591,7 +2815,7 @@ AST_NODE *Parser::parseArgs()
     {
         // std::cerr << "< Syntax Error > Expected ';' after condition in for loop" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected ';' after condition in for loop.");
+        reportSyntaxError("Expected ';' after condition in for loop.");
     }
 
     proceed(TOKEN_SEMICOLON);
@@ -2626,7 +2850,7 @@ AST_NODE *Parser::parseKeywordFor()
     {
         // std::cerr << "< Syntax Error > Expected '(' after for keyword" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected '(' after 'for' keyword.");
+        reportSyntaxError("Expected '(' after 'for' keyword.");
     }
     proceed(TOKEN_LEFT_PAREN);
 
@@ -2635,7 +2859,7 @@ AST_NODE *Parser::parseKeywordFor()
     {
         // std::cerr << "Expected ')'  after for args" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Expected ')' after 'for' loop arguments.");
+        reportSyntaxError("Expected ')' after 'for' loop arguments.");
     }
     proceed(TOKEN_RIGHT_PAREN);
 
@@ -2647,13 +2871,13 @@ AST_NODE *Parser::parseKeywordFor()
     }
     else
     {
-        forBlock = new AST_NODE();
+        forBlock = newNode();
         forBlock->TYPE = NODE_BLOCK;
         forBlock->SUB_STATEMENTS.push_back(parseStatement());
     }
 
     // Create for loop node
-    AST_NODE *node = new AST_NODE();
+    AST_NODE *node = newNode();
     node->TYPE = NODE_FOR;
     node->CHILD = args;
     node->SUB_STATEMENTS.push_back(forBlock);
@@ -2676,7 +2900,7 @@ AST_NODE *Parser::parseTerm()
     {
         proceed(TOKEN_OPERATOR_SUBT);
 
-        AST_NODE *unaryMinus = new AST_NODE();
+        AST_NODE *unaryMinus = newNode();
         unaryMinus->TYPE = NODE_SUBT;
 
         AST_NODE *operand = parseTerm();
@@ -2691,41 +2915,55 @@ AST_NODE *Parser::parseTerm()
  * @brief Parses an expression
  * @return AST node representing the expression
  *
- * Handles expressions with operators, applying operator precedence
- * through a left-to-right evaluation. Builds a tree representing
- * the expression structure.
+ * Entry point for expressions; see parseBinaryExpression for how operator
+ * precedence is applied.
  */
 AST_NODE *Parser::parseExpression()
+{
+    return parseBinaryExpression(0);
+}
+
+/**
+ * @brief Precedence-climbing parser for binary and postfix operators
+ * @param minPrecedence Weakest operator this call may consume
+ * @return AST node representing the expression
+ *
+ * Operators are ranked by operatorPrecedence. An operator binds its right
+ * operand to everything that binds tighter, so "a + b * c" parses as
+ * a + (b * c) and "a - b - c" as (a - b) - c. Assignment ('=') is right
+ * associative. Postfix ++/-- wrap the operand parsed so far.
+ */
+AST_NODE *Parser::parseBinaryExpression(int minPrecedence)
 {
     AST_NODE *left = parseTerm();
 
-    while (current != nullptr && operatorPrecedence.find(current->TYPE) != operatorPrecedence.end())
+    while (current != nullptr)
     {
-        tokenType opType = current->TYPE;
-        NODE_TYPE nodeType = tokenToNodeType[opType];
-
-        proceed(opType);
-
-        // Handle special case for post-increment/decrement
-        if (opType == TOKEN_OPERATOR_INCREMENT || opType == TOKEN_OPERATOR_DECREMENT)
+        auto precedenceIt = operatorPrecedence.find(current->TYPE);
+        if (precedenceIt == operatorPrecedence.end() || precedenceIt->second < minPrecedence)
         {
-            AST_NODE *opNode = new AST_NODE();
-            opNode->TYPE = nodeType;
-            opNode->SUB_STATEMENTS.push_back(left);
-            return opNode;
+            break;
         }
 
-        // For binary operators, parse the right operand
-        AST_NODE *opNode = new AST_NODE();
-        opNode->TYPE = nodeType;
+        tokenType opType = current->TYPE;
+        int precedence = precedenceIt->second;
+
+        auto nodeTypeIt = tokenToNodeType.find(opType);
+        NODE_TYPE nodeType = nodeTypeIt != tokenToNodeType.end() ? nodeTypeIt->second : NODE_ROOT;
 
-        AST_NODE *right = parseTerm();
+        proceed(opType);
 
-        // Build the operator node with left and right children
+        AST_NODE *opNode = newNode();
+        opNode->TYPE = nodeType;
         opNode->SUB_STATEMENTS.push_back(left);
-        opNode->SUB_STATEMENTS.push_back(right);
 
-        // The entire expression becomes the new left operand
+        // Post-increment/decrement take no right operand
+        if (opType != TOKEN_OPERATOR_INCREMENT && opType != TOKEN_OPERATOR_DECREMENT)
+        {
+            int nextMinimum = (opType == TOKEN_EQUALS) ? precedence : precedence + 1;
+            opNode->SUB_STATEMENTS.push_back(parseBinaryExpression(nextMinimum));
+        }
+
         left = opNode;
     }
 
@@ -2745,14 +2983,14 @@ AST_NODE *Parser::parse()
 {
     initializeParserMaps();
 
-    AST_NODE *root = new AST_NODE();
+    AST_NODE *root = newNode();
     root->TYPE = NODE_ROOT;
 
     bool foundBegin = false;
 
-    while (cursor < size && tokens[cursor]->TYPE != TOKEN_EOF)
+    while (tokenAt(cursor) && tokenAt(cursor)->TYPE != TOKEN_EOF)
     {
-        current = tokens[cursor];
+        current = tokenAt(cursor);
         if (current == nullptr)
         {
             break;
@@ -2768,13 +3006,13 @@ AST_NODE *Parser::parse()
         {
             if (isHeader)
             {
-                ErrorHandler::getInstance().reportSyntaxError("Header files should not contain 'begin' blocks");
+                reportSyntaxError("Header files should not contain 'begin' blocks");
             }
             if (foundBegin)
             {
                 // std::cerr << "< Syntax Error > Multiple 'begin' blocks found" << std::endl;
                 // exit(1);
-                ErrorHandler::getInstance().reportSyntaxError("Multiple 'begin' blocks found.");
+                reportSyntaxError("Multiple 'begin' blocks found.");
             }
             AST_NODE *statement = parseBeginBlock();
             root->SUB_STATEMENTS.push_back(statement);
@@ -2789,7 +3027,7 @@ AST_NODE *Parser::parse()
             }
         }
 
-        if (cursor < size && tokens[cursor]->TYPE == TOKEN_SEMICOLON)
+        if (tokenAt(cursor) && tokenAt(cursor)->TYPE == TOKEN_SEMICOLON)
         {
             proceed(TOKEN_SEMICOLON);
         }
@@ -2797,26 +3035,26 @@ AST_NODE *Parser::parse()
 
     if (!isHeader)
     {
-        if (cursor < size && tokens[cursor]->TYPE == TOKEN_EOF)
+        if (tokenAt(cursor) && tokenAt(cursor)->TYPE == TOKEN_EOF)
         {
-            if (tokens[cursor]->value == "end")
+            if (tokenAt(cursor)->value == "end")
             {
-                current = tokens[cursor];
+                current = tokenAt(cursor);
                 root->SUB_STATEMENTS.push_back(parseKeywordEOF());
             }
             else
             {
-                ErrorHandler::getInstance().reportSyntaxError("Program Must end with keyword 'end'");
+                reportSyntaxError("Program Must end with keyword 'end'");
             }
         }
         else
         {
-            ErrorHandler::getInstance().reportSyntaxError("Program must end with keyword 'end'");
+            reportSyntaxError("Program must end with keyword 'end'");
         }
 
         if (!foundBegin)
         {
-            ErrorHandler::getInstance().reportSyntaxError("Main program must have 'begin' block");
+            reportSyntaxError("Main program must have 'begin' block");
         }
     }
 
@@ -3007,7 +3245,7 @@ AST_NODE *Parser::parseStatement()
     {
         // std::cerr << "Unexpected end of file while parsing statement" << std::endl;
         // exit(1);
-        ErrorHandler::getInstance().reportSyntaxError("Unexpected end of file while parsing statement.");
+        reportSyntaxError("Unexpected end of file while parsing statement.");
     }
 
     AST_NODE *statement = parseByTokenType(statementDispatch);
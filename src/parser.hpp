@@ -2,10 +2,15 @@
 #define PARSER_HPP
 
 #include "lexer.hpp"
+#include "TokenSource.hpp"
 
+#include <cstdint>
 #include <vector>
+#include <deque>
+#include <memory>
 #include <string>
 #include <iostream>
+#include <unordered_set>
 
 /**
  * @brief Node types for the Abstract Syntax Tree (AST)
@@ -13,7 +18,7 @@
  * These enumeration constants represent all possible types of nodes
  * that can appear in the AST during parsing.
  */
-enum NODE_TYPE
+enum NODE_TYPE : std::uint16_t
 {
     // Program structure nodes
     NODE_ROOT,        // Root node of the AST
@@ -154,6 +159,8 @@ enum NODE_TYPE
 struct AST_NODE
 {
     enum NODE_TYPE TYPE;                    // Type of the node
+    std::int16_t BUILTIN_ID;                // Native builtin a NODE_FUNCTION_CALL is bound to, or -1
+    std::uint32_t LOCATION;                 // SourceMap handle of the token the node was parsed at, or 0
     std::string VALUE;                      // Value associated with the node
     AST_NODE *CHILD;                        // Child node (for nodes with single child)
     std::vector<AST_NODE *> SUB_STATEMENTS; // List of sub-statements (for compound nodes)
@@ -163,9 +170,28 @@ struct AST_NODE
      *
      * Initializes the node as a ROOT node with no children.
      */
-    AST_NODE() : TYPE(NODE_ROOT), CHILD(nullptr) {}
+    AST_NODE() : TYPE(NODE_ROOT), BUILTIN_ID(-1), LOCATION(0), CHILD(nullptr) {}
+
+    // Counted under MemoryCategory::AST_NODES while MemoryStats is enabled
+    static void *operator new(std::size_t size)
+    {
+        MemoryStats::allocate(MemoryCategory::AST_NODES, size);
+        return ::operator new(size);
+    }
+
+    static void operator delete(void *memory, std::size_t size)
+    {
+        MemoryStats::release(MemoryCategory::AST_NODES, size);
+        ::operator delete(memory);
+    }
 };
 
+/**
+ * @brief Deletes a node with its CHILD and SUB_STATEMENTS, recursively
+ * @param root The tree to free; may be nullptr
+ */
+void deleteTree(AST_NODE *root);
+
 /**
  * @brief Parser class for syntax analysis
  *
@@ -183,19 +209,26 @@ public:
      * @brief Constructor for Parser class
      * @param tokens Vector of tokens from the lexer
      *
-     * Initializes the parser with the token stream and sets up
-     * the cursor to begin parsing from the first token.
+     * Initializes the parser with an already tokenized program. The tokens
+     * remain owned by the caller.
      */
-    Parser(std::vector<Token *> tokens, bool isHeader = false)
-    {
-        this->tokens = tokens;
-        cursor = 0;
-        size = tokens.size();
-        current = tokens[0];
-        this->isHeader = isHeader;
+    Parser(std::vector<Token *> tokens, bool isHeader = false);
 
-        initializeParserMaps();
-    }
+    /**
+     * @brief Constructor for a streaming Parser
+     * @param source Token source pulled on demand (typically a Lexer)
+     *
+     * Tokens are requested only as the parser reaches them and are released
+     * once they fall out of the lookahead window, so memory stays bounded by
+     * the window rather than the program size. The source must outlive the
+     * parser.
+     */
+    Parser(TokenSource &source, bool isHeader = false);
+
+    ~Parser();
+
+    Parser(const Parser &) = delete;
+    Parser &operator=(const Parser &) = delete;
 
     /**
      * @brief Main parsing method
@@ -205,11 +238,39 @@ public:
      */
     AST_NODE *parse();
 
+    /**
+     * @brief Files read through 'source:' includes while parsing, nested ones included
+     * @return Paths of the header files, in the order they were opened
+     */
+    const std::vector<std::string> &getIncludedFiles() const { return includedFiles; }
+
 private:
-    std::vector<Token *> tokens; // Token stream
-    size_t cursor;               // Current position in the token stream
-    size_t size;                 // Total number of tokens
-    Token *current;              // Current token being processed
+    std::unique_ptr<VectorTokenSource> ownedSource; // Backs the vector constructor
+    TokenSource *source;                            // Where tokens are pulled from
+    bool ownsTokens;                                // Delete tokens once they leave the window
+    bool sourceExhausted = false;                   // source->nextToken() has returned nullptr
+
+    std::deque<Token *> window; // Tokens from windowStart up to the furthest lookahead
+    size_t windowStart = 0;     // Stream index of window.front()
+
+    size_t cursor;  // Current position in the token stream
+    Token *current; // Current token being processed
+
+    std::vector<std::string> includedFiles; // Header files this parse depended on
+
+    /**
+     * @brief 'source:' bookkeeping for one program
+     *
+     * activeHeaders is the chain of headers being parsed, copied into each
+     * nested header parser to detect cycles. onceHeaders holds the '@once'
+     * headers already attached to this tree.
+     */
+    struct IncludeState
+    {
+        std::vector<std::string> activeHeaders;
+        std::unordered_set<std::string> onceHeaders;
+    };
+    IncludeState includeState;
     bool isHeader = false;
     bool isConst = false;
 
@@ -251,6 +312,24 @@ private:
      */
     Token *peakAhead();
 
+    /**
+     * @brief Returns the token at a stream index, pulling from the source as needed
+     * @param index Absolute position in the token stream
+     * @return The token, or nullptr past the end of the stream
+     *
+     * Indices before the window (already released) also return nullptr; the
+     * parser only ever steps back by one token.
+     */
+    Token *tokenAt(size_t index);
+
+    /**
+     * @brief Drops tokens that can no longer be reached
+     *
+     * Keeps the token just before the cursor so a one-token step back
+     * (see parseID) stays valid.
+     */
+    void releaseConsumedTokens();
+
     /**
      * @brief Advances the cursor to the next token
      *
@@ -258,11 +337,24 @@ private:
      */
     void advanceCursor();
 
+    /**
+     * @brief Allocates a node located at the current token
+     * @return A default-initialized node whose LOCATION is the current token's
+     */
+    AST_NODE *newNode();
+
+    /**
+     * @brief Reports a syntax error located at the current token
+     */
+    void reportSyntaxError(const std::string &message) const;
+
     //---------------------------------------------------------------------
     // Parsing Header Files
 
     AST_NODE *parseHeaderFile();
     bool processHeaderFile(AST_NODE *headerNode, const std::string &headerPath);
+    std::string resolveHeaderPath(const std::string &headerFileName) const;
+    void detachIncludedOnceHeaders(AST_NODE *node) const;
     //---------------------------------------------------------------------
     // Parse methods for various language constructs
     //---------------------------------------------------------------------
@@ -319,6 +411,8 @@ private:
     AST_NODE *parseLeftParen();
     AST_NODE *parseRightParen();
     AST_NODE *parseExpression();
+    AST_NODE *parseBinaryExpression(int minPrecedence);
+    AST_NODE *parseParenExpression();
     AST_NODE *parseResultExpression();
     AST_NODE *parseTerm();
     AST_NODE *parseLeftCurl();
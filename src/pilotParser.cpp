@@ -1,3 +1,4 @@
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -9,16 +10,24 @@
 #include "parser.hpp"
 #include "interperter.hpp"
 #include "ErrorHandler.hpp"
+#include "Log.hpp"
+#include "MemoryStats.hpp"
+#include "SourceBuffer.hpp"
+#include "FlatAST.hpp"
+#include "ProgramCache.hpp"
+#include "BatchRunner.hpp"
+#include "library/LibraryManager.hpp"
+#include "library/LibraryTable.hpp"
 
 namespace fs = std::filesystem;
 
 void printTokens(const std::vector<Token *> &tokens);
 void printNodes(AST_NODE *node, int depth = 0);
-void deleteASTTree(AST_NODE *node);
 void printUsage(const char *programName);
 void filterComments(AST_NODE *node);
 void printFunctionReturnValues(const std::map<std::string, std::stack<Value>> &functionReturnValues);
 void printValue(const Value &value);
+void printMemoryStats();
 
 int main(int argc, char *argv[])
 {
@@ -28,15 +37,135 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    std::string mode = (argc >= 3) ? argv[2] : "all";
+#ifdef MINILANG_PRODUCTION
+    const char *defaultMode = "interpret";
+#else
+    const char *defaultMode = "all";
+#endif
+    std::string mode = (argc >= 3) ? argv[2] : defaultMode;
 
-    if (mode != "lex" && mode != "parse" && mode != "interpret" && mode != "all")
+    if (mode != "lex" && mode != "parse" && mode != "interpret" && mode != "profile" && mode != "all" &&
+        mode != "batch")
     {
         std::cerr << "Error: Invalid mode '" << mode << "'" << std::endl;
         printUsage(argv[0]);
         return 1;
     }
 
+    bool useCache = false;
+    std::string outputSpec = OutputConfig::DEFAULT_SPEC;
+    std::string samplePath;
+    int sampleInterval = SamplingProfiler::DEFAULT_INTERVAL_US;
+    BatchRunner::Options batchOptions;
+    std::string batchOnlyOption;
+    std::string singleOnlyOption;
+    for (int i = 3; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option == "--cache")
+        {
+            useCache = true;
+            LibraryManager::getInstance().setCacheEnabled(true);
+        }
+        else if (option.rfind("--threads=", 0) == 0)
+        {
+            int threads = std::atoi(option.c_str() + 10);
+            if (threads <= 0)
+            {
+                std::cerr << "Error: Invalid thread count '" << option.substr(10) << "'" << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            batchOptions.threads = threads;
+            batchOnlyOption = option;
+        }
+        else if (option.rfind("--expected=", 0) == 0)
+        {
+            batchOptions.expectedDir = option.substr(11);
+            batchOnlyOption = option;
+        }
+        else if (option.rfind("--inputs=", 0) == 0)
+        {
+            batchOptions.inputDir = option.substr(9);
+            batchOnlyOption = option;
+        }
+        else if (option.rfind("--results=", 0) == 0)
+        {
+            batchOptions.resultsDir = option.substr(10);
+            batchOnlyOption = option;
+        }
+        else if (option.rfind("--output=", 0) == 0)
+        {
+            outputSpec = option.substr(9);
+            singleOnlyOption = option;
+        }
+        else if (option.rfind("--sample=", 0) == 0)
+        {
+            samplePath = option.substr(9);
+            singleOnlyOption = option;
+        }
+        else if (option.rfind("--sample-interval=", 0) == 0)
+        {
+            sampleInterval = std::atoi(option.c_str() + 18);
+            if (sampleInterval <= 0)
+            {
+                std::cerr << "Error: Invalid sample interval '" << option.substr(18) << "'" << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            singleOnlyOption = option;
+        }
+        else if (option == "--mem-stats")
+        {
+            // Options are read before any source is lexed, so nothing is missed
+            MemoryStats::enable();
+            std::atexit(printMemoryStats);
+        }
+        else if (option.rfind("--log-level=", 0) == 0)
+        {
+            LogLevel level;
+            if (!Log::parseLevel(option.substr(12), level))
+            {
+                std::cerr << "Error: Invalid log level '" << option.substr(12) << "'" << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            Log::setLevel(level);
+        }
+        else
+        {
+            std::cerr << "Error: Unknown option '" << option << "'" << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (mode == "batch" ? !singleOnlyOption.empty() : !batchOnlyOption.empty())
+    {
+        std::cerr << "Error: Option '" << (mode == "batch" ? singleOnlyOption : batchOnlyOption)
+                  << "' is not available in " << mode << " mode" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (mode == "batch")
+    {
+        batchOptions.useCache = useCache;
+        BatchRunner batch(batchOptions);
+        std::string error;
+        if (!batch.addScripts(argv[1], error))
+        {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+        if (batch.getScriptCount() == 0)
+        {
+            std::cerr << "Error: No scripts found in " << argv[1] << std::endl;
+            return 1;
+        }
+        return batch.run();
+    }
+
     fs::path inputPath(argv[1]);
     if (!fs::exists(inputPath))
     {
@@ -44,38 +173,45 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    std::ifstream inputFile(inputPath);
-    if (!inputFile.is_open())
+    SourceBuffer sourceCode;
+    if (!sourceCode.open(inputPath.string()))
     {
         std::cerr << "Error: Unable to open file " << inputPath << std::endl;
         return 1;
     }
 
-    std::string sourceCode((std::istreambuf_iterator<char>(inputFile)),
-                           std::istreambuf_iterator<char>());
-    inputFile.close();
+    if (sourceCode.empty())
+    {
+        std::cerr << "Error: Input file is empty: " << inputPath << std::endl;
+        return 1;
+    }
 
     try
     {
         // Stage 1: Tokenizing
+        // Only the modes that print the token listing need the whole stream up
+        // front; otherwise the parser pulls tokens from the lexer as it goes.
         Lexer lexer(sourceCode);
-        std::vector<Token *> tokens = lexer.tokenize();
+        std::vector<Token *> tokens;
+        const bool needTokenList = (mode == "lex" || mode == "all");
 
-        if (ErrorHandler::getInstance().hasError())
+        if (needTokenList)
         {
-            std::cout << "\n===== LEXICAL ERRORS =====\n"
-                      << std::endl;
-            std::cout << ErrorHandler::getInstance().getErrorReport() << std::endl;
+            tokens = lexer.tokenize();
 
-            for (auto &token : tokens)
+            if (ErrorHandler::getInstance().hasError())
             {
-                delete token;
+                std::cout << "\n===== LEXICAL ERRORS =====\n"
+                          << std::endl;
+                std::cout << ErrorHandler::getInstance().getErrorReport() << std::endl;
+
+                for (auto &token : tokens)
+                {
+                    delete token;
+                }
+                return 1;
             }
-            return 1;
-        }
 
-        if (mode == "lex" || mode == "all")
-        {
             std::cout << "\n===== LEXICAL ANALYSIS ======\n"
                       << std::endl;
             printTokens(tokens);
@@ -92,27 +228,56 @@ int main(int argc, char *argv[])
         }
 
         // Stage 2: Parsing
+        // With --cache, a still-valid .mlc file stands in for lexing and
+        // parsing. Modes that print tokens lex anyway and skip the cache.
         AST_NODE *root = nullptr;
-        Parser parser(tokens);
-        root = parser.parse();
+        std::unique_ptr<ProgramCache> cache;
+        bool loadedFromCache = false;
 
-        if (ErrorHandler::getInstance().hasError())
+        if (useCache && !needTokenList)
         {
-            std::cout << "\n===== SYNTAX ERRORS =====\n"
-                      << std::endl;
-            std::cout << ErrorHandler::getInstance().getErrorReport() << std::endl;
+            cache.reset(new ProgramCache(inputPath.string()));
+            FlatAST cached;
+            std::vector<std::string> cachedIncludes; // Not needed by a single run
+            if (cache->load(sourceCode.view(), cached, cachedIncludes))
+            {
+                root = cached.toTree();
+                loadedFromCache = true;
+            }
+        }
 
-            for (auto &token : tokens)
+        if (!loadedFromCache)
+        {
+            std::vector<std::string> includedFiles;
             {
-                delete token;
+                std::unique_ptr<Parser> parser(needTokenList ? new Parser(tokens) : new Parser(lexer));
+                root = parser->parse();
+                includedFiles = parser->getIncludedFiles();
             }
-            if (root)
+
+            if (ErrorHandler::getInstance().hasError())
+            {
+                std::cout << "\n===== SYNTAX ERRORS =====\n"
+                          << std::endl;
+                std::cout << ErrorHandler::getInstance().getErrorReport() << std::endl;
+
+                for (auto &token : tokens)
+                {
+                    delete token;
+                }
+                if (root)
+                {
+                    deleteTree(root);
+                }
+                return 1;
+            }
+            filterComments(root);
+
+            if (cache && !cache->store(sourceCode.view(), FlatAST::fromTree(root), includedFiles))
             {
-                deleteASTTree(root);
+                std::cerr << "Warning: Unable to write program cache " << cache->getCacheFilePath() << std::endl;
             }
-            return 1;
         }
-        filterComments(root);
 
         if (mode == "parse" || mode == "all")
         {
@@ -140,26 +305,118 @@ int main(int argc, char *argv[])
             {
                 delete token;
             }
-            deleteASTTree(root);
+            deleteTree(root);
             return 0;
         }
 
         // Stage 3: Interpretation
-        if (mode == "interpret" || mode == "all")
+        if (mode == "interpret" || mode == "profile" || mode == "all")
         {
-            std::cout << "\n===== PROGRAM OUTPUT =====\n"
-                      << std::endl;
+            // Interpret mode prints nothing but the program's own output
+            // and any errors; the stage reports belong to 'all'.
+            if (mode == "all")
+            {
+                std::cout << "\n===== PROGRAM OUTPUT =====\n"
+                          << std::endl;
+            }
+
+            OutputConfig outputConfig;
+            std::string outputError;
+            if (!OutputConfig::parse(outputSpec, outputConfig, outputError))
+            {
+                std::cerr << "Error: " << outputError << std::endl;
+                for (auto &token : tokens)
+                {
+                    delete token;
+                }
+                deleteTree(root);
+                return 1;
+            }
+
+            std::unique_ptr<Profiler> profiler;
+            if (mode == "profile")
+            {
+                profiler.reset(new Profiler());
+            }
+
+            std::unique_ptr<SamplingProfiler> sampler;
+            if (!samplePath.empty())
+            {
+                sampler.reset(new SamplingProfiler(sampleInterval));
+            }
+
+            // Imported libraries are loaded and bound as for a Program
+            LibraryTable libraries;
+            std::string libraryError;
+            if (!libraries.load(root, useCache, libraryError))
+            {
+                std::cerr << libraryError;
+                for (auto &token : tokens)
+                {
+                    delete token;
+                }
+                deleteTree(root);
+                return 1;
+            }
+
+            Interpreter::FunctionTable functions;
+            Interpreter::resolveBuiltinCalls(root);
+            Interpreter::collectFunctions(root, functions);
+            for (AST_NODE *library : libraries.getRoots())
+            {
+                Interpreter::collectFunctions(library, functions);
+            }
+
+            MINILANG_LOG_DEBUG("Executing the interpreter...");
+            Interpreter interperter(root, outputConfig, &functions);
+            interperter.setProfiler(profiler.get());
+
+            if (sampler)
+            {
+                std::string sampleError;
+                if (sampler->start(sampleError))
+                {
+                    interperter.setShadowStack(sampler->getShadowStack());
+                }
+                else
+                {
+                    std::cerr << "Warning: " << sampleError << "; running without sampling" << std::endl;
+                    sampler.reset();
+                }
+            }
 
-            std::cout << "Executing the interpreter..." << std::endl;
-            Interpreter interperter(root);
-            std::cout << "Calling execute()..." << std::endl;
             interperter.execute();
-            std::cout << "Getting function return values..." << std::endl;
-            auto returnValues = interperter.getFunctionReturnValues();
-            std::cout << "Function return values map has " << returnValues.size() << " entries" << std::endl;
 
-            std::cout << "Printing function return values..." << std::endl;
-            printFunctionReturnValues(returnValues);
+            if (sampler)
+            {
+                sampler->stop();
+                std::ofstream foldedFile(samplePath);
+                sampler->writeFolded(foldedFile);
+                if (!foldedFile)
+                {
+                    std::cerr << "Warning: Unable to write samples to " << samplePath << std::endl;
+                }
+                else
+                {
+                    std::cerr << "Wrote " << sampler->getSampleCount() << " samples";
+                    if (sampler->getDroppedCount() > 0)
+                    {
+                        std::cerr << " (" << sampler->getDroppedCount() << " dropped)";
+                    }
+                    std::cerr << " to " << samplePath << std::endl;
+                }
+            }
+
+            // The report goes to stderr, after the program's own output
+            if (profiler)
+            {
+                profiler->report(std::cerr);
+            }
+
+            if (mode == "all")
+            {
+                printFunctionReturnValues(interperter.getFunctionReturnValues());
+            }
             if (ErrorHandler::getInstance().hasError())
             {
                 std::cout << "\n===== RUNTIME ERRORS =====\n"
@@ -172,7 +429,7 @@ int main(int argc, char *argv[])
         {
             delete token;
         }
-        deleteASTTree(root);
+        deleteTree(root);
     }
     catch (const std::exception &e)
     {
@@ -197,12 +454,60 @@ int main(int argc, char *argv[])
 // Print Usage Information
 void printUsage(const char *programName)
 {
-    std::cerr << "Usage: " << programName << " <input_file> [mode]" << std::endl;
+    std::cerr << "Usage: " << programName << " <input_file> [mode] [options]" << std::endl;
     std::cerr << "Modes:" << std::endl;
     std::cerr << "  lex       - Run only lexical analysis" << std::endl;
     std::cerr << "  parse     - Run lexical and syntax analysis" << std::endl;
-    std::cerr << "  interpret - Run only program output (minimal debug info)" << std::endl;
+#ifdef MINILANG_PRODUCTION
+    std::cerr << "  interpret - Run only program output (default)" << std::endl;
+    std::cerr << "  all       - Run all stages with debug output" << std::endl;
+#else
+    std::cerr << "  interpret - Run only program output" << std::endl;
     std::cerr << "  all       - Run all stages with debug output (default)" << std::endl;
+#endif
+    std::cerr << "  profile   - Run the program, then report time per proc, executions" << std::endl;
+    std::cerr << "              per node type and the hottest statements on stderr" << std::endl;
+    std::cerr << "  batch     - Run every script in the directory or list file given as" << std::endl;
+    std::cerr << "              <input_file> on a thread pool, then report failures and" << std::endl;
+    std::cerr << "              throughput (scripts/s, p50/p99 latency)" << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  --cache   - Reuse the parsed program from a .mlc cache file when the" << std::endl;
+    std::cerr << "              script and its headers are unchanged (parse/interpret modes)," << std::endl;
+    std::cerr << "              and compiled .mllib libraries from .mllc cache files" << std::endl;
+    std::cerr << "  --output=SINKS" << std::endl;
+    std::cerr << "            - Comma-separated destinations for program output:" << std::endl;
+    std::cerr << "              stdout, file (timestamped file in ../output), file:PATH," << std::endl;
+    std::cerr << "              or null to discard it (default: stdout,file)" << std::endl;
+    std::cerr << "  --sample=PATH" << std::endl;
+    std::cerr << "            - Sample the running program on a CPU-time timer and write" << std::endl;
+    std::cerr << "              folded stacks (for flamegraph.pl or speedscope) to PATH" << std::endl;
+    std::cerr << "  --sample-interval=US" << std::endl;
+    std::cerr << "            - Microseconds of CPU time between samples (default 1000)" << std::endl;
+    std::cerr << "  --threads=N" << std::endl;
+    std::cerr << "            - Batch: worker threads (default: one per hardware thread)" << std::endl;
+    std::cerr << "  --expected=DIR" << std::endl;
+    std::cerr << "            - Batch: compare each script's output with DIR/<name>.expected," << std::endl;
+    std::cerr << "              ignoring whitespace within lines" << std::endl;
+    std::cerr << "  --inputs=DIR" << std::endl;
+    std::cerr << "            - Batch: feed DIR/<name>.in to the script's input statements" << std::endl;
+    std::cerr << "  --results=DIR" << std::endl;
+    std::cerr << "            - Batch: write each script's output to DIR/<name>.out" << std::endl;
+    std::cerr << "  --mem-stats" << std::endl;
+    std::cerr << "            - Report live and peak bytes of strings, arrays, AST nodes" << std::endl;
+    std::cerr << "              and tokens on stderr at exit" << std::endl;
+    std::cerr << "  --log-level=LEVEL" << std::endl;
+    std::cerr << "            - Diagnostics to print on stderr: error, warn (default)," << std::endl;
+#ifdef MINILANG_PRODUCTION
+    std::cerr << "              info (debug and trace are compiled out of this build)" << std::endl;
+#else
+    std::cerr << "              info, debug, or trace (every executed node)" << std::endl;
+#endif
+}
+
+// Print the MemoryStats table at exit (--mem-stats)
+void printMemoryStats()
+{
+    MemoryStats::report(std::cerr);
 }
 
 // Print token information
@@ -255,28 +560,6 @@ void printNodes(AST_NODE *node, int depth)
     }
 }
 
-// Recursively delete the AST
-void deleteASTTree(AST_NODE *node)
-{
-    if (!node)
-        return;
-
-    // Delete child node
-    if (node->CHILD)
-    {
-        deleteASTTree(node->CHILD);
-    }
-
-    // Delete all sub-statements
-    for (auto subNode : node->SUB_STATEMENTS)
-    {
-        deleteASTTree(subNode);
-    }
-
-    // Delete the node itself
-    delete node;
-}
-
 void filterComments(AST_NODE *node)
 {
     if (!node)
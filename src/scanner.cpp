@@ -0,0 +1,227 @@
+#include "scanner.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    inline bool isWhitespace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    std::size_t skipWhitespaceScalar(const char *data, std::size_t pos, std::size_t size)
+    {
+        while (pos < size && isWhitespace(data[pos]))
+        {
+            pos++;
+        }
+        return pos;
+    }
+
+    std::size_t findLineEndScalar(const char *data, std::size_t pos, std::size_t size)
+    {
+        while (pos < size && data[pos] != '\n' && data[pos] != '\r')
+        {
+            pos++;
+        }
+        return pos;
+    }
+
+    std::size_t findByteScalar(const char *data, std::size_t pos, std::size_t size, char target)
+    {
+        while (pos < size && data[pos] != target)
+        {
+            pos++;
+        }
+        return pos;
+    }
+
+#ifdef SCANNER_X86
+    //
+    // SSE2: 16 bytes per step. The tail that does not fill a whole register
+    // is finished by the scalar loop so we never read past the buffer.
+    //
+
+    inline unsigned whitespaceMask16(__m128i chunk)
+    {
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'))));
+        return static_cast<unsigned>(_mm_movemask_epi8(ws));
+    }
+
+    std::size_t skipWhitespaceSSE2(const char *data, std::size_t pos, std::size_t size)
+    {
+        while (pos + 16 <= size)
+        {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+            unsigned stop = ~whitespaceMask16(chunk) & 0xFFFFu;
+            if (stop != 0)
+            {
+                return pos + __builtin_ctz(stop);
+            }
+            pos += 16;
+        }
+        return skipWhitespaceScalar(data, pos, size);
+    }
+
+    std::size_t findLineEndSSE2(const char *data, std::size_t pos, std::size_t size)
+    {
+        const __m128i newline = _mm_set1_epi8('\n');
+        const __m128i carriage = _mm_set1_epi8('\r');
+        while (pos + 16 <= size)
+        {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+            unsigned stop = static_cast<unsigned>(_mm_movemask_epi8(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, newline), _mm_cmpeq_epi8(chunk, carriage))));
+            if (stop != 0)
+            {
+                return pos + __builtin_ctz(stop);
+            }
+            pos += 16;
+        }
+        return findLineEndScalar(data, pos, size);
+    }
+
+    std::size_t findByteSSE2(const char *data, std::size_t pos, std::size_t size, char target)
+    {
+        const __m128i needle = _mm_set1_epi8(target);
+        while (pos + 16 <= size)
+        {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+            unsigned stop = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+            if (stop != 0)
+            {
+                return pos + __builtin_ctz(stop);
+            }
+            pos += 16;
+        }
+        return findByteScalar(data, pos, size, target);
+    }
+
+    //
+    // AVX2: 32 bytes per step, compiled for the AVX2 target and only called
+    // after a runtime CPU check.
+    //
+
+    __attribute__((target("avx2"))) std::size_t skipWhitespaceAVX2(const char *data, std::size_t pos, std::size_t size)
+    {
+        const __m256i space = _mm256_set1_epi8(' ');
+        const __m256i tab = _mm256_set1_epi8('\t');
+        const __m256i newline = _mm256_set1_epi8('\n');
+        const __m256i carriage = _mm256_set1_epi8('\r');
+        while (pos + 32 <= size)
+        {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+            __m256i ws = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, newline), _mm256_cmpeq_epi8(chunk, carriage)));
+            unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(ws));
+            if (stop != 0)
+            {
+                return pos + __builtin_ctz(stop);
+            }
+            pos += 32;
+        }
+        return skipWhitespaceSSE2(data, pos, size);
+    }
+
+    __attribute__((target("avx2"))) std::size_t findLineEndAVX2(const char *data, std::size_t pos, std::size_t size)
+    {
+        const __m256i newline = _mm256_set1_epi8('\n');
+        const __m256i carriage = _mm256_set1_epi8('\r');
+        while (pos + 32 <= size)
+        {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+            unsigned stop = static_cast<unsigned>(_mm256_movemask_epi8(
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, newline), _mm256_cmpeq_epi8(chunk, carriage))));
+            if (stop != 0)
+            {
+                return pos + __builtin_ctz(stop);
+            }
+            pos += 32;
+        }
+        return findLineEndSSE2(data, pos, size);
+    }
+
+    __attribute__((target("avx2"))) std::size_t findByteAVX2(const char *data, std::size_t pos, std::size_t size, char target)
+    {
+        const __m256i needle = _mm256_set1_epi8(target);
+        while (pos + 32 <= size)
+        {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+            unsigned stop = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+            if (stop != 0)
+            {
+                return pos + __builtin_ctz(stop);
+            }
+            pos += 32;
+        }
+        return findByteSSE2(data, pos, size, target);
+    }
+#endif
+
+    /**
+     * @brief The scanner functions selected for the running CPU
+     */
+    struct ScannerTable
+    {
+        std::size_t (*skipWhitespace)(const char *, std::size_t, std::size_t);
+        std::size_t (*findLineEnd)(const char *, std::size_t, std::size_t);
+        std::size_t (*findByte)(const char *, std::size_t, std::size_t, char);
+        const char *name;
+    };
+
+    ScannerTable selectImplementation()
+    {
+#ifdef SCANNER_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return {skipWhitespaceAVX2, findLineEndAVX2, findByteAVX2, "avx2"};
+        }
+        return {skipWhitespaceSSE2, findLineEndSSE2, findByteSSE2, "sse2"};
+#else
+        return {skipWhitespaceScalar, findLineEndScalar, findByteScalar, "scalar"};
+#endif
+    }
+
+    /**
+     * @brief The table for this CPU, chosen on first use
+     *
+     * A function-local static rather than a namespace-scope one, so a lexer
+     * run from another translation unit's static initializer never sees
+     * the table before it is filled in.
+     */
+    const ScannerTable &active()
+    {
+        static const ScannerTable table = selectImplementation();
+        return table;
+    }
+}
+
+namespace scanner
+{
+    std::size_t skipWhitespace(const char *data, std::size_t pos, std::size_t size)
+    {
+        return active().skipWhitespace(data, pos, size);
+    }
+
+    std::size_t findLineEnd(const char *data, std::size_t pos, std::size_t size)
+    {
+        return active().findLineEnd(data, pos, size);
+    }
+
+    std::size_t findByte(const char *data, std::size_t pos, std::size_t size, char target)
+    {
+        return active().findByte(data, pos, size, target);
+    }
+
+    const char *activeImplementation()
+    {
+        return active().name;
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef SCANNER_HPP
+#define SCANNER_HPP
+
+#include <cstddef>
+
+//
+// Byte scanners used by the Lexer to jump over whitespace, comment bodies
+// and string literal contents. Each function looks at data[pos, size) and
+// returns the index of the first byte that stops the scan, or size if none
+// does. On x86 they work 32 bytes at a time with AVX2 when the CPU supports
+// it and 16 bytes at a time with SSE2 otherwise; other targets use a scalar
+// loop.
+//
+namespace scanner
+{
+    // First byte that is not ' ', '\t', '\n' or '\r'
+    std::size_t skipWhitespace(const char *data, std::size_t pos, std::size_t size);
+
+    // First '\n' or '\r'
+    std::size_t findLineEnd(const char *data, std::size_t pos, std::size_t size);
+
+    // First occurrence of target
+    std::size_t findByte(const char *data, std::size_t pos, std::size_t size, char target);
+
+    // Name of the implementation picked for this CPU ("avx2", "sse2" or "scalar")
+    const char *activeImplementation();
+}
+
+#endif
@@ -0,0 +1,359 @@
+/**
+ * @file stress.cpp
+ * @brief Runs the golden fixtures on many threads at once
+ *
+ * Every thread compiles each fixture with Program::compileFile and runs it
+ * in an ExecutionContext of its own, several rounds over, starting at a
+ * different fixture so that different scripts overlap. With --shared the
+ * fixtures are compiled once up front, and all threads execute the same
+ * Program objects at the same time.
+ *
+ * Each transcript is compared with tests/expected/<name>.expected the way
+ * tests.sh compares (diff -w: whitespace within a line is ignored).
+ * Fixtures that read input get tests/input/<name>.in. The scripts in
+ * tests/errors have no expected output; each of their runs must fail
+ * with an error report, while the runs overlapping it carry on unharmed.
+ *
+ * The SourceMap is checked first: a text registered again keeps its
+ * handles, and NO_LOCATION (what tokens get once the handle space is used
+ * up) decodes to nothing and leaves diagnostics unprefixed.
+ *
+ * Memory accounting is on throughout. Afterwards the memory budget is
+ * checked: a run that allocates over the budget is abandoned by a throwing
+ * handler, and releases made while over it (in destructors) never call it.
+ *
+ * Run from the project root, so that 'source:' headers resolve. Exits with
+ * 1 if any run fails or produces different output.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ErrorHandler.hpp"
+#include "MemoryStats.hpp"
+#include "Program.hpp"
+#include "RunCheck.hpp"
+#include "SourceLocation.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct Fixture
+    {
+        std::string name;
+        std::string path;
+        std::string expected;
+        std::string input;
+        bool hasInput = false;
+        bool mustFail = false; // From tests/errors
+        std::shared_ptr<const Program> program; // With --shared
+    };
+
+    std::vector<Fixture> loadFixtures(const std::vector<std::string> &directories)
+    {
+        std::vector<Fixture> fixtures;
+        for (const std::string &directory : directories)
+        {
+            std::error_code error;
+            for (const fs::directory_entry &entry : fs::directory_iterator(directory, error))
+            {
+                if (entry.path().extension() != ".txt")
+                {
+                    continue;
+                }
+
+                Fixture fixture;
+                fixture.name = entry.path().filename().string();
+                fixture.path = entry.path().string();
+                if (!runcheck::readFile("tests/expected/" + fixture.name + ".expected", fixture.expected))
+                {
+                    continue; // tests.sh only warns about these
+                }
+                fixture.hasInput = runcheck::readFile("tests/input/" + fixture.name + ".in", fixture.input);
+                fixtures.push_back(fixture);
+            }
+        }
+
+        std::error_code error;
+        for (const fs::directory_entry &entry : fs::directory_iterator("tests/errors", error))
+        {
+            if (entry.path().extension() == ".txt")
+            {
+                Fixture fixture;
+                fixture.name = entry.path().filename().string();
+                fixture.path = entry.path().string();
+                fixture.mustFail = true;
+                fixtures.push_back(fixture);
+            }
+        }
+
+        std::sort(fixtures.begin(), fixtures.end(), [](const Fixture &a, const Fixture &b)
+                  { return a.name < b.name; });
+        return fixtures;
+    }
+
+    /**
+     * @brief Checks SourceMap registration and the handling of NO_LOCATION
+     * @return The number of failed checks, each reported on stderr
+     */
+    int checkSourceMap()
+    {
+        int failed = 0;
+        auto check = [&failed](bool passed, const char *what)
+        {
+            if (!passed)
+            {
+                failed++;
+                std::fprintf(stderr, "FAIL source map: %s\n", what);
+            }
+        };
+
+        SourceMap &map = SourceMap::getInstance();
+        const std::string text = "begin:\n    out_to_console(1);\nend:\n";
+        SourceMap::Handle first = map.registerSource("sourceMapCheck.txt", text);
+        check(first != SourceMap::NO_LOCATION, "registering a text gave NO_LOCATION");
+        check(map.registerSource("sourceMapCheck.txt", text) == first, "the same text got new handles");
+        check(map.registerSource("sourceMapOther.txt", text) != first, "another file shared the handles");
+        check(map.registerSource("sourceMapCheck.txt", text + "\n") != first, "a changed text kept the handles");
+        check(map.describe(first + 11) == "sourceMapCheck.txt:2:5", "an offset handle decoded wrongly");
+
+        check(map.get(SourceMap::NO_LOCATION).line == 0, "NO_LOCATION decoded to a line");
+        check(map.describe(SourceMap::NO_LOCATION).empty(), "NO_LOCATION was described");
+        check(map.intern(SourceLocation()) == SourceMap::NO_LOCATION, "an unknown location was interned");
+
+        ErrorHandler errors;
+        errors.setEcho(false);
+        errors.reportSyntaxError("unlocated", SourceMap::NO_LOCATION);
+        errors.reportSyntaxError("located", first + 11);
+        check(errors.getErrors()[0].message == "unlocated", "a NO_LOCATION diagnostic was prefixed");
+        check(errors.getErrors()[1].message == "sourceMapCheck.txt:2:5: located", "a diagnostic was not prefixed");
+        return failed;
+    }
+
+    std::atomic<int> budgetCalls{0};
+
+    void abandonOverBudget(std::uint64_t, std::uint64_t)
+    {
+        budgetCalls++;
+        throw std::runtime_error("Memory budget exceeded");
+    }
+
+    /**
+     * @brief Checks setBudget() and isOverBudget() on a fixture that allocates arrays
+     * @return The number of failed checks, each reported on stderr
+     */
+    int checkMemoryBudget(const std::vector<Fixture> &fixtures)
+    {
+        auto found = std::find_if(fixtures.begin(), fixtures.end(), [](const Fixture &fixture)
+                                  { return fixture.name == "array.txt"; });
+        if (found == fixtures.end())
+        {
+            std::fprintf(stderr, "FAIL budget: tests/fixtures/array.txt not found\n");
+            return 1;
+        }
+
+        int failed = 0;
+        auto check = [&failed](bool passed, const char *what)
+        {
+            if (!passed)
+            {
+                failed++;
+                std::fprintf(stderr, "FAIL budget: %s\n", what);
+            }
+        };
+
+        // Compiled first, so the budget is already exceeded when it is set
+        std::string error;
+        std::shared_ptr<const Program> program = Program::compileFile(found->path, error);
+        std::shared_ptr<const Program> discarded = Program::compileFile(found->path, error);
+        check(program != nullptr && discarded != nullptr, "fixture did not compile");
+        if (!program || !discarded)
+        {
+            return failed;
+        }
+
+        MemoryStats::setBudget(1, abandonOverBudget);
+        check(MemoryStats::isOverBudget(), "isOverBudget() is false over the budget");
+
+        // The first records over the budget are releases, in noexcept deletes;
+        // calling the throwing handler there would terminate the process
+        discarded.reset();
+        check(budgetCalls.load() == 0, "the handler was called by a release");
+
+        bool abandoned = false;
+        try
+        {
+            ExecutionContext context(program);
+            context.setErrorEcho(false);
+            abandoned = !context.run() && context.getErrorReport().find("Memory budget exceeded") != std::string::npos;
+        }
+        catch (const std::runtime_error &)
+        {
+            abandoned = true; // Thrown before run() could catch it
+        }
+        check(abandoned, "a run over the budget was not abandoned");
+        check(budgetCalls.load() > 0, "the handler was not called");
+
+        MemoryStats::setBudget(0, nullptr);
+        check(!MemoryStats::isOverBudget(), "isOverBudget() is true without a budget");
+
+        int callsBefore = budgetCalls.load();
+        ExecutionContext context(program);
+        check(context.run() && runcheck::matchesExpected(context.getOutput(), found->expected),
+              "the run after removing the budget failed");
+        check(budgetCalls.load() == callsBefore, "the handler was called without a budget");
+        return failed;
+    }
+
+    void printUsage(const char *argv0)
+    {
+        std::printf("Usage: %s [--threads=N] [--rounds=N] [--shared]\n"
+                    "  --threads=N   Threads running fixtures (default: hardware threads, at least 4)\n"
+                    "  --rounds=N    Times each thread runs every fixture (default 5)\n"
+                    "  --shared      Compile each fixture once and share it between the threads\n",
+                    argv0);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int threads = std::max(4u, std::thread::hardware_concurrency());
+    int rounds = 5;
+    bool shared = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option.rfind("--threads=", 0) == 0)
+        {
+            threads = std::max(1, std::atoi(option.c_str() + 10));
+        }
+        else if (option.rfind("--rounds=", 0) == 0)
+        {
+            rounds = std::max(1, std::atoi(option.c_str() + 9));
+        }
+        else if (option == "--shared")
+        {
+            shared = true;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return option == "--help" ? 0 : 2;
+        }
+    }
+
+    MemoryStats::enable(); // Before anything is allocated, so releases balance
+
+    int sourceMapFailures = checkSourceMap();
+    std::printf("source map: %s\n", sourceMapFailures == 0 ? "ok" : "FAILED");
+
+    std::vector<Fixture> fixtures = loadFixtures({"tests/fixtures", "tests/integration"});
+    if (fixtures.empty())
+    {
+        std::fprintf(stderr, "No fixtures with expected output found; run from the project root\n");
+        return 2;
+    }
+
+    if (shared)
+    {
+        for (Fixture &fixture : fixtures)
+        {
+            std::string error;
+            fixture.program = Program::compileFile(fixture.path, error);
+            if (!fixture.program)
+            {
+                std::fprintf(stderr, "FAIL %s did not compile:\n%s\n", fixture.name.c_str(), error.c_str());
+                return 1;
+            }
+        }
+    }
+
+    std::atomic<int> runs{0};
+    std::atomic<int> failures{0};
+    std::mutex reportMutex;
+
+    auto worker = [&](int thread)
+    {
+        for (int round = 0; round < rounds; round++)
+        {
+            for (std::size_t i = 0; i < fixtures.size(); i++)
+            {
+                const Fixture &fixture = fixtures[(i + thread) % fixtures.size()];
+                std::string failure;
+
+                std::string error;
+                std::shared_ptr<const Program> program = fixture.program;
+                if (!program)
+                {
+                    program = Program::compileFile(fixture.path, error);
+                }
+                if (!program)
+                {
+                    failure = "did not compile:\n" + error;
+                }
+                else
+                {
+                    ExecutionContext context(program);
+                    if (fixture.hasInput)
+                    {
+                        context.setInputText(fixture.input);
+                    }
+                    if (fixture.mustFail)
+                    {
+                        if (context.run())
+                        {
+                            failure = "should have failed";
+                        }
+                        else if (context.getErrorReport().find("Error") == std::string::npos)
+                        {
+                            failure = "failed without an error report";
+                        }
+                    }
+                    else if (!context.run())
+                    {
+                        failure = "failed:\n" + context.getErrorReport();
+                    }
+                    else if (!runcheck::matchesExpected(context.getOutput(), fixture.expected))
+                    {
+                        failure = "output mismatch:\n" + context.getOutput();
+                    }
+                }
+
+                runs++;
+                if (!failure.empty())
+                {
+                    failures++;
+                    std::lock_guard<std::mutex> lock(reportMutex);
+                    std::fprintf(stderr, "FAIL %s (thread %d, round %d) %s\n", fixture.name.c_str(), thread,
+                                 round, failure.c_str());
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int thread = 0; thread < threads; thread++)
+    {
+        pool.emplace_back(worker, thread);
+    }
+    for (std::thread &thread : pool)
+    {
+        thread.join();
+    }
+
+    std::printf("%zu fixtures%s, %d threads, %d rounds: %d runs, %d failed\n", fixtures.size(),
+                shared ? " (shared)" : "", threads, rounds, runs.load(), failures.load());
+
+    int budgetFailures = checkMemoryBudget(fixtures);
+    std::printf("memory budget: %s\n", budgetFailures == 0 ? "ok" : "FAILED");
+    return failures.load() == 0 && sourceMapFailures == 0 && budgetFailures == 0 ? 0 : 1;
+}